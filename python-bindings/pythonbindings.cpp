@@ -676,6 +676,18 @@ PYBIND11_MODULE(blspy, m)
                 return GTElement::FromBytesUnchecked(data);
             })
         .def("unity", &GTElement::Unity)
+        .def(
+            "multi_pair",
+            [](const vector<G1Element> &g1s, const vector<G2Element> &g2s) {
+                py::gil_scoped_release release;
+                return GTElement::MultiPair(g1s, g2s, true);
+            })
+        .def(
+            "pairing_product_is_one",
+            [](const vector<G1Element> &g1s, const vector<G2Element> &g2s) {
+                py::gil_scoped_release release;
+                return GTElement::PairingProductIsOne(g1s, g2s, true);
+            })
         .def(py::self == py::self)
         .def(py::self != py::self)
         .def(
@@ -719,6 +731,33 @@ PYBIND11_MODULE(blspy, m)
                 return self * other;
             },
             py::is_operator())
+        .def(
+            "__truediv__",
+            [](GTElement &self, GTElement &other) {
+                py::gil_scoped_release release;
+                return self / other;
+            },
+            py::is_operator())
+        .def(
+            "__pow__",
+            [](GTElement &self, py::int_ pyint) {
+                std::array<uint8_t, 32> buffer{};
+                if (_PyLong_AsByteArray(
+                        (PyLongObject *)pyint.ptr(),
+                        buffer.data(),
+                        buffer.size(),
+                        0,
+                        0) < 0) {
+                    throw std::invalid_argument("Failed to cast int to scalar");
+                }
+                py::gil_scoped_release release;
+                blst_scalar k;
+                blst_scalar_from_be_bytes(&k, buffer.data(), buffer.size());
+                return self.Pow(k);
+            },
+            py::is_operator())
+        .def("inverse", &GTElement::Inverse, py::call_guard<py::gil_scoped_release>())
+        .def("is_unity", &GTElement::IsUnity)
         .def("__deepcopy__", [](const GTElement &ele, const py::object &memo) {
             return GTElement(ele);
         });
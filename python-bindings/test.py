@@ -8,6 +8,7 @@ from blspy import (
     BasicSchemeMPL,
     G1Element,
     G2Element,
+    GTElement,
     PopSchemeMPL,
     PrivateKey,
     Util,
@@ -375,6 +376,17 @@ def test_invalid_points():
         pass
 
 
+def test_gt_arithmetic():
+    sk = BasicSchemeMPL.key_gen(b"1" * 32)
+    base = G1Element.generator().pair(G2Element.generator())
+    gt = sk.get_g1().pair(G2Element.generator())
+    assert base ** int.from_bytes(bytes(sk), "big") == gt
+    assert (gt * gt.inverse()).is_unity()
+    assert (gt / base) * base == gt
+    assert GTElement.unity().is_unity()
+    assert GTElement.multi_pair([sk.get_g1(), G1Element.generator()], [G2Element.generator()] * 2) == gt * base
+    assert GTElement.pairing_product_is_one([sk.get_g1(), G1Element.generator().negate()], [G2Element.generator(), sk.get_g2()])
+
 
 test_schemes()
 test_vectors_invalid()
@@ -382,6 +394,7 @@ test_vectors_valid()
 test_readme()
 test_aggregate_verify_zero_items()
 test_invalid_points()
+test_gt_arithmetic()
 
 print("\nAll tests passed.")
 
@@ -0,0 +1,195 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSASYNC_HPP_
+#define SRC_BLSASYNC_HPP_
+
+// Awaitable versions of the expensive operations, for C++20 coroutines.
+// Only available when the library is configured with BLS_COROUTINES=1,
+// which builds it as C++20; otherwise this header is empty.
+#if defined(BLS_COROUTINES) && BLS_COROUTINES
+
+#if !defined(__cpp_impl_coroutine) || __cpp_impl_coroutine < 201902L
+#error "BLS_COROUTINES requires a C++20 compiler with coroutine support"
+#endif
+
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "schemes.hpp"
+#include "threadpool.hpp"
+
+namespace bls {
+
+// Runs a task somewhere else, for example on the worker threads of an I/O
+// runtime. The task must be run exactly once.
+using Executor = std::function<void(std::function<void()>)>;
+
+// Posts to ThreadPool::Default(). Parallel loops inside an operation run
+// inline on its worker, so concurrent operations spread over the cores.
+inline Executor DefaultExecutor()
+{
+    return [](std::function<void()> task) {
+        ThreadPool::Default().Submit(std::move(task));
+    };
+}
+
+/*
+ * Awaitable running fn on an executor. The awaiting coroutine is resumed
+ * on the thread that ran fn, or not suspended at all if the executor ran
+ * it inline. co_await returns the result of fn or rethrows its exception.
+ */
+template <class F>
+class AsyncOperation {
+public:
+    using Result = std::invoke_result_t<F &>;
+    static_assert(!std::is_void_v<Result>, "operations return a value");
+
+    AsyncOperation(F fn, Executor executor)
+        : fn(std::move(fn)), executor(std::move(executor))
+    {
+    }
+
+    AsyncOperation(const AsyncOperation &) = delete;
+    AsyncOperation &operator=(const AsyncOperation &) = delete;
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend(std::coroutine_handle<> awaiting)
+    {
+        handle = awaiting;
+        executor([this] {
+            try {
+                result.emplace(fn());
+            } catch (...) {
+                error = std::current_exception();
+            }
+            // The second of the task and await_suspend to get here resumes
+            if (fDone.exchange(true, std::memory_order_acq_rel)) {
+                handle.resume();
+            }
+        });
+        return !fDone.exchange(true, std::memory_order_acq_rel);
+    }
+
+    Result await_resume()
+    {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*result);
+    }
+
+private:
+    F fn;
+    Executor executor;
+    std::coroutine_handle<> handle;
+    std::optional<Result> result;
+    std::exception_ptr error;
+    std::atomic<bool> fDone{false};
+};
+
+template <class F>
+AsyncOperation<F> MakeAsync(F fn, Executor executor)
+{
+    return AsyncOperation<F>(std::move(fn), std::move(executor));
+}
+
+// The functions below keep references to their arguments, which must
+// outlive the co_await, as they do when the call is its operand:
+//
+//     bool ok = co_await AsyncAggregateVerify(scheme, pks, msgs, sig);
+//
+// Messages are std::vector<std::vector<uint8_t>> or std::vector<Bytes>.
+
+template <class Messages>
+auto AsyncAggregateVerify(
+    CoreMPL &scheme,
+    const std::vector<G1Element> &pubkeys,
+    const Messages &messages,
+    const G2Element &signature,
+    Executor executor = DefaultExecutor())
+{
+    return MakeAsync(
+        [&scheme, &pubkeys, &messages, &signature] {
+            return scheme.AggregateVerify(pubkeys, messages, signature);
+        },
+        std::move(executor));
+}
+
+template <class Messages>
+auto AsyncAggregateVerifyBatch(
+    CoreMPL &scheme,
+    const std::vector<std::vector<G1Element>> &pubkeys,
+    const std::vector<Messages> &messages,
+    const std::vector<G2Element> &signatures,
+    Executor executor = DefaultExecutor())
+{
+    return MakeAsync(
+        [&scheme, &pubkeys, &messages, &signatures] {
+            return scheme.AggregateVerifyBatch(pubkeys, messages, signatures);
+        },
+        std::move(executor));
+}
+
+template <class Messages>
+auto AsyncAggregateVerifyBatchEach(
+    CoreMPL &scheme,
+    const std::vector<std::vector<G1Element>> &pubkeys,
+    const std::vector<Messages> &messages,
+    const std::vector<G2Element> &signatures,
+    Executor executor = DefaultExecutor())
+{
+    return MakeAsync(
+        [&scheme, &pubkeys, &messages, &signatures] {
+            return scheme.AggregateVerifyBatchEach(
+                pubkeys, messages, signatures);
+        },
+        std::move(executor));
+}
+
+// Element is G1Element or G2Element
+template <class Element>
+auto AsyncFromBytesBatch(
+    const std::vector<Bytes> &bytes,
+    Executor executor = DefaultExecutor())
+{
+    return MakeAsync(
+        [&bytes] { return Element::FromBytesBatch(bytes); },
+        std::move(executor));
+}
+
+template <class Message>
+auto AsyncSign(
+    CoreMPL &scheme,
+    const PrivateKey &seckey,
+    const Message &message,
+    Executor executor = DefaultExecutor())
+{
+    return MakeAsync(
+        [&scheme, &seckey, &message] { return scheme.Sign(seckey, message); },
+        std::move(executor));
+}
+
+}  // end namespace bls
+
+#endif  // BLS_COROUTINES
+
+#endif  // SRC_BLSASYNC_HPP_
@@ -0,0 +1,288 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "batchfile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#define BLS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bls {
+
+static const uint8_t BATCH_FILE_MAGIC[8] =
+    {'B', 'L', 'S', 'B', 'A', 'T', 'C', 'H'};
+static const size_t BATCH_FILE_HEADER_SIZE = 64;
+
+static void PutLE(uint8_t *out, uint64_t value, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint64_t GetLE(const uint8_t *in, size_t len)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t Align8(uint64_t n) { return (n + 7) & ~(uint64_t)7; }
+
+const uint32_t BatchFileWriter::VERSION;
+
+BatchFileWriter::BatchFileWriter(size_t pkSize, size_t sigSize)
+    : pkSize(pkSize), sigSize(sigSize), msgIndex(1, 0)
+{
+}
+
+void BatchFileWriter::Add(
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    if (pubkey.size() != pkSize || signature.size() != sigSize) {
+        throw std::invalid_argument("BatchFileWriter::Add: Invalid size");
+    }
+    pubkeys.insert(pubkeys.end(), pubkey.begin(), pubkey.end());
+    signatures.insert(signatures.end(), signature.begin(), signature.end());
+    messages.insert(messages.end(), message.begin(), message.end());
+    msgIndex.push_back(messages.size());
+}
+
+std::vector<uint8_t> BatchFileWriter::Serialize() const
+{
+    const uint64_t pkOffset = BATCH_FILE_HEADER_SIZE;
+    const uint64_t sigOffset = Align8(pkOffset + pubkeys.size());
+    const uint64_t msgIndexOffset = Align8(sigOffset + signatures.size());
+    const uint64_t msgOffset = msgIndexOffset + 8 * msgIndex.size();
+
+    std::vector<uint8_t> file(msgOffset + messages.size(), 0);
+    uint8_t *header = file.data();
+    memcpy(header, BATCH_FILE_MAGIC, sizeof(BATCH_FILE_MAGIC));
+    PutLE(header + 8, VERSION, 4);
+    PutLE(header + 12, pkSize, 4);
+    PutLE(header + 16, sigSize, 4);
+    PutLE(header + 24, Size(), 8);
+    PutLE(header + 32, pkOffset, 8);
+    PutLE(header + 40, sigOffset, 8);
+    PutLE(header + 48, msgIndexOffset, 8);
+    PutLE(header + 56, msgOffset, 8);
+
+    std::copy(pubkeys.begin(), pubkeys.end(), file.begin() + pkOffset);
+    std::copy(signatures.begin(), signatures.end(), file.begin() + sigOffset);
+    for (size_t i = 0; i < msgIndex.size(); i++) {
+        PutLE(file.data() + msgIndexOffset + 8 * i, msgIndex[i], 8);
+    }
+    std::copy(messages.begin(), messages.end(), file.begin() + msgOffset);
+    return file;
+}
+
+void BatchFileWriter::Write(const std::string &path) const
+{
+    const std::vector<uint8_t> file = Serialize();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write((const char *)file.data(), file.size());
+    if (!out.good()) {
+        throw std::runtime_error("Can't write batch file " + path);
+    }
+}
+
+BatchFileReader::BatchFileReader(const std::string &path)
+    : data(nullptr), dataSize(0), mapping(nullptr)
+{
+#if BLS_HAVE_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open batch file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        throw std::runtime_error("Can't open batch file " + path);
+    }
+    dataSize = st.st_size;
+    if (dataSize > 0) {
+        mapping = mmap(nullptr, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Can't map batch file " + path);
+    }
+    data = (const uint8_t *)mapping;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Can't open batch file " + path);
+    }
+    buffer.assign(
+        std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    dataSize = buffer.size();
+#endif
+    try {
+        Parse();
+    } catch (...) {
+#if BLS_HAVE_MMAP
+        if (mapping) {
+            munmap(mapping, dataSize);
+        }
+#endif
+        throw;
+    }
+}
+
+BatchFileReader::BatchFileReader(std::vector<uint8_t> contents)
+    : mapping(nullptr), buffer(std::move(contents))
+{
+    data = buffer.data();
+    dataSize = buffer.size();
+    Parse();
+}
+
+BatchFileReader::~BatchFileReader()
+{
+#if BLS_HAVE_MMAP
+    if (mapping) {
+        munmap(mapping, dataSize);
+    }
+#endif
+}
+
+bool BatchFileReader::HasMagic(const uint8_t *data, size_t len)
+{
+    return len >= sizeof(BATCH_FILE_MAGIC) &&
+           memcmp(data, BATCH_FILE_MAGIC, sizeof(BATCH_FILE_MAGIC)) == 0;
+}
+
+void BatchFileReader::Parse()
+{
+    if (dataSize < BATCH_FILE_HEADER_SIZE || !HasMagic(data, dataSize)) {
+        throw std::invalid_argument("Not a batch file");
+    }
+    if (GetLE(data + 8, 4) != BatchFileWriter::VERSION) {
+        throw std::invalid_argument("Unsupported batch file version");
+    }
+    pkSize = GetLE(data + 12, 4);
+    sigSize = GetLE(data + 16, 4);
+    const uint64_t n = GetLE(data + 24, 8);
+    const uint64_t pkOffset = GetLE(data + 32, 8);
+    const uint64_t sigOffset = GetLE(data + 40, 8);
+    const uint64_t msgIndexOffset = GetLE(data + 48, 8);
+    const uint64_t msgOffset = GetLE(data + 56, 8);
+
+    // Sections must be in order and in bounds; dividing first keeps the
+    // size products from overflowing
+    const uint64_t maxCount = dataSize / 8;
+    if (n >= maxCount || pkOffset < BATCH_FILE_HEADER_SIZE ||
+        pkOffset > dataSize || (pkSize && n > (dataSize - pkOffset) / pkSize) ||
+        sigOffset < pkOffset + n * pkSize || sigOffset > dataSize ||
+        (sigSize && n > (dataSize - sigOffset) / sigSize) ||
+        msgIndexOffset < sigOffset + n * sigSize ||
+        msgIndexOffset > dataSize || msgIndexOffset % 8 != 0 ||
+        (dataSize - msgIndexOffset) / 8 < n + 1 ||
+        msgOffset < msgIndexOffset + 8 * (n + 1) || msgOffset > dataSize) {
+        throw std::invalid_argument("Malformed batch file");
+    }
+    count = n;
+    pubkeys = data + pkOffset;
+    signatures = data + sigOffset;
+    msgIndex = data + msgIndexOffset;
+    messages = data + msgOffset;
+    messagesSize = dataSize - msgOffset;
+
+    uint64_t previous = GetLE(msgIndex, 8);
+    if (previous != 0) {
+        throw std::invalid_argument("Malformed batch file");
+    }
+    for (size_t i = 1; i <= count; i++) {
+        const uint64_t offset = GetLE(msgIndex + 8 * i, 8);
+        if (offset < previous || offset > messagesSize) {
+            throw std::invalid_argument("Malformed batch file");
+        }
+        previous = offset;
+    }
+}
+
+Bytes BatchFileReader::PubKey(size_t i) const
+{
+    if (i >= count) {
+        throw std::out_of_range("BatchFileReader: Invalid index");
+    }
+    return Bytes(pubkeys + i * pkSize, pkSize);
+}
+
+Bytes BatchFileReader::Message(size_t i) const
+{
+    if (i >= count) {
+        throw std::out_of_range("BatchFileReader: Invalid index");
+    }
+    const uint64_t begin = GetLE(msgIndex + 8 * i, 8);
+    const uint64_t end = GetLE(msgIndex + 8 * (i + 1), 8);
+    return Bytes(messages + begin, end - begin);
+}
+
+Bytes BatchFileReader::Signature(size_t i) const
+{
+    if (i >= count) {
+        throw std::out_of_range("BatchFileReader: Invalid index");
+    }
+    return Bytes(signatures + i * sigSize, sigSize);
+}
+
+std::vector<Bytes> BatchFileReader::PubKeys() const
+{
+    std::vector<Bytes> views;
+    views.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        views.push_back(PubKey(i));
+    }
+    return views;
+}
+
+std::vector<Bytes> BatchFileReader::Messages() const
+{
+    std::vector<Bytes> views;
+    views.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        views.push_back(Message(i));
+    }
+    return views;
+}
+
+std::vector<Bytes> BatchFileReader::Signatures() const
+{
+    std::vector<Bytes> views;
+    views.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        views.push_back(Signature(i));
+    }
+    return views;
+}
+
+}  // end namespace bls
@@ -0,0 +1,122 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SRC_BLSBATCHFILE_HPP_
+#define SRC_BLSBATCHFILE_HPP_
+
+#include <string>
+#include <vector>
+
+#include "elements.hpp"
+
+namespace bls {
+
+/*
+ * Container for (pubkey, message, signature) records, laid out so a mapped
+ * file can feed the Bytes overloads of the schemes without copies:
+ *
+ *   header      64 bytes: magic[8] version[4] pkSize[4] sigSize[4]
+ *               reserved[4] count[8] pkOffset[8] sigOffset[8]
+ *               msgIndexOffset[8] msgOffset[8]
+ *   pubkeys     count * pkSize bytes
+ *   signatures  count * sigSize bytes
+ *   msgIndex    (count + 1) offsets of 8 bytes into the message blob
+ *   messages    the concatenated messages
+ *
+ * Integers are little endian and sections start 8 byte aligned. Record
+ * sizes default to the MPL schemes'; the MSL ones swap them.
+ */
+class BatchFileWriter {
+public:
+    static const uint32_t VERSION = 1;
+
+    explicit BatchFileWriter(
+        size_t pkSize = G1Element::SIZE,
+        size_t sigSize = G2Element::SIZE);
+
+    // Throws std::invalid_argument if pubkey or signature has the wrong size
+    void Add(const Bytes &pubkey, const Bytes &message, const Bytes &signature);
+
+    size_t Size() const { return msgIndex.size() - 1; }
+
+    // The file contents
+    std::vector<uint8_t> Serialize() const;
+
+    // Writes the records to path. Throws std::runtime_error on I/O errors.
+    void Write(const std::string &path) const;
+
+private:
+    const size_t pkSize;
+    const size_t sigSize;
+    std::vector<uint8_t> pubkeys;
+    std::vector<uint8_t> signatures;
+    std::vector<uint64_t> msgIndex;
+    std::vector<uint8_t> messages;
+};
+
+/*
+ * Maps a file written by BatchFileWriter and hands out views into it,
+ * which stay valid for the reader's lifetime. The layout is checked on
+ * open and std::invalid_argument thrown if it is malformed; the records
+ * themselves are not parsed, so invalid points are reported by whatever
+ * consumes them.
+ */
+class BatchFileReader {
+public:
+    explicit BatchFileReader(const std::string &path);
+    // Reads a file already in memory, e.g. from a pipe
+    explicit BatchFileReader(std::vector<uint8_t> contents);
+    ~BatchFileReader();
+
+    // True if data starts like a batch file
+    static bool HasMagic(const uint8_t *data, size_t len);
+
+    BatchFileReader(const BatchFileReader &) = delete;
+    BatchFileReader &operator=(const BatchFileReader &) = delete;
+
+    size_t Size() const { return count; }
+    size_t PubKeySize() const { return pkSize; }
+    size_t SignatureSize() const { return sigSize; }
+
+    Bytes PubKey(size_t i) const;
+    Bytes Message(size_t i) const;
+    Bytes Signature(size_t i) const;
+
+    // Views of every record, for the vector<Bytes> overloads
+    std::vector<Bytes> PubKeys() const;
+    std::vector<Bytes> Messages() const;
+    std::vector<Bytes> Signatures() const;
+
+private:
+    void Parse();
+
+    const uint8_t *data;
+    size_t dataSize;
+    void *mapping;
+    std::vector<uint8_t> buffer;  // when not mapped
+
+    size_t count;
+    size_t pkSize;
+    size_t sigSize;
+    const uint8_t *pubkeys;
+    const uint8_t *signatures;
+    const uint8_t *msgIndex;
+    const uint8_t *messages;
+    size_t messagesSize;
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSBATCHFILE_HPP_
@@ -14,14 +14,146 @@
 
 #include "bls.hpp"
 
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+
+#include "cpufeatures.hpp"
+
 #if BLSALLOC_SODIUM
 #include "sodium.h"
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define BLS_X86_64 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if BLS_X86_64 && !defined(__BLST_NO_ASM__)
+#define BLS_X86_64_ASM 1
+// blst's assembly, built with __BLST_PORTABLE__, includes both the generic
+// and the ADX/SHA code paths and picks one at each call from this word.
+extern "C" int __blst_platform_cap;
+#endif
+
 namespace bls {
 
 const size_t BLS::MESSAGE_HASH_LEN;
 
+#if BLS_FP_IFMA
+// Whether the OS saves the AVX-512 registers, as XCR0 reports
+static bool HasAvx512State()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & (1 << 27))) {
+        return false;
+    }
+    unsigned int xcr0, xcr0High;
+    __asm__("xgetbv" : "=a"(xcr0), "=d"(xcr0High) : "c"(0));
+    // SSE, AVX, opmask and both halves of the ZMM state
+    return (xcr0 & 0xe6) == 0xe6;
+}
+#endif
+
+static int DetectCpuFeatures()
+{
+    int features = 0;
+#if BLS_X86_64
+    int info[4] = {0, 0, 0, 0};
+#if defined(_MSC_VER)
+    __cpuid(info, 0);
+    if (info[0] >= 7) {
+        __cpuidex(info, 7, 0);
+#else
+    if (__get_cpuid_max(0, nullptr) >= 7) {
+        unsigned int eax, ebx, ecx, edx;
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        info[1] = (int)ebx;
+#endif
+#if BLS_X86_64_ASM
+        // MULX comes with BMI2, which every ADX capable CPU has
+        if ((info[1] & (1 << 19)) && (info[1] & (1 << 8))) {
+            features |= BLS::CPU_ADX;
+        }
+        if (info[1] & (1 << 29)) {
+            features |= BLS::CPU_SHA;
+        }
+#endif
+#if BLS_FP_IFMA
+        // AVX512F and AVX512IFMA
+        if ((info[1] & (1 << 16)) && (info[1] & (1 << 21)) &&
+            HasAvx512State()) {
+            features |= BLS::CPU_AVX512IFMA;
+        }
+#endif
+    }
+#endif
+    return features;
+}
+
+// Parses a comma separated feature list, ignoring unknown names such as
+// "none"
+static int ParseCpuFeatures(const char* spec)
+{
+    int features = 0;
+    std::string s(spec);
+    size_t begin = 0;
+    while (begin <= s.size()) {
+        size_t end = s.find(',', begin);
+        if (end == std::string::npos) {
+            end = s.size();
+        }
+        const std::string name = s.substr(begin, end - begin);
+        if (name == "adx") {
+            features |= BLS::CPU_ADX;
+        } else if (name == "sha") {
+            features |= BLS::CPU_SHA;
+        } else if (name == "ifma") {
+            features |= BLS::CPU_AVX512IFMA;
+        }
+        begin = end + 1;
+    }
+    return features;
+}
+
+static int CpuFeatures()
+{
+    static const int features = DetectCpuFeatures();
+    return features;
+}
+
+// Features to run with, chosen at the library's first use. blst sets its
+// capability word from a static constructor, which may run before or after
+// ours, so the choice is applied then rather than at load.
+static std::atomic<int> enabledCpuFeatures{0};
+static std::once_flag cpuFeaturesOnce;
+
+// Sets the word blst dispatches on. blst reads it without synchronization.
+static void SetBlstCpuFeatures(int features)
+{
+#if BLS_X86_64_ASM
+    __blst_platform_cap = features & (BLS::CPU_ADX | BLS::CPU_SHA);
+#else
+    (void)features;
+#endif
+}
+
+void ApplyCpuFeatures()
+{
+    std::call_once(cpuFeaturesOnce, [] {
+        int features = CpuFeatures();
+        if (const char* spec = std::getenv("BLS_CPU_FEATURES")) {
+            features &= ParseCpuFeatures(spec);
+        }
+        enabledCpuFeatures.store(features, std::memory_order_release);
+        SetBlstCpuFeatures(features);
+    });
+}
+
 bool BLSInitResult = BLS::Init();
 
 Util::SecureAllocCallback Util::secureAllocCallback;
@@ -37,7 +169,6 @@ bool BLS::Init()
 #else
     SetSecureAllocator(malloc, free);
 #endif
-
     return true;
 }
 
@@ -49,4 +180,46 @@ void BLS::SetSecureAllocator(
     Util::secureFreeCallback = freeCb;
 }
 
+int BLS::GetCpuFeatures() { return CpuFeatures(); }
+
+int BLS::GetEnabledCpuFeatures()
+{
+    ApplyCpuFeatures();
+    return enabledCpuFeatures.load(std::memory_order_acquire);
+}
+
+void BLS::SetEnabledCpuFeatures(int features)
+{
+    if (features < 0 || (features & ~CpuFeatures()) != 0) {
+        throw std::invalid_argument(
+            "SetEnabledCpuFeatures: feature not supported by this CPU");
+    }
+    // The default is applied first, so that it can't replace this later
+    ApplyCpuFeatures();
+    enabledCpuFeatures.store(features, std::memory_order_release);
+    SetBlstCpuFeatures(features);
+}
+
+std::string BLS::GetBackendName()
+{
+    const int features = GetEnabledCpuFeatures();
+#if BLS_X86_64_ASM
+    std::string name = "x86_64";
+    if (features & CPU_ADX) {
+        name += "+adx";
+    }
+    if (features & CPU_SHA) {
+        name += "+sha";
+    }
+#elif defined(__BLST_NO_ASM__) || defined(__EMSCRIPTEN__)
+    std::string name = "portable";
+#else
+    std::string name = "asm";
+#endif
+    if (features & CPU_AVX512IFMA) {
+        name += "+ifma";
+    }
+    return name;
+}
+
 }  // end namespace bls
@@ -15,12 +15,25 @@
 #ifndef SRC_BLS_HPP_
 #define SRC_BLS_HPP_
 
+#include <string>
+
 #include "privatekey.hpp"
 #include "util.hpp"
 #include "schemes.hpp"
+#include "staticschemes.hpp"
+#include "views.hpp"
 #include "elements.hpp"
+#include "field.hpp"
 #include "hkdf.hpp"
 #include "hdkeys.hpp"
+#include "threadpool.hpp"
+#include "cache.hpp"
+#include "shmcache.hpp"
+#include "batchfile.hpp"
+#include "verifyd.hpp"
+#include "partial.hpp"
+#include "scheduler.hpp"
+#include "async.hpp"
 
 namespace bls {
 
@@ -36,6 +49,31 @@ class BLS {
     static bool Init();
 
     static void SetSecureAllocator(Util::SecureAllocCallback allocCb, Util::SecureFreeCallback freeCb);
+
+    // CPU extensions the library can switch to at run time. ADX and SHA
+    // match the bits of blst's __blst_platform_cap.
+    enum CpuFeature {
+        CPU_ADX = 1,  // MULX/ADCX/ADOX Montgomery multiplication (x86_64)
+        CPU_SHA = 2,  // SHA extensions for SHA-256 (x86_64)
+        CPU_AVX512IFMA = 4,  // FP_IFMA batch field arithmetic (x86_64)
+    };
+
+    // Features the CPU supports and this build can use, detected at load
+    static int GetCpuFeatures();
+
+    // Features blst currently uses. Every supported feature is enabled on
+    // first use, unless the BLS_CPU_FEATURES environment variable lists a
+    // subset, such as "none", "adx,sha" or "ifma".
+    static int GetEnabledCpuFeatures();
+
+    // Overrides the features in use. Throws std::invalid_argument for
+    // features the CPU lacks. Not thread safe: blst reads the setting
+    // without synchronization, so it must not run concurrently with any
+    // other library or blst call.
+    static void SetEnabledCpuFeatures(int features);
+
+    // Human readable name of the active backend, e.g. "x86_64+adx+sha"
+    static std::string GetBackendName();
 };
 } // end namespace bls
 
@@ -0,0 +1,315 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// blsverify: bulk verification of signature records.
+//
+// Reads batch files written by BatchFileWriter, or text with one record
+// per line as hex fields "pubkey message signature" ("-" for an empty
+// message; "pubkey proof" in pop mode). Records of each input are checked
+// in parallel on all cores; failures are printed one per line and a
+// summary with the throughput is printed at the end.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+#include "bls.hpp"
+
+using std::string;
+using std::vector;
+
+using namespace bls;
+
+enum Mode { MODE_VERIFY, MODE_AGGREGATE, MODE_POP };
+
+struct Options {
+    Mode mode = MODE_VERIFY;
+    string scheme = "aug";
+    bool fQuiet = false;
+    vector<string> inputs;
+};
+
+struct Input {
+    string name;
+    std::unique_ptr<BatchFileReader> reader;
+    vector<size_t> lines;  // source line of each record, for text input
+};
+
+static void Usage()
+{
+    std::cerr
+        << "Usage: blsverify [options] [file...]\n"
+        << "Verifies the records of each file, or of stdin if none or -.\n"
+        << "\n"
+        << "  --mode verify|aggregate|pop  check each signature (default),\n"
+        << "                               the aggregate of each input, or\n"
+        << "                               proofs of possession\n"
+        << "  --scheme basic|aug|pop       signature scheme (default aug)\n"
+        << "  --quiet                      only print the summary\n";
+}
+
+static bool ParseOptions(int argc, char* argv[], Options& options)
+{
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        if ((arg == "--mode" || arg == "--scheme") && i + 1 < argc) {
+            const string value = argv[++i];
+            if (arg == "--scheme") {
+                if (value != "basic" && value != "aug" && value != "pop") {
+                    return false;
+                }
+                options.scheme = value;
+            } else if (value == "verify") {
+                options.mode = MODE_VERIFY;
+            } else if (value == "aggregate") {
+                options.mode = MODE_AGGREGATE;
+            } else if (value == "pop") {
+                options.mode = MODE_POP;
+            } else {
+                return false;
+            }
+        } else if (arg == "--quiet") {
+            options.fQuiet = true;
+        } else if (arg == "--help" || (arg.size() > 1 && arg[0] == '-')) {
+            return false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.inputs.empty()) {
+        options.inputs.push_back("-");
+    }
+    return true;
+}
+
+static std::unique_ptr<CoreMPL> MakeScheme(const string& name)
+{
+    if (name == "basic") {
+        return std::unique_ptr<CoreMPL>(new BasicSchemeMPL());
+    } else if (name == "pop") {
+        return std::unique_ptr<CoreMPL>(new PopSchemeMPL());
+    }
+    return std::unique_ptr<CoreMPL>(new AugSchemeMPL());
+}
+
+static vector<uint8_t> ParseHexField(const string& field)
+{
+    return field == "-" ? vector<uint8_t>() : Util::HexToBytes(field);
+}
+
+// Converts text records to the batch format, so that both kinds of input
+// are checked the same way
+static void ParseText(const string& text, Mode mode, Input& input)
+{
+    BatchFileWriter writer;
+    std::istringstream lines(text);
+    string line;
+    size_t lineNumber = 0;
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        std::istringstream fields(line);
+        vector<string> parts;
+        string part;
+        while (fields >> part) {
+            parts.push_back(part);
+        }
+        if (parts.empty() || parts[0][0] == '#') {
+            continue;
+        }
+        const size_t expected = mode == MODE_POP ? 2 : 3;
+        if (parts.size() != expected) {
+            throw std::invalid_argument(
+                "line " + std::to_string(lineNumber) + ": expected " +
+                std::to_string(expected) + " fields");
+        }
+        try {
+            const vector<uint8_t> pk = ParseHexField(parts[0]);
+            const vector<uint8_t> msg =
+                mode == MODE_POP ? vector<uint8_t>() : ParseHexField(parts[1]);
+            const vector<uint8_t> sig = ParseHexField(parts.back());
+            writer.Add(pk, msg, sig);
+        } catch (const std::exception& e) {
+            throw std::invalid_argument(
+                "line " + std::to_string(lineNumber) + ": " + e.what());
+        }
+        input.lines.push_back(lineNumber);
+    }
+    input.reader.reset(new BatchFileReader(writer.Serialize()));
+}
+
+static Input ReadInput(const string& name, Mode mode)
+{
+    Input input;
+    input.name = name == "-" ? "<stdin>" : name;
+
+    // Batch files are mapped; text and pipes are read whole
+    if (name != "-") {
+        std::ifstream in(name, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("can't open " + name);
+        }
+        char magic[8] = {0};
+        in.read(magic, sizeof(magic));
+        if (BatchFileReader::HasMagic((const uint8_t*)magic, in.gcount())) {
+            input.reader.reset(new BatchFileReader(name));
+            return input;
+        }
+    }
+
+    std::ifstream file;
+    if (name != "-") {
+        file.open(name, std::ios::binary);
+    }
+    std::istream& in = name == "-" ? std::cin : file;
+    vector<uint8_t> contents(
+        (std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (BatchFileReader::HasMagic(contents.data(), contents.size())) {
+        input.reader.reset(new BatchFileReader(std::move(contents)));
+    } else {
+        ParseText(string(contents.begin(), contents.end()), mode, input);
+    }
+    return input;
+}
+
+// Checks every record on the default thread pool. ok[i] is 0 on failure.
+static vector<uint8_t> CheckRecords(
+    const BatchFileReader& reader,
+    Mode mode,
+    const Options& options)
+{
+    const size_t n = reader.Size();
+    vector<uint8_t> ok(n, 0);
+    ThreadPool::Default().ParallelFor(
+        n, [&](size_t, size_t begin, size_t end) {
+            std::unique_ptr<CoreMPL> scheme = MakeScheme(options.scheme);
+            PopSchemeMPL pop;
+            for (size_t i = begin; i < end; i++) {
+                try {
+                    ok[i] = mode == MODE_POP
+                                ? pop.PopVerify(
+                                      reader.PubKey(i), reader.Signature(i))
+                                : scheme->Verify(
+                                      reader.PubKey(i),
+                                      reader.Message(i),
+                                      reader.Signature(i));
+                } catch (const std::exception&) {
+                    ok[i] = 0;  // invalid encoding
+                }
+            }
+        });
+    return ok;
+}
+
+// Aggregates the signatures of the input and checks them at once, then
+// localizes the failures if that doesn't verify
+static vector<uint8_t> CheckAggregate(
+    const BatchFileReader& reader,
+    const Options& options)
+{
+    const size_t n = reader.Size();
+    try {
+        const vector<G2Element> sigs =
+            G2Element::FromBytesBatch(reader.Signatures());
+        const vector<uint8_t> aggSig =
+            MakeScheme(options.scheme)->Aggregate(sigs).Serialize();
+        if (MakeScheme(options.scheme)
+                ->AggregateVerify(
+                    reader.PubKeys(), reader.Messages(), Bytes(aggSig))) {
+            return vector<uint8_t>(n, 1);
+        }
+    } catch (const std::exception&) {
+        // An invalid encoding, found again below
+    }
+
+    // Bisect with one set per record, once the bad encodings are out
+    vector<uint8_t> ok(n, 0);
+    vector<size_t> decoded;
+    vector<vector<G1Element>> pubkeys;
+    vector<vector<Bytes>> messages;
+    vector<G2Element> signatures;
+    for (size_t i = 0; i < n; i++) {
+        try {
+            pubkeys.push_back({G1Element::FromBytes(reader.PubKey(i))});
+            signatures.push_back(G2Element::FromBytes(reader.Signature(i)));
+            messages.push_back({reader.Message(i)});
+            decoded.push_back(i);
+        } catch (const std::exception&) {
+            pubkeys.resize(decoded.size());
+        }
+    }
+    const vector<bool> results = MakeScheme(options.scheme)
+        ->AggregateVerifyBatchEach(pubkeys, messages, signatures);
+    for (size_t d = 0; d < decoded.size(); d++) {
+        ok[decoded[d]] = results[d];
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        Usage();
+        return 2;
+    }
+
+    size_t nRecords = 0;
+    size_t nFailures = 0;
+    double seconds = 0;
+    for (const string& name : options.inputs) {
+        Input input;
+        try {
+            input = ReadInput(name, options.mode);
+        } catch (const std::exception& e) {
+            std::cerr << "blsverify: " << name << ": " << e.what() << std::endl;
+            return 2;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        const vector<uint8_t> ok =
+            options.mode == MODE_AGGREGATE
+                ? CheckAggregate(*input.reader, options)
+                : CheckRecords(*input.reader, options.mode, options);
+        seconds += std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+        for (size_t i = 0; i < ok.size(); i++) {
+            if (ok[i]) {
+                continue;
+            }
+            nFailures++;
+            if (!options.fQuiet) {
+                std::cout << input.name << ": record " << i;
+                if (!input.lines.empty()) {
+                    std::cout << " (line " << input.lines[i] << ")";
+                }
+                std::cout << ": FAILED" << std::endl;
+            }
+        }
+        nRecords += ok.size();
+    }
+
+    std::cout << nRecords << " records, " << nFailures << " failed, "
+              << (size_t)(seconds * 1000) << " ms";
+    if (seconds > 0) {
+        std::cout << ", " << (size_t)(nRecords / seconds) << " records/s";
+    }
+    std::cout << " (" << ThreadPool::Default().Size() + 1 << " threads)"
+              << std::endl;
+    return nFailures == 0 ? 0 : 1;
+}
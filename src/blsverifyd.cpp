@@ -0,0 +1,94 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// blsverifyd: batches the verification requests of local processes,
+// sent with VerifyClient over a Unix domain socket. Runs until SIGINT or
+// SIGTERM.
+
+#include <signal.h>
+
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "bls.hpp"
+
+using std::string;
+
+using namespace bls;
+
+static void Usage()
+{
+    std::cerr << "Usage: blsverifyd [--socket path] [--window-us n] "
+                 "[--max-batch n]\n"
+              << "  --socket path   default /tmp/blsverifyd.sock\n"
+              << "  --window-us n   longest wait for a batch to fill, "
+                 "default 2000\n"
+              << "  --max-batch n   default 1024\n";
+}
+
+int main(int argc, char* argv[])
+{
+    string socketPath = "/tmp/blsverifyd.sock";
+    long windowUs = 2000;
+    long nMaxBatch = 1024;
+    for (int i = 1; i < argc; i++) {
+        const string arg = argv[i];
+        if (i + 1 >= argc) {
+            Usage();
+            return 2;
+        }
+        if (arg == "--socket") {
+            socketPath = argv[++i];
+        } else if (arg == "--window-us") {
+            windowUs = std::atol(argv[++i]);
+        } else if (arg == "--max-batch") {
+            nMaxBatch = std::atol(argv[++i]);
+        } else {
+            Usage();
+            return 2;
+        }
+    }
+    if (windowUs < 0 || nMaxBatch <= 0) {
+        Usage();
+        return 2;
+    }
+
+    // Handle the signals on this thread only, with sigwait
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    try {
+        VerifyServer server(
+            socketPath, std::chrono::microseconds(windowUs), nMaxBatch);
+        std::thread runner([&server] { server.Run(); });
+        std::cerr << "blsverifyd: listening on " << socketPath << std::endl;
+
+        int signal;
+        sigwait(&signals, &signal);
+        server.Stop();
+        runner.join();
+
+        std::cerr << "blsverifyd: " << server.Requests() << " requests in "
+                  << server.Batches() << " batches, "
+                  << server.FailedBatches() << " failed" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "blsverifyd: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
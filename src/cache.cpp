@@ -0,0 +1,597 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <initializer_list>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "sodium.h"
+
+#if !BLSALLOC_SODIUM
+#include <random>
+#endif
+
+#if !defined(_WIN32)
+#define BLS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bls {
+
+
+// Appends a 4 byte big endian length followed by the data
+static void AppendField(
+    std::vector<uint8_t> &buffer,
+    const uint8_t *data,
+    size_t len)
+{
+    uint8_t prefix[4];
+    Util::IntToFourBytes(prefix, (uint32_t)len);
+    buffer.insert(buffer.end(), prefix, prefix + 4);
+    buffer.insert(buffer.end(), data, data + len);
+}
+
+void RandomCacheSalt(uint8_t *salt)
+{
+#if BLSALLOC_SODIUM
+    randombytes_buf(salt, CACHE_SALT_SIZE);
+#else
+    std::random_device rd;
+    for (size_t i = 0; i < CACHE_SALT_SIZE; i++) {
+        salt[i] = (uint8_t)rd();
+    }
+#endif
+}
+
+// SHA-256 of the salt followed by the length prefixed fields
+static void SaltedDigest(
+    uint8_t *output,
+    const uint8_t *salt,
+    std::initializer_list<Bytes> fields)
+{
+    static thread_local std::vector<uint8_t> buffer;
+    buffer.assign(salt, salt + CACHE_SALT_SIZE);
+    for (const Bytes &field : fields) {
+        AppendField(buffer, field.begin(), field.size());
+    }
+    Util::Hash256(output, buffer.data(), buffer.size());
+}
+
+size_t CacheKeyHash::operator()(const CacheKey &key) const
+{
+    // The key is already a salted digest
+    size_t h;
+    memcpy(&h, key.data(), sizeof(h));
+    return h;
+}
+
+/*
+ * Snapshot files are a 64 byte header, count fixed size entries and an
+ * HMAC-SHA256 of everything before it:
+ *
+ *   magic[8] version[4] kind[4] entrySize[4] byteOrder[4] count[8]
+ *   salt[32] entries[count * entrySize] mac[32]
+ *
+ * Integers are big endian except byteOrder, which is written natively to
+ * reject snapshots from hosts with a different layout. Entries start 8
+ * byte aligned, so the file can also be mapped and read in place.
+ */
+static const uint8_t SNAPSHOT_MAGIC[8] =
+    {'B', 'L', 'S', 'C', 'S', 'N', 'A', 'P'};
+static const uint32_t SNAPSHOT_VERSION = 1;
+static const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+static const size_t SNAPSHOT_HEADER_SIZE = 64;
+static const size_t SNAPSHOT_MAC_SIZE = 32;
+static const size_t SNAPSHOT_MIN_KEY_SIZE = 16;
+
+enum SnapshotKind : uint32_t {
+    SNAPSHOT_SIGNATURES = 1,
+    SNAPSHOT_PAIRINGS = 2,
+};
+
+static void CheckSnapshotKey(const Bytes &authKey)
+{
+    if (authKey.size() < SNAPSHOT_MIN_KEY_SIZE) {
+        throw std::invalid_argument(
+            "Snapshot key must be at least 16 bytes");
+    }
+}
+
+// HMAC-SHA256 of the first len bytes of a snapshot. Snapshots can exceed
+// the int lengths of Util::md_hmac, and are hashed in place.
+static void SnapshotMac(
+    uint8_t *mac,
+    const uint8_t *data,
+    size_t len,
+    const Bytes &authKey)
+{
+    crypto_auth_hmacsha256_state state;
+    crypto_auth_hmacsha256_init(&state, authKey.begin(), authKey.size());
+    crypto_auth_hmacsha256_update(&state, data, len);
+    crypto_auth_hmacsha256_final(&state, mac);
+    sodium_memzero(&state, sizeof(state));
+}
+
+// A snapshot file mapped read only, or read into memory where mmap isn't
+// available
+class SnapshotFile {
+public:
+    SnapshotFile() : mapping(nullptr), mappingSize(0) {}
+    SnapshotFile(const SnapshotFile &) = delete;
+    SnapshotFile &operator=(const SnapshotFile &) = delete;
+
+    ~SnapshotFile()
+    {
+#if BLS_HAVE_MMAP
+        if (mapping) {
+            munmap(mapping, mappingSize);
+        }
+#endif
+    }
+
+    bool Open(const std::string &path)
+    {
+#if BLS_HAVE_MMAP
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            return false;
+        }
+        if (st.st_size > 0) {
+            void *p = mmap(
+                nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                close(fd);
+                return false;
+            }
+            mapping = p;
+            mappingSize = (size_t)st.st_size;
+        }
+        close(fd);
+        return true;
+#else
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+        buffer.assign(
+            std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>());
+        return true;
+#endif
+    }
+
+    const uint8_t *data() const
+    {
+        return mapping ? (const uint8_t *)mapping : buffer.data();
+    }
+    size_t size() const { return mapping ? mappingSize : buffer.size(); }
+    uint8_t operator[](size_t i) const { return data()[i]; }
+
+private:
+    void *mapping;
+    size_t mappingSize;
+    std::vector<uint8_t> buffer;
+};
+
+// Fills in the header and MAC around entries, which the caller has
+// already placed after SNAPSHOT_HEADER_SIZE bytes of file, and writes it
+// to a temporary file renamed over path
+static void WriteSnapshot(
+    const std::string &path,
+    SnapshotKind kind,
+    size_t entrySize,
+    size_t count,
+    const uint8_t *salt,
+    std::vector<uint8_t> &file,
+    const Bytes &authKey)
+{
+    uint8_t *header = file.data();
+    memset(header, 0, SNAPSHOT_HEADER_SIZE);
+    memcpy(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    Util::IntToFourBytes(header + 8, SNAPSHOT_VERSION);
+    Util::IntToFourBytes(header + 12, kind);
+    Util::IntToFourBytes(header + 16, (uint32_t)entrySize);
+    memcpy(header + 20, &SNAPSHOT_BYTE_ORDER, 4);
+    Util::IntToFourBytes(header + 24, (uint32_t)((uint64_t)count >> 32));
+    Util::IntToFourBytes(header + 28, (uint32_t)count);
+    memcpy(header + 32, salt, CACHE_SALT_SIZE);
+
+    const size_t macOffset = file.size();
+    file.resize(macOffset + SNAPSHOT_MAC_SIZE);
+    SnapshotMac(file.data() + macOffset, file.data(), macOffset, authKey);
+
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        out.write((const char *)file.data(), file.size());
+        if (!out.good()) {
+            std::remove(tmpPath.c_str());
+            throw std::runtime_error("Can't write cache snapshot " + path);
+        }
+    }
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.c_str());
+        throw std::runtime_error("Can't write cache snapshot " + path);
+    }
+}
+
+// Reads and authenticates a snapshot, returning its salt and the offset
+// and count of its entries within file
+static bool ReadSnapshot(
+    const std::string &path,
+    SnapshotKind kind,
+    size_t entrySize,
+    const Bytes &authKey,
+    SnapshotFile &file,
+    uint8_t *salt,
+    size_t &count)
+{
+    if (!file.Open(path)) {
+        return false;
+    }
+    if (file.size() < SNAPSHOT_HEADER_SIZE + SNAPSHOT_MAC_SIZE) {
+        return false;
+    }
+
+    const size_t macOffset = file.size() - SNAPSHOT_MAC_SIZE;
+    uint8_t mac[SNAPSHOT_MAC_SIZE];
+    SnapshotMac(mac, file.data(), macOffset, authKey);
+    uint8_t diff = 0;
+    for (size_t i = 0; i < SNAPSHOT_MAC_SIZE; i++) {
+        diff |= mac[i] ^ file[macOffset + i];
+    }
+    if (diff != 0) {
+        return false;
+    }
+
+    const uint8_t *header = file.data();
+    uint32_t byteOrder;
+    memcpy(&byteOrder, header + 20, 4);
+    const uint64_t n = ((uint64_t)Util::FourBytesToInt(header + 24) << 32) |
+                       Util::FourBytesToInt(header + 28);
+    if (memcmp(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        Util::FourBytesToInt(header + 8) != SNAPSHOT_VERSION ||
+        Util::FourBytesToInt(header + 12) != kind ||
+        Util::FourBytesToInt(header + 16) != entrySize ||
+        byteOrder != SNAPSHOT_BYTE_ORDER ||
+        n != (macOffset - SNAPSHOT_HEADER_SIZE) / entrySize ||
+        (macOffset - SNAPSHOT_HEADER_SIZE) % entrySize != 0) {
+        return false;
+    }
+    memcpy(salt, header + 32, CACHE_SALT_SIZE);
+    count = (size_t)n;
+    return true;
+}
+
+SignatureCache::SignatureCache(size_t nMaxEntries) : nMaxEntries(nMaxEntries)
+{
+    RandomCacheSalt(salt);
+    entries.reserve(nMaxEntries);
+}
+
+CacheKey SignatureCacheKey(
+    const uint8_t *salt,
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    CacheKey key;
+    SaltedDigest(
+        key.data(),
+        salt,
+        {Bytes((const uint8_t *)ciphersuite.data(), ciphersuite.size()),
+         pubkey,
+         signature,
+         message});
+    return key;
+}
+
+bool SignatureCache::Contains(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    bool fFound;
+    {
+        // Load replaces the salt under the exclusive lock
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        const CacheKey key =
+            SignatureCacheKey(salt, ciphersuite, pubkey, message, signature);
+        fFound = entries.count(key) != 0;
+    }
+    if (fFound) {
+        nHits++;
+    } else {
+        nMisses++;
+    }
+    return fFound;
+}
+
+void SignatureCache::Insert(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    if (nMaxEntries == 0) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    const CacheKey key =
+        SignatureCacheKey(salt, ciphersuite, pubkey, message, signature);
+    if (!entries.insert(key).second) {
+        return;
+    }
+    order.push_back(key);
+    if (order.size() > nMaxEntries) {
+        entries.erase(order.front());
+        order.pop_front();
+    }
+}
+
+void SignatureCache::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    entries.clear();
+    order.clear();
+}
+
+size_t SignatureCache::Size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return entries.size();
+}
+
+void SignatureCache::Save(const std::string &path, const Bytes &authKey) const
+{
+    CheckSnapshotKey(authKey);
+    std::vector<uint8_t> file(SNAPSHOT_HEADER_SIZE);
+    uint8_t fileSalt[CACHE_SALT_SIZE];
+    size_t count;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        count = order.size();
+        memcpy(fileSalt, salt, CACHE_SALT_SIZE);
+        file.reserve(
+            SNAPSHOT_HEADER_SIZE + count * sizeof(CacheKey) +
+            SNAPSHOT_MAC_SIZE);
+        for (const CacheKey &key : order) {
+            file.insert(file.end(), key.begin(), key.end());
+        }
+    }
+    WriteSnapshot(
+        path,
+        SNAPSHOT_SIGNATURES,
+        sizeof(CacheKey),
+        count,
+        fileSalt,
+        file,
+        authKey);
+}
+
+bool SignatureCache::Load(const std::string &path, const Bytes &authKey)
+{
+    CheckSnapshotKey(authKey);
+    SnapshotFile file;
+    uint8_t fileSalt[CACHE_SALT_SIZE];
+    size_t count;
+    if (!ReadSnapshot(
+            path,
+            SNAPSHOT_SIGNATURES,
+            sizeof(CacheKey),
+            authKey,
+            file,
+            fileSalt,
+            count)) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    entries.clear();
+    order.clear();
+    memcpy(salt, fileSalt, CACHE_SALT_SIZE);
+    const size_t skip = count > nMaxEntries ? count - nMaxEntries : 0;
+    for (size_t i = skip; i < count; i++) {
+        CacheKey key;
+        memcpy(
+            key.data(),
+            file.data() + SNAPSHOT_HEADER_SIZE + i * sizeof(CacheKey),
+            sizeof(CacheKey));
+        if (entries.insert(key).second) {
+            order.push_back(key);
+        }
+    }
+    return true;
+}
+
+static std::shared_ptr<SignatureCacheBase> globalSignatureCache;
+
+std::shared_ptr<SignatureCacheBase> SignatureCacheBase::GetGlobal()
+{
+    return std::atomic_load(&globalSignatureCache);
+}
+
+void SignatureCacheBase::SetGlobal(
+    std::shared_ptr<SignatureCacheBase> cache)
+{
+    std::atomic_store(&globalSignatureCache, std::move(cache));
+}
+
+PairingCache::PairingCache(size_t nMaxEntries) : nMaxEntries(nMaxEntries)
+{
+    RandomCacheSalt(salt);
+    entries.reserve(nMaxEntries);
+}
+
+CacheKey PairingCache::MakeKey(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message) const
+{
+    CacheKey key;
+    SaltedDigest(
+        key.data(),
+        salt,
+        {Bytes((const uint8_t *)ciphersuite.data(), ciphersuite.size()),
+         pubkey,
+         message});
+    return key;
+}
+
+bool PairingCache::Get(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    blst_fp12 *out)
+{
+    bool fFound = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        const CacheKey key = MakeKey(ciphersuite, pubkey, message);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            *out = it->second;
+            fFound = true;
+        }
+    }
+    if (fFound) {
+        nHits++;
+    } else {
+        nMisses++;
+    }
+    return fFound;
+}
+
+void PairingCache::Insert(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const blst_fp12 &millerLoop)
+{
+    if (nMaxEntries == 0) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    const CacheKey key = MakeKey(ciphersuite, pubkey, message);
+    if (!entries.emplace(key, millerLoop).second) {
+        return;
+    }
+    order.push_back(key);
+    if (order.size() > nMaxEntries) {
+        entries.erase(order.front());
+        order.pop_front();
+    }
+}
+
+void PairingCache::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    entries.clear();
+    order.clear();
+}
+
+size_t PairingCache::Size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    return entries.size();
+}
+
+static const size_t PAIRING_ENTRY_SIZE = sizeof(CacheKey) + sizeof(blst_fp12);
+
+void PairingCache::Save(const std::string &path, const Bytes &authKey) const
+{
+    CheckSnapshotKey(authKey);
+    std::vector<uint8_t> file(SNAPSHOT_HEADER_SIZE);
+    uint8_t fileSalt[CACHE_SALT_SIZE];
+    size_t count;
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        count = order.size();
+        memcpy(fileSalt, salt, CACHE_SALT_SIZE);
+        file.resize(SNAPSHOT_HEADER_SIZE + count * PAIRING_ENTRY_SIZE);
+        uint8_t *entry = file.data() + SNAPSHOT_HEADER_SIZE;
+        for (const CacheKey &key : order) {
+            memcpy(entry, key.data(), sizeof(CacheKey));
+            memcpy(
+                entry + sizeof(CacheKey),
+                &entries.at(key),
+                sizeof(blst_fp12));
+            entry += PAIRING_ENTRY_SIZE;
+        }
+    }
+    WriteSnapshot(
+        path,
+        SNAPSHOT_PAIRINGS,
+        PAIRING_ENTRY_SIZE,
+        count,
+        fileSalt,
+        file,
+        authKey);
+}
+
+bool PairingCache::Load(const std::string &path, const Bytes &authKey)
+{
+    CheckSnapshotKey(authKey);
+    SnapshotFile file;
+    uint8_t fileSalt[CACHE_SALT_SIZE];
+    size_t count;
+    if (!ReadSnapshot(
+            path,
+            SNAPSHOT_PAIRINGS,
+            PAIRING_ENTRY_SIZE,
+            authKey,
+            file,
+            fileSalt,
+            count)) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mtx);
+    entries.clear();
+    order.clear();
+    memcpy(salt, fileSalt, CACHE_SALT_SIZE);
+    const size_t skip = count > nMaxEntries ? count - nMaxEntries : 0;
+    for (size_t i = skip; i < count; i++) {
+        const uint8_t *entry =
+            file.data() + SNAPSHOT_HEADER_SIZE + i * PAIRING_ENTRY_SIZE;
+        CacheKey key;
+        blst_fp12 millerLoop;
+        memcpy(key.data(), entry, sizeof(CacheKey));
+        memcpy(&millerLoop, entry + sizeof(CacheKey), sizeof(blst_fp12));
+        if (entries.emplace(key, millerLoop).second) {
+            order.push_back(key);
+        }
+    }
+    return true;
+}
+
+}  // end namespace bls
@@ -0,0 +1,199 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SRC_BLSCACHE_HPP_
+#define SRC_BLSCACHE_HPP_
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "elements.hpp"
+
+namespace bls {
+
+static const size_t CACHE_SALT_SIZE = 32;
+
+// Salted SHA-256 digest identifying a cache entry
+typedef std::array<uint8_t, 32> CacheKey;
+
+struct CacheKeyHash {
+    size_t operator()(const CacheKey &key) const;
+};
+
+// Fills salt with CACHE_SALT_SIZE random bytes
+void RandomCacheSalt(uint8_t *salt);
+
+// Key of a (ciphersuite, pubkey, message, signature) tuple: the SHA-256 of
+// the salt followed by the length prefixed fields
+CacheKey SignatureCacheKey(
+    const uint8_t *salt,
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature);
+
+/*
+ * Set of (ciphersuite, pubkey, message, signature) tuples known to verify.
+ */
+class SignatureCacheBase {
+public:
+    virtual ~SignatureCacheBase() {}
+
+    // True if the tuple was inserted and not evicted since. Counts a hit or
+    // a miss.
+    virtual bool Contains(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature) = 0;
+
+    // Records a tuple that verified successfully
+    virtual void Insert(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature) = 0;
+
+    // Cache consulted by the schemes' Verify, none by default. Verify
+    // skips the pairing on a hit and records successful verifications.
+    static std::shared_ptr<SignatureCacheBase> GetGlobal();
+    static void SetGlobal(std::shared_ptr<SignatureCacheBase> cache);
+};
+
+/*
+ * Bounded, thread safe, in process SignatureCacheBase. Entries are keyed by
+ * a SHA-256 digest of the tuple prefixed with a random per-cache salt, so
+ * callers can't craft colliding or bucket-flooding inputs. When full, the
+ * oldest entry is evicted.
+ */
+class SignatureCache : public SignatureCacheBase {
+public:
+    explicit SignatureCache(size_t nMaxEntries);
+
+    SignatureCache(const SignatureCache &) = delete;
+    SignatureCache &operator=(const SignatureCache &) = delete;
+
+    bool Contains(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature) override;
+
+    void Insert(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature) override;
+
+    void Clear();
+
+    // Writes the entries, oldest first, to a snapshot file authenticated
+    // with HMAC-SHA256 under authKey. Throws std::runtime_error on I/O
+    // errors.
+    void Save(const std::string &path, const Bytes &authKey) const;
+
+    // Replaces the contents with a snapshot written by Save, keeping the
+    // newest entries if it holds more than Capacity(). Returns false,
+    // leaving the cache unchanged, if the file is missing, malformed or
+    // fails authentication. Adopts the snapshot's salt, which the other
+    // calls only read under the lock.
+    bool Load(const std::string &path, const Bytes &authKey);
+
+    size_t Size() const;
+    size_t Capacity() const { return nMaxEntries; }
+    uint64_t Hits() const { return nHits; }
+    uint64_t Misses() const { return nMisses; }
+
+private:
+    const size_t nMaxEntries;
+    uint8_t salt[CACHE_SALT_SIZE];
+
+    mutable std::shared_mutex mtx;
+    std::unordered_set<CacheKey, CacheKeyHash> entries;
+    std::deque<CacheKey> order;  // insertion order, for eviction
+
+    std::atomic<uint64_t> nHits{0};
+    std::atomic<uint64_t> nMisses{0};
+};
+
+/*
+ * Bounded, thread safe map from (ciphersuite, pubkey, message) to the
+ * Miller loop of e(pubkey, H(message)), i.e. the pairing before the final
+ * exponentiation, so that products of cached pairs still need only one.
+ * Keys are salted like SignatureCache's and the oldest entry is evicted
+ * when full.
+ */
+class PairingCache {
+public:
+    explicit PairingCache(size_t nMaxEntries);
+
+    PairingCache(const PairingCache &) = delete;
+    PairingCache &operator=(const PairingCache &) = delete;
+
+    // Copies the cached Miller loop to out and returns true, if present.
+    // pubkey is the compressed encoding. Counts a hit or a miss.
+    bool Get(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        blst_fp12 *out);
+
+    void Insert(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const blst_fp12 &millerLoop);
+
+    void Clear();
+
+    // Snapshots, as for SignatureCache. The Miller loops are stored in
+    // blst's in-memory form, so a snapshot is only portable between
+    // builds with the same limb layout; others are rejected on Load.
+    void Save(const std::string &path, const Bytes &authKey) const;
+    bool Load(const std::string &path, const Bytes &authKey);
+
+    size_t Size() const;
+    size_t Capacity() const { return nMaxEntries; }
+    uint64_t Hits() const { return nHits; }
+    uint64_t Misses() const { return nMisses; }
+
+private:
+    // Callers hold mtx, under which Load replaces the salt
+    CacheKey MakeKey(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message) const;
+
+    const size_t nMaxEntries;
+    uint8_t salt[CACHE_SALT_SIZE];
+
+    mutable std::shared_mutex mtx;
+    std::unordered_map<CacheKey, blst_fp12, CacheKeyHash> entries;
+    std::deque<CacheKey> order;  // insertion order, for eviction
+
+    std::atomic<uint64_t> nHits{0};
+    std::atomic<uint64_t> nMisses{0};
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSCACHE_HPP_
@@ -0,0 +1,28 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSCPUFEATURES_HPP_
+#define SRC_BLSCPUFEATURES_HPP_
+
+namespace bls {
+
+// Internal to the library, not included by bls.hpp. Applies the enabled
+// CPU features (see BLS::GetEnabledCpuFeatures) to blst the first time it
+// is called; later calls only check a flag. The element and key
+// constructors through which data first reaches blst call it.
+void ApplyCpuFeatures();
+
+}  // end namespace bls
+
+#endif  // SRC_BLSCPUFEATURES_HPP_
@@ -14,12 +14,198 @@
 
 #include <string.h>
 
+#include <atomic>
 #include <cstring>
+#include <exception>
+#include <memory>
 
 #include "bls.hpp"
+#include "cpufeatures.hpp"
+#include "field.hpp"
 
 namespace bls {
 
+// Runs fn(begin, end) over chunks covering [0, n), on the default thread
+// pool when fParallel. A chunk's exception is kept and the one of the
+// lowest chunk is rethrown, so errors do not depend on scheduling.
+static void BatchForEachRange(
+    size_t n,
+    bool fParallel,
+    const std::function<void(size_t, size_t)>& fn)
+{
+    if (!fParallel) {
+        fn(0, n);
+        return;
+    }
+
+    ThreadPool& pool = ThreadPool::Default();
+    std::vector<std::exception_ptr> errors(pool.NumChunks(n));
+    pool.ParallelFor(n, [&](size_t chunk, size_t begin, size_t end) {
+        try {
+            fn(begin, end);
+        } catch (...) {
+            errors[chunk] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+// Runs fn(i) for every i in [0, n), as BatchForEachRange. Each chunk stops
+// at its first exception.
+static void BatchForEach(
+    size_t n,
+    bool fParallel,
+    const std::function<void(size_t)>& fn)
+{
+    BatchForEachRange(n, fParallel, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            fn(i);
+        }
+    });
+}
+
+// Resolves a backend the batch APIs were given, throwing if unavailable
+static FpBackend BatchBackend(FpBackend backend, const char* function)
+{
+    if (!FpHasBackend(backend)) {
+        throw std::invalid_argument(
+            std::string(function) + ": backend not available");
+    }
+    return backend == FP_AUTO ? FpDefaultBackend() : backend;
+}
+
+template <typename Element>
+static std::vector<Element> FromBytesBatchImpl(
+    const std::vector<Bytes>& bytes,
+    bool fParallel)
+{
+    std::vector<Element> elements(bytes.size());
+    BatchForEach(bytes.size(), fParallel, [&](size_t i) {
+        elements[i] = Element::FromBytes(bytes[i]);
+    });
+    return elements;
+}
+
+template <typename Element>
+static bool AllValidImpl(const std::vector<Element>& elements, bool fParallel)
+{
+    std::atomic<bool> fValid{true};
+    BatchForEach(elements.size(), fParallel, [&](size_t i) {
+        if (fValid.load(std::memory_order_relaxed) && !elements[i].IsValid()) {
+            fValid = false;
+        }
+    });
+    return fValid;
+}
+
+// Big endian field modulus p
+static const uint8_t FIELD_MODULUS[48] = {
+    0x1a, 0x01, 0x11, 0xea, 0x39, 0x7f, 0xe6, 0x9a, 0x4b, 0x1b, 0xa7, 0xb6,
+    0x43, 0x4b, 0xac, 0xd7, 0x64, 0x77, 0x4b, 0x84, 0xf3, 0x85, 0x12, 0xbf,
+    0x67, 0x30, 0xd2, 0xa0, 0xf6, 0xb0, 0xf6, 0x24, 0x1e, 0xab, 0xff, 0xfe,
+    0xb1, 0x53, 0xff, 0xff, 0xb9, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xaa, 0xab};
+
+// Checks the flags of a compressed point with nCoords big endian field
+// coordinates, that infinity is canonical and that each coordinate is < p
+static bool HasValidCompressedEncoding(Bytes bytes, size_t nCoords)
+{
+    if (bytes.size() != nCoords * sizeof(FIELD_MODULUS)) {
+        return false;
+    }
+    const uint8_t flags = bytes[0] & 0xe0;
+    if (flags & 0x40) {
+        // Canonical infinity: the flags and nothing else
+        return bytes[0] == 0xc0 &&
+               Util::HasOnlyZeros(Bytes(bytes.begin() + 1, bytes.size() - 1));
+    }
+    if (!(flags & 0x80)) {
+        return false;
+    }
+    for (size_t c = 0; c < nCoords; c++) {
+        uint8_t coord[sizeof(FIELD_MODULUS)];
+        memcpy(coord, bytes.begin() + c * sizeof(coord), sizeof(coord));
+        if (c == 0) {
+            coord[0] &= 0x1f;
+        }
+        if (memcmp(coord, FIELD_MODULUS, sizeof(coord)) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// (p - 1) / 2, big endian. Compressed points flag the root above it.
+static const uint8_t HALF_FIELD_MODULUS[48] = {
+    0x0d, 0x00, 0x88, 0xf5, 0x1c, 0xbf, 0xf3, 0x4d, 0x25, 0x8d, 0xd3, 0xdb,
+    0x21, 0xa5, 0xd6, 0x6b, 0xb2, 0x3b, 0xa5, 0xc2, 0x79, 0xc2, 0x89, 0x5f,
+    0xb3, 0x98, 0x69, 0x50, 0x7b, 0x58, 0x7b, 0x12, 0x0f, 0x55, 0xff, 0xff,
+    0x58, 0xa9, 0xff, 0xff, 0xdc, 0xff, 0x7f, 0xff, 0xff, 0xff, 0xd5, 0x55};
+
+// FromBytes for bytes[begin, end), with the square roots of the y
+// coordinates computed together on backend. Encodings other than a finite
+// point go through FromBytes, which returns infinity or throws, and the
+// first invalid input in index order throws.
+static void G1FromBytesRange(
+    const std::vector<Bytes>& bytes,
+    std::vector<G1Element>& elements,
+    size_t begin,
+    size_t end,
+    FpBackend backend)
+{
+    const size_t n = end - begin;
+    std::vector<blst_fp> xs(n), ys(n);
+    std::unique_ptr<bool[]> fRoots(new bool[n]);
+    std::vector<bool> fFinite(n);
+
+    uint8_t four[G1Element::SIZE] = {0};
+    four[G1Element::SIZE - 1] = 4;
+    blst_fp b;
+    blst_fp_from_bendian(&b, four);
+    for (size_t i = 0; i < n; i++) {
+        const Bytes& encoded = bytes[begin + i];
+        fFinite[i] =
+            HasValidCompressedEncoding(encoded, 1) &&
+            !(encoded[0] & 0x40) &&
+            !Util::HasOnlyZeros(Bytes(encoded.begin() + 1, encoded.size() - 1));
+        if (!fFinite[i]) {
+            memset(&ys[i], 0, sizeof(blst_fp));
+            continue;
+        }
+        uint8_t x[G1Element::SIZE];
+        memcpy(x, encoded.begin(), sizeof(x));
+        x[0] &= 0x1f;
+        blst_fp_from_bendian(&xs[i], x);
+        // y^2 = x^3 + 4
+        blst_fp_sqr(&ys[i], &xs[i]);
+        blst_fp_mul(&ys[i], &ys[i], &xs[i]);
+        blst_fp_add(&ys[i], &ys[i], &b);
+    }
+    FpSqrtBatch(ys.data(), fRoots.get(), ys.data(), n, backend);
+
+    for (size_t i = 0; i < n; i++) {
+        const Bytes& encoded = bytes[begin + i];
+        if (!fFinite[i]) {
+            elements[begin + i] = G1Element::FromBytes(encoded);
+            continue;
+        }
+        if (!fRoots[i]) {
+            throw std::invalid_argument("G1Element::FromBytes: Invalid bytes");
+        }
+        uint8_t y[G1Element::SIZE];
+        blst_bendian_from_fp(y, &ys[i]);
+        const bool fLarger = memcmp(y, HALF_FIELD_MODULUS, sizeof(y)) > 0;
+        blst_fp_cneg(&ys[i], &ys[i], fLarger != ((encoded[0] & 0x20) != 0));
+        blst_p1_affine affine = {xs[i], ys[i]};
+        G1Element ele = G1Element::FromAffine(affine);
+        ele.CheckValid();
+        elements[begin + i] = ele;
+    }
+}
+
 const size_t G1Element::SIZE;
 
 G1Element G1Element::FromBytes(Bytes const bytes)
@@ -31,6 +217,7 @@ G1Element G1Element::FromBytes(Bytes const bytes)
 
 G1Element G1Element::FromBytesUnchecked(Bytes const bytes)
 {
+    ApplyCpuFeatures();
     if (bytes.size() != SIZE) {
         throw std::invalid_argument("G1Element::FromBytes: Invalid size");
     }
@@ -66,6 +253,11 @@ G1Element G1Element::FromBytesUnchecked(Bytes const bytes)
     return G1Element::FromAffine(a);
 }
 
+bool G1Element::HasValidEncoding(Bytes const bytes)
+{
+    return HasValidCompressedEncoding(bytes, 1);
+}
+
 G1Element G1Element::FromByteVector(const std::vector<uint8_t>& bytevec)
 {
     return G1Element::FromBytes(Bytes(bytevec));
@@ -73,6 +265,7 @@ G1Element G1Element::FromByteVector(const std::vector<uint8_t>& bytevec)
 
 G1Element G1Element::FromNative(const blst_p1& element)
 {
+    ApplyCpuFeatures();
     G1Element ele;
     memcpy(&(ele.p), &element, sizeof(blst_p1));
     return ele;
@@ -80,11 +273,38 @@ G1Element G1Element::FromNative(const blst_p1& element)
 
 G1Element G1Element::FromAffine(const blst_p1_affine& element)
 {
+    ApplyCpuFeatures();
     G1Element ele;
     blst_p1_from_affine(&(ele.p), &element);
     return ele;
 }
 
+std::vector<G1Element> G1Element::FromBytesBatch(
+    const std::vector<Bytes>& bytes,
+    bool fParallel,
+    FpBackend backend)
+{
+    backend = BatchBackend(backend, "G1Element::FromBytesBatch");
+    if (backend == FP_BLST) {
+        return FromBytesBatchImpl<G1Element>(bytes, fParallel);
+    }
+    ApplyCpuFeatures();
+    std::vector<G1Element> elements(bytes.size());
+    BatchForEachRange(bytes.size(), fParallel, [&](size_t begin, size_t end) {
+        G1FromBytesRange(bytes, elements, begin, end, backend);
+    });
+    return elements;
+}
+
+bool G1Element::AllValid(
+    const std::vector<G1Element>& elements,
+    bool fParallel,
+    FpBackend backend)
+{
+    BatchBackend(backend, "G1Element::AllValid");
+    return AllValidImpl(elements, fParallel);
+}
+
 G1Element G1Element::FromMessage(
     const std::vector<uint8_t>& message,
     const uint8_t* dst,
@@ -98,6 +318,7 @@ G1Element G1Element::FromMessage(
     const uint8_t* dst,
     int dst_len)
 {
+    ApplyCpuFeatures();
     G1Element ans;
     const byte* aug = nullptr;
     size_t aug_len = 0;
@@ -117,11 +338,60 @@ G1Element G1Element::FromMessage(
 
 G1Element G1Element::Generator()
 {
+    ApplyCpuFeatures();
     G1Element ele;
     ele.p = *(blst_p1_generator());
     return ele;
 }
 
+G1Element G1Element::MultiScalarMul(
+    const std::vector<G1Element>& points,
+    const uint8_t* scalars,
+    size_t nbits)
+{
+    const size_t n = points.size();
+    G1Element ans;
+    if (n == 0) {
+        return ans;
+    }
+
+    // Infinity adds nothing, and its zero Z would spoil the shared
+    // inversion that normalizes the other points, so leave it out
+    const size_t scalarLen = (nbits + 7) / 8;
+    std::vector<const blst_p1*> nativePtrs;
+    std::vector<const byte*> scalarPtrs;
+    nativePtrs.reserve(n);
+    scalarPtrs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!blst_p1_is_inf(&points[i].p)) {
+            nativePtrs.push_back(&points[i].p);
+            scalarPtrs.push_back(scalars + i * scalarLen);
+        }
+    }
+    const size_t m = nativePtrs.size();
+    if (m == 0) {
+        return ans;
+    }
+
+    std::vector<blst_p1_affine> affines(m);
+    std::vector<const blst_p1_affine*> affinePtrs(m);
+    for (size_t i = 0; i < m; i++) {
+        affinePtrs[i] = &affines[i];
+    }
+    blst_p1s_to_affine(affines.data(), nativePtrs.data(), m);
+
+    std::vector<limb_t> scratch(
+        blst_p1s_mult_pippenger_scratch_sizeof(m) / sizeof(limb_t));
+    blst_p1s_mult_pippenger(
+        &ans.p,
+        affinePtrs.data(),
+        m,
+        scalarPtrs.data(),
+        nbits,
+        scratch.data());
+    return ans;
+}
+
 bool G1Element::IsValid() const
 {
     // Infinity was considered a valid G1Element in older Relic versions
@@ -226,6 +496,7 @@ G2Element G2Element::FromBytes(Bytes const bytes)
 
 G2Element G2Element::FromBytesUnchecked(Bytes const bytes)
 {
+    ApplyCpuFeatures();
     if (bytes.size() != SIZE) {
         throw std::invalid_argument("G2Element::FromBytes: Invalid size");
     }
@@ -238,6 +509,11 @@ G2Element G2Element::FromBytesUnchecked(Bytes const bytes)
     return G2Element::FromAffine(a);
 }
 
+bool G2Element::HasValidEncoding(Bytes const bytes)
+{
+    return HasValidCompressedEncoding(bytes, 2);
+}
+
 G2Element G2Element::FromByteVector(const std::vector<uint8_t>& bytevec)
 {
     return G2Element::FromBytes(Bytes(bytevec));
@@ -245,6 +521,7 @@ G2Element G2Element::FromByteVector(const std::vector<uint8_t>& bytevec)
 
 G2Element G2Element::FromNative(const blst_p2& element)
 {
+    ApplyCpuFeatures();
     G2Element ele;
     memcpy(&(ele.q), &element, sizeof(blst_p2));
     return ele;
@@ -252,11 +529,30 @@ G2Element G2Element::FromNative(const blst_p2& element)
 
 G2Element G2Element::FromAffine(const blst_p2_affine& element)
 {
+    ApplyCpuFeatures();
     G2Element ele;
     blst_p2_from_affine(&(ele.q), &element);
     return ele;
 }
 
+std::vector<G2Element> G2Element::FromBytesBatch(
+    const std::vector<Bytes>& bytes,
+    bool fParallel,
+    FpBackend backend)
+{
+    BatchBackend(backend, "G2Element::FromBytesBatch");
+    return FromBytesBatchImpl<G2Element>(bytes, fParallel);
+}
+
+bool G2Element::AllValid(
+    const std::vector<G2Element>& elements,
+    bool fParallel,
+    FpBackend backend)
+{
+    BatchBackend(backend, "G2Element::AllValid");
+    return AllValidImpl(elements, fParallel);
+}
+
 G2Element G2Element::FromMessage(
     const std::vector<uint8_t>& message,
     const uint8_t* dst,
@@ -270,6 +566,7 @@ G2Element G2Element::FromMessage(
     const uint8_t* dst,
     int dst_len)
 {
+    ApplyCpuFeatures();
     G2Element ans;
     const byte* aug = nullptr;
     size_t aug_len = 0;
@@ -287,13 +584,119 @@ G2Element G2Element::FromMessage(
     return ans;
 }
 
+std::vector<G2Element> G2Element::FromMessages(
+    const std::vector<std::vector<uint8_t>>& messages,
+    const uint8_t* dst,
+    int dst_len,
+    bool fParallel)
+{
+    return FromMessages(
+        std::vector<Bytes>(messages.begin(), messages.end()),
+        dst,
+        dst_len,
+        fParallel);
+}
+
+std::vector<G2Element> G2Element::FromMessages(
+    const std::vector<Bytes>& messages,
+    const uint8_t* dst,
+    int dst_len,
+    bool fParallel)
+{
+    ApplyCpuFeatures();
+    const size_t n = messages.size();
+    std::vector<blst_p2> hashes(n);
+    std::vector<blst_p2_affine> affines(n);
+    auto hashRange = [&](size_t begin, size_t end) {
+        if (begin == end) {
+            return;
+        }
+        for (size_t i = begin; i < end; i++) {
+            blst_hash_to_g2(
+                &hashes[i],
+                messages[i].begin(),
+                messages[i].size(),
+                dst,
+                dst_len,
+                nullptr,
+                0);
+        }
+        // Montgomery's trick: one inversion for the whole range
+        const blst_p2* points[2] = {hashes.data() + begin, nullptr};
+        blst_p2s_to_affine(affines.data() + begin, points, end - begin);
+    };
+    if (fParallel) {
+        ThreadPool::Default().ParallelFor(
+            n, [&](size_t, size_t begin, size_t end) {
+                hashRange(begin, end);
+            });
+    } else {
+        hashRange(0, n);
+    }
+
+    std::vector<G2Element> elements(n);
+    for (size_t i = 0; i < n; i++) {
+        blst_p2_from_affine(&elements[i].q, &affines[i]);
+    }
+    return elements;
+}
+
 G2Element G2Element::Generator()
 {
+    ApplyCpuFeatures();
     G2Element ele;
     ele.q = (*blst_p2_generator());
     return ele;
 }
 
+G2Element G2Element::MultiScalarMul(
+    const std::vector<G2Element>& points,
+    const uint8_t* scalars,
+    size_t nbits)
+{
+    const size_t n = points.size();
+    G2Element ans;
+    if (n == 0) {
+        return ans;
+    }
+
+    // Infinity adds nothing, and its zero Z would spoil the shared
+    // inversion that normalizes the other points, so leave it out
+    const size_t scalarLen = (nbits + 7) / 8;
+    std::vector<const blst_p2*> nativePtrs;
+    std::vector<const byte*> scalarPtrs;
+    nativePtrs.reserve(n);
+    scalarPtrs.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (!blst_p2_is_inf(&points[i].q)) {
+            nativePtrs.push_back(&points[i].q);
+            scalarPtrs.push_back(scalars + i * scalarLen);
+        }
+    }
+    const size_t m = nativePtrs.size();
+    if (m == 0) {
+        return ans;
+    }
+
+    std::vector<blst_p2_affine> affines(m);
+    std::vector<const blst_p2_affine*> affinePtrs(m);
+    for (size_t i = 0; i < m; i++) {
+        affinePtrs[i] = &affines[i];
+    }
+    blst_p2s_to_affine(affines.data(), nativePtrs.data(), m);
+
+    std::vector<limb_t> scratch(
+        blst_p2s_mult_pippenger_scratch_sizeof(m) / sizeof(limb_t));
+    blst_p2s_mult_pippenger(
+        &ans.q,
+        affinePtrs.data(),
+        m,
+        scalarPtrs.data(),
+        nbits,
+        scratch.data());
+    return ans;
+}
+
 bool G2Element::IsValid() const
 {
     // Infinity was considered a valid G2Element in older Relic versions
@@ -387,16 +790,16 @@ const size_t GTElement::SIZE;
 GTElement GTElement::FromBytes(Bytes const bytes)
 {
     GTElement ele = GTElement::FromBytesUnchecked(bytes);
-    //
-    // this doesn't seem to be the proper check as it doesn't work as expeced
-    //
-    // if (!blst_fp12_in_group(&(ele.r)))
-    //     throw std::invalid_argument("GTElement is invalid");
+    // Pow and Inverse are only correct in the order r subgroup. Miller loop
+    // outputs such as FromAffine's are not in it, and need FromBytesUnchecked.
+    if (!blst_fp12_in_group(&(ele.r)))
+        throw std::invalid_argument("GTElement is invalid");
     return ele;
 }
 
 GTElement GTElement::FromBytesUnchecked(Bytes const bytes)
 {
+    ApplyCpuFeatures();
     if (bytes.size() != SIZE) {
         throw std::invalid_argument("GTElement::FromBytes: Invalid size");
     }
@@ -412,6 +815,7 @@ GTElement GTElement::FromByteVector(const std::vector<uint8_t>& bytevec)
 
 GTElement GTElement::FromNative(const blst_fp12* element)
 {
+    ApplyCpuFeatures();
     GTElement ele = GTElement();
     ele.r = *element;
     return ele;
@@ -419,6 +823,7 @@ GTElement GTElement::FromNative(const blst_fp12* element)
 
 GTElement GTElement::FromAffine(const blst_p1_affine& affine)
 {
+    ApplyCpuFeatures();
     GTElement ele = GTElement();
     blst_aggregated_in_g1(&ele.r, &affine);
     return ele;
@@ -426,16 +831,205 @@ GTElement GTElement::FromAffine(const blst_p1_affine& affine)
 
 GTElement GTElement::FromAffine(const blst_p2_affine& affine)
 {
+    ApplyCpuFeatures();
     GTElement ele = GTElement();
     blst_aggregated_in_g2(&ele.r, &affine);
     return ele;
 }
 
-GTElement GTElement::Unity()
+GTElement GTElement::Unity() { return GTElement::FromNative(blst_fp12_one()); }
+
+// Fixed window used for GT exponentiation, tables hold 2^GT_WINDOW powers
+static const size_t GT_WINDOW = 4;
+static const size_t GT_TABLE_SIZE = 1 << GT_WINDOW;
+static const size_t GT_SCALAR_WINDOWS = 256 / GT_WINDOW;
+
+// Returns window i of a little endian 256 bit scalar
+static size_t GTScalarWindow(const byte* scalar, size_t i)
 {
-    GTElement ele = GTElement();
-    ele.FromNative(blst_fp12_one());
-    return ele;
+    return (scalar[i / 2] >> ((i % 2) * GT_WINDOW)) & (GT_TABLE_SIZE - 1);
+}
+
+// Fills table with base^0 ... base^(GT_TABLE_SIZE - 1)
+static void GTPrecompute(blst_fp12* table, const blst_fp12& base)
+{
+    table[0] = *blst_fp12_one();
+    table[1] = base;
+    for (size_t i = 2; i < GT_TABLE_SIZE; i++) {
+        blst_fp12_mul(&table[i], &table[i - 1], &base);
+    }
+}
+
+// Reads table[index] touching every entry, so the memory access pattern
+// doesn't depend on the (possibly secret) index
+static void GTSelect(blst_fp12* out, const blst_fp12* table, size_t index)
+{
+    const size_t nLimbs = sizeof(blst_fp12) / sizeof(limb_t);
+    limb_t* dst = reinterpret_cast<limb_t*>(out);
+    memset(dst, 0x00, sizeof(blst_fp12));
+    for (size_t i = 0; i < GT_TABLE_SIZE; i++) {
+        const limb_t mask = (limb_t)0 - (limb_t)(i == index);
+        const limb_t* src = reinterpret_cast<const limb_t*>(&table[i]);
+        for (size_t j = 0; j < nLimbs; j++) {
+            dst[j] |= src[j] & mask;
+        }
+    }
+}
+
+GTElement GTElement::Product(const std::vector<GTElement>& elements)
+{
+    GTElement ans = GTElement::Unity();
+    for (const GTElement& element : elements) {
+        ans *= element;
+    }
+    return ans;
+}
+
+GTElement GTElement::MultiPow(
+    const std::vector<GTElement>& elements,
+    const std::vector<blst_scalar>& scalars)
+{
+    if (elements.size() != scalars.size()) {
+        throw std::length_error(
+            "GTElement::MultiPow: elements and scalars sizes differ");
+    }
+    const size_t n = elements.size();
+
+    std::vector<blst_fp12> tables(n * GT_TABLE_SIZE);
+    std::vector<byte> scalarBytes(n * 32);
+    for (size_t i = 0; i < n; i++) {
+        GTPrecompute(&tables[i * GT_TABLE_SIZE], elements[i].r);
+        blst_lendian_from_scalar(&scalarBytes[i * 32], &scalars[i]);
+    }
+
+    GTElement ans = GTElement::Unity();
+    bool fStarted = false;
+    for (size_t w = GT_SCALAR_WINDOWS; w-- > 0;) {
+        if (fStarted) {
+            for (size_t j = 0; j < GT_WINDOW; j++) {
+                blst_fp12_cyclotomic_sqr(&ans.r, &ans.r);
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            const size_t index = GTScalarWindow(&scalarBytes[i * 32], w);
+            if (index != 0) {
+                blst_fp12_mul(
+                    &ans.r, &ans.r, &tables[i * GT_TABLE_SIZE + index]);
+                fStarted = true;
+            }
+        }
+    }
+    return ans;
+}
+
+// Multiplies the Miller loops of pairs [begin, end) into out, skipping
+// pairs with a point at infinity as their pairing is unity
+static void MillerLoopRange(
+    blst_fp12* out,
+    const std::vector<G1Element>& g1s,
+    const std::vector<G2Element>& g2s,
+    size_t begin,
+    size_t end)
+{
+    blst_p1_affine aff1;
+    blst_p2_affine aff2;
+    blst_fp12 ml;
+
+    *out = *blst_fp12_one();
+    for (size_t i = begin; i < end; i++) {
+        g1s[i].ToAffine(&aff1);
+        g2s[i].ToAffine(&aff2);
+        if (blst_p1_affine_is_inf(&aff1) || blst_p2_affine_is_inf(&aff2)) {
+            continue;
+        }
+        blst_miller_loop(&ml, &aff2, &aff1);
+        blst_fp12_mul(out, out, &ml);
+    }
+}
+
+// Returns the unreduced product of the Miller loops of all pairs
+static blst_fp12 MillerLoopProduct(
+    const std::vector<G1Element>& g1s,
+    const std::vector<G2Element>& g2s,
+    bool fParallel)
+{
+    if (g1s.size() != g2s.size()) {
+        throw std::length_error("GTElement::MultiPair: sizes differ");
+    }
+
+    blst_fp12 ans;
+    if (!fParallel) {
+        MillerLoopRange(&ans, g1s, g2s, 0, g1s.size());
+        return ans;
+    }
+
+    ThreadPool& pool = ThreadPool::Default();
+    std::vector<blst_fp12> partials(pool.NumChunks(g1s.size()));
+    pool.ParallelFor(
+        g1s.size(), [&](size_t chunk, size_t begin, size_t end) {
+            MillerLoopRange(&partials[chunk], g1s, g2s, begin, end);
+        });
+
+    ans = *blst_fp12_one();
+    for (const blst_fp12& partial : partials) {
+        blst_fp12_mul(&ans, &ans, &partial);
+    }
+    return ans;
+}
+
+GTElement GTElement::MultiPair(
+    const std::vector<G1Element>& g1s,
+    const std::vector<G2Element>& g2s,
+    bool fParallel)
+{
+    const blst_fp12 ml = MillerLoopProduct(g1s, g2s, fParallel);
+    GTElement ans;
+    blst_final_exp(&ans.r, &ml);
+    return ans;
+}
+
+bool GTElement::PairingProductIsOne(
+    const std::vector<G1Element>& g1s,
+    const std::vector<G2Element>& g2s,
+    bool fParallel)
+{
+    return GTElement::MultiPair(g1s, g2s, fParallel).IsUnity();
+}
+
+bool GTElement::IsUnity() const { return blst_fp12_is_one(&r); }
+
+void GTElement::ToNative(blst_fp12* output) const
+{
+    memcpy(output, &r, sizeof(blst_fp12));
+}
+
+GTElement GTElement::Inverse() const
+{
+    GTElement ans = GTElement::FromNative(&r);
+    blst_fp12_conjugate(&ans.r);
+    return ans;
+}
+
+GTElement GTElement::Pow(const blst_scalar& k) const
+{
+    blst_fp12 table[GT_TABLE_SIZE];
+    GTPrecompute(table, r);
+
+    byte* bte = Util::SecAlloc<byte>(32);
+    blst_lendian_from_scalar(bte, &k);
+
+    GTElement ans = GTElement::Unity();
+    blst_fp12 term;
+    for (size_t w = GT_SCALAR_WINDOWS; w-- > 0;) {
+        for (size_t j = 0; j < GT_WINDOW; j++) {
+            blst_fp12_cyclotomic_sqr(&ans.r, &ans.r);
+        }
+        GTSelect(&term, table, GTScalarWindow(bte, w));
+        blst_fp12_mul(&ans.r, &ans.r, &term);
+    }
+    Util::SecFree(bte);
+
+    return ans;
 }
 
 bool operator==(GTElement const& a, GTElement const& b)
@@ -467,13 +1061,24 @@ GTElement operator&(const G1Element& a, const G2Element& b)
     return ret;
 }
 
-GTElement operator*(GTElement& a, GTElement& b)
+GTElement& operator*=(GTElement& a, const GTElement& b)
+{
+    blst_fp12_mul(&(a.r), &(a.r), &(b.r));
+    return a;
+}
+
+GTElement operator*(const GTElement& a, const GTElement& b)
 {
     GTElement ans;
     blst_fp12_mul(&(ans.r), &(a.r), &(b.r));
     return ans;
 }
 
+GTElement operator/(const GTElement& a, const GTElement& b)
+{
+    return a * b.Inverse();
+}
+
 void GTElement::Serialize(uint8_t* buffer) const
 {
     memcpy(buffer, &r, GTElement::SIZE);
@@ -20,6 +20,7 @@ extern "C" {
 }
 #include <utility>
 
+#include "field.hpp"
 #include "util.hpp"
 
 namespace bls {
@@ -38,6 +39,29 @@ public:
     static G1Element FromByteVector(const std::vector<uint8_t> &bytevec);
     static G1Element FromNative(const blst_p1 &element);
     static G1Element FromAffine(const blst_p1_affine &element);
+
+    // Byte level checks of a compressed encoding: size, flags, canonical
+    // infinity and coordinates below the field modulus. Much cheaper than
+    // FromBytes, and false for most garbage, but true doesn't mean it
+    // decodes to a valid element.
+    static bool HasValidEncoding(Bytes bytes);
+
+    // Deserializes and validates many elements, spread over the default
+    // thread pool unless fParallel is false. Throws like FromBytes for the
+    // first invalid input. The square roots of the y coordinates run on
+    // backend, and std::invalid_argument is thrown if it's unavailable.
+    static std::vector<G1Element> FromBytesBatch(
+        const std::vector<Bytes> &bytes,
+        bool fParallel = true,
+        FpBackend backend = FP_AUTO);
+
+    // True if every element is valid, checking them on the default thread
+    // pool unless fParallel is false. The subgroup checks run on blst
+    // whatever the backend, which is only checked to be available.
+    static bool AllValid(
+        const std::vector<G1Element> &elements,
+        bool fParallel = true,
+        FpBackend backend = FP_AUTO);
     static G1Element FromMessage(
         const std::vector<uint8_t> &message,
         const uint8_t *dst,
@@ -48,6 +72,14 @@ public:
         int dst_len);
     static G1Element Generator();
 
+    // Computes the sum of scalars[i] * points[i] using Pippenger's
+    // algorithm. scalars holds points.size() consecutive little endian
+    // scalars of nbits bits each. Runs in variable time.
+    static G1Element MultiScalarMul(
+        const std::vector<G1Element> &points,
+        const uint8_t *scalars,
+        size_t nbits);
+
     bool IsValid() const;
     void CheckValid() const;
     void ToNative(blst_p1 *output) const;
@@ -81,6 +113,29 @@ public:
     static G2Element FromByteVector(const std::vector<uint8_t> &bytevec);
     static G2Element FromNative(const blst_p2 &element);
     static G2Element FromAffine(const blst_p2_affine &element);
+
+    // Byte level checks of a compressed encoding: size, flags, canonical
+    // infinity and coordinates below the field modulus. Much cheaper than
+    // FromBytes, and false for most garbage, but true doesn't mean it
+    // decodes to a valid element.
+    static bool HasValidEncoding(Bytes bytes);
+
+    // Deserializes and validates many elements, spread over the default
+    // thread pool unless fParallel is false. Throws like FromBytes for the
+    // first invalid input. G2 decompression runs on blst whatever the
+    // backend, which is only checked to be available.
+    static std::vector<G2Element> FromBytesBatch(
+        const std::vector<Bytes> &bytes,
+        bool fParallel = true,
+        FpBackend backend = FP_AUTO);
+
+    // True if every element is valid, checking them on the default thread
+    // pool unless fParallel is false. The subgroup checks run on blst
+    // whatever the backend, which is only checked to be available.
+    static bool AllValid(
+        const std::vector<G2Element> &elements,
+        bool fParallel = true,
+        FpBackend backend = FP_AUTO);
     static G2Element FromMessage(
         const std::vector<uint8_t> &message,
         const uint8_t *dst,
@@ -89,8 +144,30 @@ public:
         Bytes message,
         const uint8_t *dst,
         int dst_len);
+
+    // Hashes many messages, spread over the default thread pool unless
+    // fParallel is false. Each thread normalizes its points to affine with
+    // a single shared inversion, so later ToAffine calls are free.
+    static std::vector<G2Element> FromMessages(
+        const std::vector<std::vector<uint8_t>> &messages,
+        const uint8_t *dst,
+        int dst_len,
+        bool fParallel = true);
+    static std::vector<G2Element> FromMessages(
+        const std::vector<Bytes> &messages,
+        const uint8_t *dst,
+        int dst_len,
+        bool fParallel = true);
     static G2Element Generator();
 
+    // Computes the sum of scalars[i] * points[i] using Pippenger's
+    // algorithm. scalars holds points.size() consecutive little endian
+    // scalars of nbits bits each. Runs in variable time.
+    static G2Element MultiScalarMul(
+        const std::vector<G2Element> &points,
+        const uint8_t *scalars,
+        size_t nbits);
+
     bool IsValid() const;
     void CheckValid() const;
     void ToNative(blst_p2 *output) const;
@@ -115,6 +192,8 @@ class GTElement {
 public:
     static const size_t SIZE = sizeof(blst_fp12);
 
+    // Throws std::invalid_argument unless the element is in GT, the order r
+    // subgroup that pairings map to
     static GTElement FromBytes(Bytes bytes);
     static GTElement FromBytesUnchecked(Bytes bytes);
     static GTElement FromByteVector(const std::vector<uint8_t> &bytevec);
@@ -123,13 +202,52 @@ public:
     static GTElement FromAffine(const blst_p2_affine &element);
     static GTElement Unity();  // unity
 
+    // Multiplies all elements together, returns unity for an empty input
+    static GTElement Product(const std::vector<GTElement> &elements);
+
+    // Computes the product of elements[i]^scalars[i] with one shared
+    // squaring chain. Runs in variable time, so the scalars must be public
+    // (e.g. random batch verification coefficients).
+    static GTElement MultiPow(
+        const std::vector<GTElement> &elements,
+        const std::vector<blst_scalar> &scalars);
+
+    // Computes the product of e(g1s[i], g2s[i]) by accumulating the Miller
+    // loops and running a single final exponentiation. With fParallel set
+    // the Miller loops are spread over ThreadPool::Default().
+    static GTElement MultiPair(
+        const std::vector<G1Element> &g1s,
+        const std::vector<G2Element> &g2s,
+        bool fParallel = false);
+
+    // Checks whether the product of e(g1s[i], g2s[i]) is unity, costing the
+    // same as MultiPair
+    static bool PairingProductIsOne(
+        const std::vector<G1Element> &g1s,
+        const std::vector<G2Element> &g2s,
+        bool fParallel = false);
+
+    bool IsUnity() const;
+    void ToNative(blst_fp12 *output) const;
+
+    // GT elements are unitary, so the inverse is the conjugate. Like Pow,
+    // only correct for elements in GT: pairing outputs, their products and
+    // powers, and FromBytes results.
+    GTElement Inverse() const;
+
+    // Exponentiation using cyclotomic squarings with a fixed window and
+    // constant time table lookups
+    GTElement Pow(const blst_scalar &k) const;
+
     void Serialize(uint8_t *buffer) const;
     std::vector<uint8_t> Serialize() const;
 
     friend bool operator==(GTElement const &a, GTElement const &b);
     friend bool operator!=(GTElement const &a, GTElement const &b);
     friend std::ostream &operator<<(std::ostream &os, const GTElement &s);
-    friend GTElement operator*(GTElement &a, GTElement &b);
+    friend GTElement &operator*=(GTElement &a, const GTElement &b);
+    friend GTElement operator*(const GTElement &a, const GTElement &b);
+    friend GTElement operator/(const GTElement &a, const GTElement &b);
 
 private:
     blst_fp12 r;
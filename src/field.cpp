@@ -0,0 +1,385 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "field.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "bls.hpp"
+
+#if BLS_FP_IFMA
+#include <immintrin.h>
+#endif
+
+namespace bls {
+
+#if BLS_FP_IFMA
+
+#define BLS_IFMA_TARGET __attribute__((target("avx512f,avx512ifma")))
+
+// blst_fp is six little endian 64 bit limbs
+static const size_t FP_LIMBS = 6;
+static_assert(sizeof(blst_fp) == FP_LIMBS * 8, "blst_fp is 384 bits");
+
+// (p + 1) / 4, as p = 3 mod 4
+static const uint64_t FP_SQRT_EXP[FP_LIMBS] = {
+    0xee7fbfffffffeaab,
+    0x07aaffffac54ffff,
+    0xd9cc34a83dac3d89,
+    0xd91dd2e13ce144af,
+    0x92c6e9ed90d2eb35,
+    0x0680447a8e5ff9a6};
+
+// Eight 52 bit limbs per element, in Montgomery form for R = 2^416, and
+// one element per 64 bit lane. Products of 52 bit limbs are added into
+// 64 bit lanes, which take the carries of a whole multiplication.
+static const size_t IFMA_LIMBS = 8;
+static const size_t IFMA_LANES = 8;
+static const uint64_t IFMA_MASK = (1ULL << 52) - 1;
+
+static const uint64_t IFMA_P[IFMA_LIMBS] = {
+    0x000effffffffaaab,
+    0x000feb153ffffb9f,
+    0x0006b0f6241eabff,
+    0x00012bf6730d2a0f,
+    0x000764774b84f385,
+    0x0001ba7b6434bacd,
+    0x0001ea397fe69a4b,
+    0x000000000001a011};
+// -1/p mod 2^52
+static const uint64_t IFMA_N0 = 0x0003fffcfffcfffd;
+
+// 2^448 mod p. Multiplying by it takes blst's x 2^384 to x 2^416.
+static const uint64_t IFMA_TO_MONT[IFMA_LIMBS] = {
+    0x0007fde37dba9366,
+    0x0004e27525bc342b,
+    0x0001f5b1e9778489,
+    0x000b872b2b91b9dc,
+    0x000b206f497dfcaf,
+    0x0004137cc89a9b0b,
+    0x000d9d20d7e39959,
+    0x000000000000411c};
+// 2^384 mod p, which takes x 2^416 back to x 2^384
+static const uint64_t IFMA_FROM_MONT[IFMA_LIMBS] = {
+    0x000900000002fffd,
+    0x0000bc40c0002760,
+    0x0003c758baebf400,
+    0x00057455f4898575,
+    0x000d77ce58537052,
+    0x000071a97a256ec6,
+    0x000ec3fa80e4935c,
+    0x0000000000015f65};
+// 2^416 mod p, one
+static const uint64_t IFMA_ONE[IFMA_LIMBS] = {
+    0x0006480ea8e9b9af,
+    0x00065766c8fe444f,
+    0x0008b540fea96f7d,
+    0x0003b2ee82efd422,
+    0x000a6723e5f0ade5,
+    0x000ff6eb6fdd4230,
+    0x000e06ef23c24a25,
+    0x0000000000014c8e};
+
+// Limb j of eight elements
+struct FpLanes {
+    __m512i l[IFMA_LIMBS];
+};
+
+BLS_IFMA_TARGET static inline void IfmaBroadcast(
+    FpLanes &r,
+    const uint64_t *limbs)
+{
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        r.l[j] = _mm512_set1_epi64((long long)limbs[j]);
+    }
+}
+
+// r = t - p if t >= p, else t, for normalized t < 2p
+BLS_IFMA_TARGET static inline void IfmaReduceOnce(
+    FpLanes &r,
+    const __m512i *t)
+{
+    const __m512i mask = _mm512_set1_epi64(IFMA_MASK);
+    __m512i s[IFMA_LIMBS];
+    __m512i borrow = _mm512_setzero_si512();
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        const __m512i d = _mm512_sub_epi64(
+            _mm512_sub_epi64(t[j], _mm512_set1_epi64(IFMA_P[j])), borrow);
+        s[j] = _mm512_and_si512(d, mask);
+        borrow = _mm512_srli_epi64(d, 63);
+    }
+    const __mmask8 fKeep = _mm512_test_epi64_mask(borrow, borrow);
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        r.l[j] = _mm512_mask_blend_epi64(fKeep, s[j], t[j]);
+    }
+}
+
+// Operand scanning Montgomery multiplication of eight pairs at once
+BLS_IFMA_TARGET static inline void IfmaMulMont(
+    FpLanes &r,
+    const FpLanes &a,
+    const FpLanes &b)
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i n0 = _mm512_set1_epi64(IFMA_N0);
+    __m512i p[IFMA_LIMBS];
+    __m512i acc[IFMA_LIMBS + 1];
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        p[j] = _mm512_set1_epi64(IFMA_P[j]);
+        acc[j] = zero;
+    }
+    acc[IFMA_LIMBS] = zero;
+
+#pragma GCC unroll 8
+    for (size_t i = 0; i < IFMA_LIMBS; i++) {
+#pragma GCC unroll 8
+        for (size_t j = 0; j < IFMA_LIMBS; j++) {
+            acc[j] = _mm512_madd52lo_epu64(acc[j], a.l[j], b.l[i]);
+            acc[j + 1] = _mm512_madd52hi_epu64(acc[j + 1], a.l[j], b.l[i]);
+        }
+        // Only the low 52 bits of acc[0] take part, so m < 2^52
+        const __m512i m = _mm512_madd52lo_epu64(zero, acc[0], n0);
+#pragma GCC unroll 8
+        for (size_t j = 0; j < IFMA_LIMBS; j++) {
+            acc[j] = _mm512_madd52lo_epu64(acc[j], p[j], m);
+            acc[j + 1] = _mm512_madd52hi_epu64(acc[j + 1], p[j], m);
+        }
+        // acc[0] is now a multiple of 2^52: divide by it
+        acc[1] = _mm512_add_epi64(acc[1], _mm512_srli_epi64(acc[0], 52));
+#pragma GCC unroll 8
+        for (size_t j = 0; j < IFMA_LIMBS; j++) {
+            acc[j] = acc[j + 1];
+        }
+        acc[IFMA_LIMBS] = zero;
+    }
+
+    const __m512i mask = _mm512_set1_epi64(IFMA_MASK);
+    for (size_t j = 0; j + 1 < IFMA_LIMBS; j++) {
+        acc[j + 1] =
+            _mm512_add_epi64(acc[j + 1], _mm512_srli_epi64(acc[j], 52));
+        acc[j] = _mm512_and_si512(acc[j], mask);
+    }
+    IfmaReduceOnce(r, acc);
+}
+
+// Lanes where a and b are equal
+BLS_IFMA_TARGET static inline __mmask8 IfmaEqual(
+    const FpLanes &a,
+    const FpLanes &b)
+{
+    __mmask8 fEqual = 0xff;
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        fEqual &= _mm512_cmpeq_epi64_mask(a.l[j], b.l[j]);
+    }
+    return fEqual;
+}
+
+// Moves up to eight blst_fp into lanes and into R = 2^416, from 384 bit
+// little endian words to 52 bit limbs
+BLS_IFMA_TARGET static void IfmaLoad(
+    FpLanes &r,
+    const blst_fp *values,
+    size_t n)
+{
+    alignas(64) uint64_t limbs[IFMA_LIMBS][IFMA_LANES] = {{0}};
+    for (size_t lane = 0; lane < n; lane++) {
+        uint64_t words[FP_LIMBS];
+        memcpy(words, &values[lane], sizeof(words));
+        for (size_t j = 0; j < IFMA_LIMBS; j++) {
+            const size_t word = 52 * j / 64, shift = 52 * j % 64;
+            uint64_t limb = words[word] >> shift;
+            if (shift > 12 && word + 1 < FP_LIMBS) {
+                limb |= words[word + 1] << (64 - shift);
+            }
+            limbs[j][lane] = limb & IFMA_MASK;
+        }
+    }
+    FpLanes words;
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        words.l[j] = _mm512_load_si512(limbs[j]);
+    }
+    FpLanes toMont;
+    IfmaBroadcast(toMont, IFMA_TO_MONT);
+    IfmaMulMont(r, words, toMont);
+}
+
+// The inverse of IfmaLoad
+BLS_IFMA_TARGET static void IfmaStore(
+    blst_fp *values,
+    const FpLanes &a,
+    size_t n)
+{
+    FpLanes fromMont, words;
+    IfmaBroadcast(fromMont, IFMA_FROM_MONT);
+    IfmaMulMont(words, a, fromMont);
+    alignas(64) uint64_t limbs[IFMA_LIMBS][IFMA_LANES];
+    for (size_t j = 0; j < IFMA_LIMBS; j++) {
+        _mm512_store_si512(limbs[j], words.l[j]);
+    }
+    for (size_t lane = 0; lane < n; lane++) {
+        uint64_t out[FP_LIMBS] = {0};
+        for (size_t j = 0; j < IFMA_LIMBS; j++) {
+            const size_t word = 52 * j / 64, shift = 52 * j % 64;
+            out[word] |= limbs[j][lane] << shift;
+            if (shift > 12 && word + 1 < FP_LIMBS) {
+                out[word + 1] |= limbs[j][lane] >> (64 - shift);
+            }
+        }
+        memcpy(&values[lane], out, sizeof(out));
+    }
+}
+
+BLS_IFMA_TARGET static void FpMulIfma(
+    blst_fp &out,
+    const blst_fp &a,
+    const blst_fp &b)
+{
+    FpLanes x, y, r;
+    IfmaLoad(x, &a, 1);
+    IfmaLoad(y, &b, 1);
+    IfmaMulMont(r, x, y);
+    IfmaStore(&out, r, 1);
+}
+
+// FpSqrtPortable for eight values at a time
+BLS_IFMA_TARGET static void FpSqrtIfma(
+    blst_fp *roots,
+    bool *fRoots,
+    const blst_fp *values,
+    size_t n)
+{
+    auto window = [](size_t nibble) {
+        return (FP_SQRT_EXP[nibble / 16] >> (4 * (nibble % 16))) & 0xf;
+    };
+    size_t top = FP_LIMBS * 16 - 1;
+    while (window(top) == 0) {
+        top--;
+    }
+
+    for (size_t begin = 0; begin < n; begin += IFMA_LANES) {
+        const size_t lanes = std::min(IFMA_LANES, n - begin);
+        FpLanes powers[16];
+        IfmaBroadcast(powers[0], IFMA_ONE);
+        IfmaLoad(powers[1], values + begin, lanes);
+        for (size_t i = 2; i < 16; i++) {
+            IfmaMulMont(powers[i], powers[i - 1], powers[1]);
+        }
+
+        FpLanes r = powers[window(top)];
+        for (size_t nibble = top; nibble-- > 0;) {
+            for (size_t i = 0; i < 4; i++) {
+                IfmaMulMont(r, r, r);
+            }
+            if (window(nibble) != 0) {
+                IfmaMulMont(r, r, powers[window(nibble)]);
+            }
+        }
+
+        FpLanes square;
+        IfmaMulMont(square, r, r);
+        const __mmask8 fEqual = IfmaEqual(square, powers[1]);
+        IfmaStore(roots + begin, r, lanes);
+        for (size_t lane = 0; lane < lanes; lane++) {
+            fRoots[begin + lane] = (fEqual >> lane) & 1;
+        }
+    }
+}
+
+#endif  // BLS_FP_IFMA
+
+bool FpHasBackend(FpBackend backend)
+{
+    switch (backend) {
+        case FP_AUTO:
+        case FP_BLST:
+            return true;
+        case FP_IFMA:
+#if BLS_FP_IFMA
+            return (BLS::GetCpuFeatures() & BLS::CPU_AVX512IFMA) != 0;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+static std::atomic<FpBackend> selectedBackend{FP_AUTO};
+
+FpBackend FpDefaultBackend()
+{
+    const FpBackend backend = selectedBackend.load();
+    if (backend != FP_AUTO) {
+        return backend;
+    }
+    if (BLS::GetEnabledCpuFeatures() & BLS::CPU_AVX512IFMA) {
+        return FP_IFMA;
+    }
+    return FP_BLST;
+}
+
+void FpSetDefaultBackend(FpBackend backend)
+{
+    if (!FpHasBackend(backend)) {
+        throw std::invalid_argument(
+            "FpSetDefaultBackend: backend not available");
+    }
+    selectedBackend = backend;
+}
+
+void FpMul(blst_fp &out, const blst_fp &a, const blst_fp &b, FpBackend backend)
+{
+    if (!FpHasBackend(backend)) {
+        throw std::invalid_argument("FpMul: backend not available");
+    }
+    if (backend == FP_AUTO) {
+        backend = FpDefaultBackend();
+    }
+#if BLS_FP_IFMA
+    if (backend == FP_IFMA) {
+        FpMulIfma(out, a, b);
+        return;
+    }
+#endif
+    blst_fp_mul(&out, &a, &b);
+}
+
+void FpSqrtBatch(
+    blst_fp *roots,
+    bool *fRoots,
+    const blst_fp *values,
+    size_t n,
+    FpBackend backend)
+{
+    if (!FpHasBackend(backend)) {
+        throw std::invalid_argument("FpSqrtBatch: backend not available");
+    }
+    if (backend == FP_AUTO) {
+        backend = FpDefaultBackend();
+    }
+#if BLS_FP_IFMA
+    if (backend == FP_IFMA) {
+        FpSqrtIfma(roots, fRoots, values, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) {
+        fRoots[i] = blst_fp_sqrt(&roots[i], &values[i]);
+    }
+}
+
+}  // end namespace bls
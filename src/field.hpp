@@ -0,0 +1,77 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSFIELD_HPP_
+#define SRC_BLSFIELD_HPP_
+
+extern "C" {
+#include "bindings/blst.h"
+}
+#include <cstddef>
+
+// Builds with the AVX-512 IFMA kernel, which needs GCC or Clang target
+// attributes on x86_64
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+#define BLS_FP_IFMA 1
+#endif
+
+namespace bls {
+
+/*
+ * Base field arithmetic for the field work the library batches itself,
+ * such as the square roots of batch G1 decompression. Values are blst_fp,
+ * in blst's Montgomery form, so they pass to and from blst unchanged.
+ *
+ * FP_BLST calls blst. FP_IFMA works on eight values at once with
+ * AVX-512 IFMA, on CPUs that have it.
+ *
+ * FP_AUTO picks FP_IFMA when the BLS::CPU_AVX512IFMA feature is enabled,
+ * else FP_BLST.
+ */
+enum FpBackend {
+    FP_AUTO,
+    FP_BLST,
+    FP_IFMA,
+};
+
+// Whether this build and CPU can run the backend
+bool FpHasBackend(FpBackend backend);
+
+// The backend batched field work uses, never FP_AUTO
+FpBackend FpDefaultBackend();
+
+// Overrides the default, e.g. to test or benchmark a backend, until reset
+// with FP_AUTO. Throws std::invalid_argument for unavailable backends. Not
+// meant to be called while other threads are using the library.
+void FpSetDefaultBackend(FpBackend backend);
+
+void FpMul(
+    blst_fp &out,
+    const blst_fp &a,
+    const blst_fp &b,
+    FpBackend backend = FP_AUTO);
+
+// Square roots of n values. roots[i] is a square root of values[i] when
+// fRoots[i] is true, and fRoots[i] is false for non residues. roots may
+// be values.
+void FpSqrtBatch(
+    blst_fp *roots,
+    bool *fRoots,
+    const blst_fp *values,
+    size_t n,
+    FpBackend backend = FP_AUTO);
+
+}  // end namespace bls
+
+#endif  // SRC_BLSFIELD_HPP_
@@ -157,6 +157,27 @@ public:
         return ret;
     }
 
+    // Counterpart of DeriveChildG2Unhardened, hashing the G2 public key of
+    // the parent. Used by the min-signature-size schemes.
+    static PrivateKey DeriveChildSkUnhardenedG2(
+        const PrivateKey& parentSk,
+        uint32_t index)
+    {
+        uint8_t* buf = Util::SecAlloc<uint8_t>(G2Element::SIZE + 4);
+        uint8_t* digest = Util::SecAlloc<uint8_t>(HASH_LEN);
+        memcpy(
+            buf, parentSk.GetG2Element().Serialize().data(), G2Element::SIZE);
+        Util::IntToFourBytes(buf + G2Element::SIZE, index);
+        Util::Hash256(digest, buf, G2Element::SIZE + 4);
+
+        PrivateKey ret = PrivateKey::Aggregate(
+            {parentSk, PrivateKey::FromBytes(Bytes(digest, HASH_LEN), true)});
+
+        Util::SecFree(buf);
+        Util::SecFree(digest);
+        return ret;
+    }
+
     static G1Element DeriveChildG1Unhardened(
         const G1Element& pk,
         uint32_t index)
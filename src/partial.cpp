@@ -0,0 +1,243 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "partial.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "staticschemes.hpp"
+#include "util.hpp"
+
+namespace bls {
+
+static const uint8_t PARTIAL_VERSION = 2;
+static const size_t FP_SIZE = 48;
+static const size_t FP12_COORDINATES = 12;
+
+bool BatchCheckIsOne(const blst_p2 &sig, const blst_fp12 &loop)
+{
+    blst_fp12 acc = loop;
+    // The Miller loop of infinity is one, and blst has no affine infinity
+    // to run it on
+    if (!blst_p2_is_inf(&sig)) {
+        blst_p1_affine negGenAffine;
+        blst_p2_affine sigAffine;
+        G1Element::Generator().Negate().ToAffine(&negGenAffine);
+        blst_p2_to_affine(&sigAffine, &sig);
+        blst_fp12 sigLoop;
+        blst_miller_loop(&sigLoop, &sigAffine, &negGenAffine);
+        blst_fp12_mul(&acc, &acc, &sigLoop);
+    }
+    blst_final_exp(&acc, &acc);
+    return blst_fp12_is_one(&acc);
+}
+
+PartialVerification::PartialVerification(const std::string &ciphersuite)
+    : ciphersuite(ciphersuite),
+      nPairs(0),
+      millerLoop(*blst_fp12_one()),
+      fDistinctMessages(ciphersuite == BasicSuiteMPL::ID)
+{
+    if (ciphersuite.size() > 255) {
+        throw std::invalid_argument("Ciphersuite id too long");
+    }
+}
+
+PartialVerification::MessageDigest PartialVerification::Digest(
+    const blst_p2_affine &hash)
+{
+    uint8_t compressed[G2Element::SIZE];
+    blst_p2_affine_compress(compressed, &hash);
+    MessageDigest digest;
+    Util::Hash256(digest.data(), compressed, sizeof(compressed));
+    return digest;
+}
+
+void PartialVerification::AddDigests(const std::vector<MessageDigest> &sorted)
+{
+    std::vector<MessageDigest> merged(messageDigests.size() + sorted.size());
+    std::merge(
+        messageDigests.begin(),
+        messageDigests.end(),
+        sorted.begin(),
+        sorted.end(),
+        merged.begin());
+    if (std::adjacent_find(merged.begin(), merged.end()) != merged.end()) {
+        throw std::invalid_argument(
+            "PartialVerification: messages must be distinct");
+    }
+    messageDigests.swap(merged);
+}
+
+// version[1] ciphersuiteLen[1] ciphersuite nPairs[8] millerLoop[12 * 48]
+// signatureShare[96] nDigests[8] digests[nDigests * 32], integers and
+// coordinates big endian
+std::vector<uint8_t> PartialVerification::Serialize() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(
+        2 + ciphersuite.size() + 8 + FP12_COORDINATES * FP_SIZE +
+        G2Element::SIZE + 8 + messageDigests.size() * sizeof(MessageDigest));
+    out.push_back(PARTIAL_VERSION);
+    out.push_back((uint8_t)ciphersuite.size());
+    out.insert(out.end(), ciphersuite.begin(), ciphersuite.end());
+    for (int i = 7; i >= 0; i--) {
+        out.push_back((uint8_t)(nPairs >> (8 * i)));
+    }
+
+    const blst_fp *coordinates = (const blst_fp *)&millerLoop;
+    uint8_t buf[FP_SIZE];
+    for (size_t i = 0; i < FP12_COORDINATES; i++) {
+        blst_bendian_from_fp(buf, &coordinates[i]);
+        out.insert(out.end(), buf, buf + FP_SIZE);
+    }
+
+    const std::vector<uint8_t> share = signatureShare.Serialize();
+    out.insert(out.end(), share.begin(), share.end());
+
+    const uint64_t nDigests = messageDigests.size();
+    for (int i = 7; i >= 0; i--) {
+        out.push_back((uint8_t)(nDigests >> (8 * i)));
+    }
+    for (const MessageDigest &digest : messageDigests) {
+        out.insert(out.end(), digest.begin(), digest.end());
+    }
+    return out;
+}
+
+PartialVerification PartialVerification::FromBytes(Bytes bytes)
+{
+    if (bytes.size() < 2 || bytes[0] != PARTIAL_VERSION) {
+        throw std::invalid_argument("PartialVerification: Invalid encoding");
+    }
+    const size_t idLen = bytes[1];
+    const size_t fixedSize =
+        2 + idLen + 8 + FP12_COORDINATES * FP_SIZE + G2Element::SIZE + 8;
+    if (bytes.size() < fixedSize ||
+        (bytes.size() - fixedSize) % sizeof(MessageDigest) != 0) {
+        throw std::invalid_argument("PartialVerification: Invalid size");
+    }
+    const uint8_t *p = bytes.begin() + 2;
+    PartialVerification partial(std::string((const char *)p, idLen));
+    p += idLen;
+    for (size_t i = 0; i < 8; i++) {
+        partial.nPairs = (partial.nPairs << 8) | p[i];
+    }
+    p += 8;
+
+    // Accept only canonical coordinates, which survive a round trip
+    blst_fp *coordinates = (blst_fp *)&partial.millerLoop;
+    uint8_t check[FP_SIZE];
+    for (size_t i = 0; i < FP12_COORDINATES; i++) {
+        blst_fp_from_bendian(&coordinates[i], p);
+        blst_bendian_from_fp(check, &coordinates[i]);
+        if (memcmp(check, p, FP_SIZE) != 0) {
+            throw std::invalid_argument(
+                "PartialVerification: Non canonical coordinate");
+        }
+        p += FP_SIZE;
+    }
+
+    partial.signatureShare = G2Element::FromBytes(Bytes(p, G2Element::SIZE));
+    p += G2Element::SIZE;
+
+    // Digests are strictly increasing, one per pair where the ciphersuite
+    // needs distinct messages and none otherwise
+    uint64_t nDigests = 0;
+    for (size_t i = 0; i < 8; i++) {
+        nDigests = (nDigests << 8) | p[i];
+    }
+    p += 8;
+    const uint64_t nExpected =
+        partial.fDistinctMessages ? partial.nPairs : 0;
+    if (nDigests != nExpected ||
+        nDigests != (bytes.size() - fixedSize) / sizeof(MessageDigest)) {
+        throw std::invalid_argument("PartialVerification: Invalid digests");
+    }
+    partial.messageDigests.resize(nDigests);
+    for (MessageDigest &digest : partial.messageDigests) {
+        memcpy(digest.data(), p, digest.size());
+        p += digest.size();
+    }
+    if (std::adjacent_find(
+            partial.messageDigests.begin(),
+            partial.messageDigests.end(),
+            std::greater_equal<MessageDigest>()) !=
+        partial.messageDigests.end()) {
+        throw std::invalid_argument("PartialVerification: Invalid digests");
+    }
+    return partial;
+}
+
+void PartialVerification::AddPair(
+    const G1Element &pubkey,
+    const G2Element &hash)
+{
+    blst_p1_affine pkAffine;
+    blst_p2_affine hashAffine;
+    pubkey.ToAffine(&pkAffine);
+    hash.ToAffine(&hashAffine);
+    if (fDistinctMessages) {
+        AddDigests({Digest(hashAffine)});
+    }
+    blst_fp12 loop;
+    blst_miller_loop(&loop, &hashAffine, &pkAffine);
+    blst_fp12_mul(&millerLoop, &millerLoop, &loop);
+    nPairs++;
+}
+
+void PartialVerification::AddSignature(const G2Element &signature)
+{
+    signatureShare += signature;
+}
+
+void PartialVerification::Merge(const PartialVerification &other)
+{
+    if (other.ciphersuite != ciphersuite) {
+        throw std::invalid_argument(
+            "PartialVerification: Ciphersuites differ");
+    }
+    if (fDistinctMessages) {
+        AddDigests(other.messageDigests);
+    }
+    blst_fp12_mul(&millerLoop, &millerLoop, &other.millerLoop);
+    signatureShare += other.signatureShare;
+    nPairs += other.nPairs;
+}
+
+bool PartialVerification::FinalVerify() const
+{
+    // AggregateVerify is false for no pairs, unless the signature is the
+    // identity
+    if (nPairs == 0) {
+        return signatureShare == G2Element();
+    }
+
+    // e(-g1, signature share) * prod e(pk_i, H(m_i)) == 1
+    blst_p2 sig;
+    signatureShare.ToNative(&sig);
+    return BatchCheckIsOne(sig, millerLoop);
+}
+
+bool PartialVerification::FinalVerify(const G2Element &signature) const
+{
+    PartialVerification total(*this);
+    total.AddSignature(signature);
+    return total.FinalVerify();
+}
+
+}  // end namespace bls
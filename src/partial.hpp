@@ -0,0 +1,98 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SRC_BLSPARTIAL_HPP_
+#define SRC_BLSPARTIAL_HPP_
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "elements.hpp"
+
+namespace bls {
+
+/*
+ * Part of an aggregate verification computed elsewhere: the product of the
+ * Miller loops of some (pubkey, message) pairs, before the final
+ * exponentiation, and the sum of the signatures those pairs signed, if
+ * known. Partials of the same ciphersuite merge by multiplying and adding,
+ * so a coordinator can combine the slices of one AggregateVerify computed
+ * by several workers and finish with a single final exponentiation.
+ *
+ * Partials of the basic scheme also carry a digest of each hashed message,
+ * so that a message repeated in different slices is caught when they
+ * merge, as AggregateVerify would catch it within one.
+ *
+ * A partial is only as trustworthy as whoever computed it; FromBytes
+ * checks the encoding, not the pairs behind it.
+ */
+class PartialVerification {
+public:
+    // An empty partial for ciphersuite, with no pairs and no signature
+    explicit PartialVerification(const std::string &ciphersuite);
+
+    static PartialVerification FromBytes(Bytes bytes);
+    std::vector<uint8_t> Serialize() const;
+
+    // Multiplies in e(pubkey, hash), where hash is the message already
+    // hashed (and augmented) for the ciphersuite. Throws
+    // std::invalid_argument if the basic scheme's partial has the hash.
+    void AddPair(const G1Element &pubkey, const G2Element &hash);
+    // Adds a signature, or an aggregate of several, to the share
+    void AddSignature(const G2Element &signature);
+
+    // Combines other into this. Throws std::invalid_argument, leaving this
+    // unchanged, if the ciphersuites differ or if basic scheme partials
+    // share a message.
+    void Merge(const PartialVerification &other);
+
+    // Checks e(g1, signature share) == prod e(pk_i, H(m_i)) over every
+    // pair merged in. The second form also adds signature to the share.
+    bool FinalVerify() const;
+    bool FinalVerify(const G2Element &signature) const;
+
+    const std::string &GetCiphersuite() const { return ciphersuite; }
+    uint64_t NumPairs() const { return nPairs; }
+    const G2Element &GetSignatureShare() const { return signatureShare; }
+
+private:
+    // SHA-256 of a compressed message hash
+    typedef std::array<uint8_t, 32> MessageDigest;
+
+    static MessageDigest Digest(const blst_p2_affine &hash);
+    // Merges sorted digests into messageDigests, throwing on a repeat
+    void AddDigests(const std::vector<MessageDigest> &sorted);
+
+    std::string ciphersuite;
+    uint64_t nPairs;
+    blst_fp12 millerLoop;
+    G2Element signatureShare;
+    // Whether the ciphersuite needs distinct messages, and if so the
+    // sorted digests of the pairs' hashes
+    bool fDistinctMessages;
+    std::vector<MessageDigest> messageDigests;
+
+    friend class CoreMPL;
+};
+
+// Whether e(-g1, sig) * loop is one after the final exponentiation, where
+// loop is a product of Miller loops. Shared by the pairing based checks of
+// the schemes and of PartialVerification.
+bool BatchCheckIsOne(const blst_p2 &sig, const blst_fp12 &loop);
+
+}  // end namespace bls
+
+#endif  // SRC_BLSPARTIAL_HPP_
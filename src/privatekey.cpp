@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include <string.h>
+#include <thread>
 
 #include "bls.hpp"
+#include "cpufeatures.hpp"
 
 namespace bls {
 
@@ -62,11 +64,13 @@ PrivateKey::PrivateKey(const PrivateKey &privateKey)
     privateKey.CheckKeyData();
     AllocateKeyData();
     memcpy(keydata, privateKey.keydata, 32);
+    CopyCaches(privateKey);
 }
 
 PrivateKey::PrivateKey(PrivateKey &&k)
     : keydata(std::exchange(k.keydata, nullptr))
 {
+    CopyCaches(k);
     k.InvalidateCaches();
 }
 
@@ -81,18 +85,35 @@ void PrivateKey::DeallocateKeyData()
     InvalidateCaches();
 }
 
+// Only called by non-const members, which don't race with readers
 void PrivateKey::InvalidateCaches()
 {
-    fG1CacheValid = false;
-    fG2CacheValid = false;
+    g1CacheState.store(CACHE_EMPTY, std::memory_order_relaxed);
+    g2CacheState.store(CACHE_EMPTY, std::memory_order_relaxed);
+}
+
+void PrivateKey::CopyCaches(const PrivateKey &other)
+{
+    if (other.g1CacheState.load(std::memory_order_acquire) == CACHE_READY) {
+        g1Cache = other.g1Cache;
+        g1CacheState.store(CACHE_READY, std::memory_order_release);
+    }
+    if (other.g2CacheState.load(std::memory_order_acquire) == CACHE_READY) {
+        g2Cache = other.g2Cache;
+        g2CacheState.store(CACHE_READY, std::memory_order_release);
+    }
 }
 
 PrivateKey &PrivateKey::operator=(const PrivateKey &other)
 {
     CheckKeyData();
     other.CheckKeyData();
+    if (this == &other) {
+        return *this;
+    }
     InvalidateCaches();
     memcpy(keydata, other.keydata, 32);
+    CopyCaches(other);
     return *this;
 }
 
@@ -100,36 +121,57 @@ PrivateKey &PrivateKey::operator=(PrivateKey &&other)
 {
     DeallocateKeyData();
     keydata = std::exchange(other.keydata, nullptr);
+    CopyCaches(other);
     other.InvalidateCaches();
     return *this;
 }
 
+// Threads racing on an empty cache each compute the element beforehand.
+// The first to claim the cache writes it, and the others only wait for
+// that copy.
+template <class Element>
+const Element &PrivateKey::FillCache(
+    std::atomic<uint8_t> &state,
+    Element &cache,
+    const Element &element)
+{
+    uint8_t expected = CACHE_EMPTY;
+    if (state.compare_exchange_strong(
+            expected, CACHE_FILLING, std::memory_order_acquire)) {
+        cache = element;
+        state.store(CACHE_READY, std::memory_order_release);
+        return cache;
+    }
+    while (state.load(std::memory_order_acquire) != CACHE_READY) {
+        std::this_thread::yield();
+    }
+    return cache;
+}
+
 const G1Element &PrivateKey::GetG1Element() const
 {
-    if (!fG1CacheValid) {
-        CheckKeyData();
-        blst_p1 *p = Util::SecAlloc<blst_p1>(1);
-        blst_sk_to_pk_in_g1(p, keydata);
-
-        g1Cache = G1Element::FromNative(*p);
-        Util::SecFree(p);
-        fG1CacheValid = true;
+    if (g1CacheState.load(std::memory_order_acquire) == CACHE_READY) {
+        return g1Cache;
     }
-    return g1Cache;
+    CheckKeyData();
+    blst_p1 *p = Util::SecAlloc<blst_p1>(1);
+    blst_sk_to_pk_in_g1(p, keydata);
+    const G1Element element = G1Element::FromNative(*p);
+    Util::SecFree(p);
+    return FillCache(g1CacheState, g1Cache, element);
 }
 
 const G2Element &PrivateKey::GetG2Element() const
 {
-    if (!fG2CacheValid) {
-        CheckKeyData();
-        blst_p2 *q = Util::SecAlloc<blst_p2>(1);
-        blst_sk_to_pk_in_g2(q, keydata);
-
-        g2Cache = G2Element::FromNative(*q);
-        Util::SecFree(q);
-        fG2CacheValid = true;
+    if (g2CacheState.load(std::memory_order_acquire) == CACHE_READY) {
+        return g2Cache;
     }
-    return g2Cache;
+    CheckKeyData();
+    blst_p2 *q = Util::SecAlloc<blst_p2>(1);
+    blst_sk_to_pk_in_g2(q, keydata);
+    const G2Element element = G2Element::FromNative(*q);
+    Util::SecFree(q);
+    return FillCache(g2CacheState, g2Cache, element);
 }
 
 G1Element operator*(const G1Element &a, const PrivateKey &k)
@@ -246,9 +288,28 @@ G2Element PrivateKey::SignG2(
     return ret;
 }
 
+G1Element PrivateKey::SignG1(
+    const uint8_t *msg,
+    size_t len,
+    const uint8_t *dst,
+    size_t dst_len) const
+{
+    CheckKeyData();
+
+    blst_p1 *pt = Util::SecAlloc<blst_p1>(1);
+
+    blst_hash_to_g1(pt, msg, len, dst, dst_len, nullptr, 0);
+    blst_sign_pk_in_g2(pt, pt, keydata);
+
+    G1Element ret = G1Element::FromNative(*pt);
+    Util::SecFree(pt);
+    return ret;
+}
+
 void PrivateKey::AllocateKeyData()
 {
     assert(!keydata);
+    ApplyCpuFeatures();
     keydata = Util::SecAlloc<blst_scalar>(1);
     memset(keydata, 0x00, sizeof(blst_scalar));
 }
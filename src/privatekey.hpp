@@ -15,6 +15,8 @@
 #ifndef SRC_BLSPRIVATEKEY_HPP_
 #define SRC_BLSPRIVATEKEY_HPP_
 
+#include <atomic>
+
 #include "elements.hpp"
 
 namespace bls {
@@ -44,6 +46,8 @@ class PrivateKey {
 
     ~PrivateKey();
 
+    // Computed once and cached. Safe to call concurrently on a shared key,
+    // without locks.
     const G1Element& GetG1Element() const;
     const G2Element& GetG2Element() const;
 
@@ -72,6 +76,12 @@ class PrivateKey {
         const uint8_t *dst,
         size_t dst_len) const;
 
+    G1Element SignG1(
+        const uint8_t *msg,
+        size_t len,
+        const uint8_t *dst,
+        size_t dst_len) const;
+
  private:
     // Don't allow public construction, force static methods
     PrivateKey();
@@ -84,15 +94,28 @@ class PrivateKey {
     void DeallocateKeyData();
 
     void InvalidateCaches();
+    // Takes the caches other has filled
+    void CopyCaches(const PrivateKey& other);
 
     // The actual byte data
     blst_scalar* keydata{nullptr};
 
-    mutable bool fG1CacheValid{false};
+    // A cache is written by the first thread to claim it, and read once
+    // it is ready
+    enum CacheState : uint8_t { CACHE_EMPTY, CACHE_FILLING, CACHE_READY };
+
+    mutable std::atomic<uint8_t> g1CacheState{CACHE_EMPTY};
     mutable G1Element g1Cache;
 
-    mutable bool fG2CacheValid{false};
+    mutable std::atomic<uint8_t> g2CacheState{CACHE_EMPTY};
     mutable G2Element g2Cache;
+
+    // Returns cache once it holds element
+    template <class Element>
+    static const Element& FillCache(
+        std::atomic<uint8_t>& state,
+        Element& cache,
+        const Element& element);
 };
 }  // end namespace bls
 
@@ -0,0 +1,222 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "scheduler.hpp"
+
+#include <stdexcept>
+
+#include "threadpool.hpp"
+
+namespace bls {
+
+struct VerifyScheduler::Request {
+    VerifyScheme scheme;
+    std::vector<uint8_t> pubkey;
+    std::vector<uint8_t> message;
+    std::vector<uint8_t> signature;
+    Clock::time_point deadline;
+    uint64_t sequence;
+    std::promise<VerifyStatus> result;
+};
+
+bool VerifyScheduler::LaterDeadline::operator()(
+    const std::shared_ptr<Request> &a,
+    const std::shared_ptr<Request> &b) const
+{
+    if (a->deadline != b->deadline) {
+        return a->deadline > b->deadline;
+    }
+    return a->sequence > b->sequence;
+}
+
+static std::future<VerifyStatus> Answered(VerifyStatus status)
+{
+    std::promise<VerifyStatus> promise;
+    promise.set_value(status);
+    return promise.get_future();
+}
+
+VerifyScheduler::VerifyScheduler(
+    VerifyLaneLimits consensus,
+    VerifyLaneLimits bestEffort)
+    : limits{consensus, bestEffort}
+{
+    if (consensus.nMaxBatch == 0 || bestEffort.nMaxBatch == 0) {
+        throw std::invalid_argument("VerifyScheduler: batches can't be empty");
+    }
+    dispatcher = std::thread([this] { DispatchLoop(); });
+}
+
+VerifyScheduler::~VerifyScheduler() { Stop(); }
+
+void VerifyScheduler::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fStopping = true;
+    }
+    cv.notify_all();
+    if (dispatcher.joinable() &&
+        dispatcher.get_id() != std::this_thread::get_id()) {
+        dispatcher.join();
+    }
+}
+
+size_t VerifyScheduler::Queued(VerifyPriority priority) const
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return lanes[priority].size();
+}
+
+CoreMPL &VerifyScheduler::Scheme(VerifyScheme scheme)
+{
+    if (scheme == VERIFY_BASIC) {
+        return basic;
+    } else if (scheme == VERIFY_POP) {
+        return pop;
+    }
+    return aug;
+}
+
+std::future<VerifyStatus> VerifyScheduler::Submit(
+    VerifyPriority priority,
+    VerifyScheme scheme,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature,
+    Clock::time_point deadline)
+{
+    if (priority > PRIORITY_BEST_EFFORT || scheme > VERIFY_POP) {
+        throw std::invalid_argument("VerifyScheduler: unknown lane or scheme");
+    }
+    // Cheap checks first, so that garbage never costs a pairing
+    if (!G1Element::HasValidEncoding(pubkey) ||
+        !G2Element::HasValidEncoding(signature)) {
+        nMalformed++;
+        return Answered(VERIFY_INVALID);
+    }
+    if (deadline <= Clock::now()) {
+        nExpired++;
+        return Answered(VERIFY_EXPIRED);
+    }
+
+    auto request = std::make_shared<Request>();
+    request->scheme = scheme;
+    request->pubkey.assign(pubkey.begin(), pubkey.end());
+    request->message.assign(message.begin(), message.end());
+    request->signature.assign(signature.begin(), signature.end());
+    request->deadline = deadline;
+    std::future<VerifyStatus> result = request->result.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        Lane &lane = lanes[priority];
+        if (fStopping || lane.size() >= limits[priority].nMaxQueued) {
+            nRejected++;
+            return Answered(VERIFY_REJECTED);
+        }
+        request->sequence = nSequence++;
+        lane.push(std::move(request));
+    }
+    cv.notify_one();
+    return result;
+}
+
+void VerifyScheduler::DispatchLoop()
+{
+    while (true) {
+        std::vector<std::shared_ptr<Request>> batch;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] {
+                return fStopping || !lanes[PRIORITY_CONSENSUS].empty() ||
+                       !lanes[PRIORITY_BEST_EFFORT].empty();
+            });
+            const int priority = !lanes[PRIORITY_CONSENSUS].empty()
+                                     ? PRIORITY_CONSENSUS
+                                     : PRIORITY_BEST_EFFORT;
+            Lane &lane = lanes[priority];
+            if (lane.empty()) {
+                return;  // stopping, and nothing left
+            }
+            const Clock::time_point now = Clock::now();
+            while (!lane.empty() && batch.size() < limits[priority].nMaxBatch) {
+                std::shared_ptr<Request> request = lane.top();
+                lane.pop();
+                if (request->deadline <= now) {
+                    nExpired++;
+                    request->result.set_value(VERIFY_EXPIRED);
+                    continue;
+                }
+                batch.push_back(std::move(request));
+            }
+        }
+        if (!batch.empty()) {
+            VerifyBatch(batch);
+        }
+    }
+}
+
+void VerifyScheduler::VerifyBatch(std::vector<std::shared_ptr<Request>> &batch)
+{
+    // Decompress and check subgroups, in parallel
+    const size_t n = batch.size();
+    std::vector<G1Element> pubkeys(n);
+    std::vector<G2Element> signatures(n);
+    std::vector<uint8_t> fDecoded(n, 0);
+    ThreadPool::Default().ParallelFor(n, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            try {
+                pubkeys[i] = G1Element::FromBytes(Bytes(batch[i]->pubkey));
+                signatures[i] =
+                    G2Element::FromBytes(Bytes(batch[i]->signature));
+                fDecoded[i] = 1;
+            } catch (const std::exception &) {
+                // Passed the byte level checks only
+            }
+        }
+    });
+
+    for (uint8_t s = VERIFY_BASIC; s <= VERIFY_POP; s++) {
+        std::vector<Request *> items;
+        std::vector<std::vector<G1Element>> setPubKeys;
+        std::vector<std::vector<Bytes>> setMessages;
+        std::vector<G2Element> setSigs;
+        for (size_t i = 0; i < n; i++) {
+            if (batch[i]->scheme != s) {
+                continue;
+            }
+            if (!fDecoded[i]) {
+                nMalformed++;
+                batch[i]->result.set_value(VERIFY_INVALID);
+                continue;
+            }
+            items.push_back(batch[i].get());
+            setPubKeys.push_back({pubkeys[i]});
+            setMessages.push_back({Bytes(batch[i]->message)});
+            setSigs.push_back(signatures[i]);
+        }
+        if (items.empty()) {
+            continue;
+        }
+        const std::vector<bool> ok =
+            Scheme((VerifyScheme)s)
+                .AggregateVerifyBatchEach(setPubKeys, setMessages, setSigs);
+        for (size_t i = 0; i < items.size(); i++) {
+            nVerified++;
+            items[i]->result.set_value(ok[i] ? VERIFY_VALID : VERIFY_INVALID);
+        }
+    }
+}
+
+}  // end namespace bls
@@ -0,0 +1,138 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSSCHEDULER_HPP_
+#define SRC_BLSSCHEDULER_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "schemes.hpp"
+#include "verifyd.hpp"
+
+namespace bls {
+
+// Lanes of a VerifyScheduler, in the order they are served
+enum VerifyPriority : uint8_t {
+    PRIORITY_CONSENSUS = 0,
+    PRIORITY_BEST_EFFORT = 1,
+};
+
+enum VerifyStatus : uint8_t {
+    VERIFY_VALID = 0,
+    VERIFY_INVALID = 1,
+    // Not verified: the lane was full or the scheduler stopped
+    VERIFY_REJECTED = 2,
+    // Not verified: the deadline passed while it was queued
+    VERIFY_EXPIRED = 3,
+};
+
+// Bounds of a lane: queued requests beyond nMaxQueued are rejected, and
+// each batch verification takes at most nMaxBatch requests
+struct VerifyLaneLimits {
+    size_t nMaxQueued;
+    size_t nMaxBatch;
+};
+
+/*
+ * Schedules signature verifications in front of the batch verification
+ * engine, so that consensus work keeps a bounded latency under a flood of
+ * best effort requests.
+ *
+ * Submit checks the encodings byte by byte before queueing, so malformed
+ * requests never reach a pairing. A dispatcher thread then takes batches
+ * from the consensus lane while it has requests, and from the best effort
+ * lane otherwise, earliest deadline first within a lane. Requests whose
+ * deadline passed are dropped unverified. A consensus request waits at
+ * most for the batch in flight, whose size the best effort limits bound.
+ * Batches are verified with AggregateVerifyBatchEach on the default
+ * thread pool.
+ */
+class VerifyScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit VerifyScheduler(
+        VerifyLaneLimits consensus = {1 << 16, 256},
+        VerifyLaneLimits bestEffort = {4096, 64});
+    // Stops, verifying what is queued first
+    ~VerifyScheduler();
+
+    VerifyScheduler(const VerifyScheduler &) = delete;
+    VerifyScheduler &operator=(const VerifyScheduler &) = delete;
+
+    // Thread safe. Never blocks: rejected, expired and malformed requests
+    // are answered at once.
+    std::future<VerifyStatus> Submit(
+        VerifyPriority priority,
+        VerifyScheme scheme,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature,
+        Clock::time_point deadline = Clock::time_point::max());
+
+    // Verifies the queued requests and rejects any later submission
+    void Stop();
+
+    size_t Queued(VerifyPriority priority) const;
+    uint64_t Verified() const { return nVerified; }
+    uint64_t Rejected() const { return nRejected; }
+    uint64_t Expired() const { return nExpired; }
+    uint64_t Malformed() const { return nMalformed; }
+
+private:
+    struct Request;
+    struct LaterDeadline {
+        bool operator()(
+            const std::shared_ptr<Request> &a,
+            const std::shared_ptr<Request> &b) const;
+    };
+    using Lane = std::priority_queue<
+        std::shared_ptr<Request>,
+        std::vector<std::shared_ptr<Request>>,
+        LaterDeadline>;
+
+    void DispatchLoop();
+    void VerifyBatch(std::vector<std::shared_ptr<Request>> &batch);
+    CoreMPL &Scheme(VerifyScheme scheme);
+
+    const VerifyLaneLimits limits[2];
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    Lane lanes[2];
+    uint64_t nSequence = 0;
+    bool fStopping = false;
+    std::thread dispatcher;
+
+    BasicSchemeMPL basic;
+    AugSchemeMPL aug;
+    PopSchemeMPL pop;
+
+    std::atomic<uint64_t> nVerified{0};
+    std::atomic<uint64_t> nRejected{0};
+    std::atomic<uint64_t> nExpired{0};
+    std::atomic<uint64_t> nMalformed{0};
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSSCHEDULER_HPP_
@@ -17,315 +17,1913 @@
 #include <string.h>
 
 #include <algorithm>
-#include <set>
+#include <atomic>
+#include <string_view>
+#include <unordered_map>
 
 #include "bls.hpp"
 #include "elements.hpp"
 #include "hdkeys.hpp"
 
+#if BLSALLOC_SODIUM
+#include "sodium.h"
+#else
+#include <random>
+#endif
+
 using std::string;
 using std::vector;
 
-namespace bls {
+namespace bls {
+
+enum InvariantResult { BAD = false, GOOD = true, CONTINUE };
+
+// Enforce argument invariants for Agg Sig Verification
+InvariantResult VerifyAggregateSignatureArguments(
+    const size_t nPubKeys,
+    const size_t nMessages,
+    const G2Element& signature)
+{
+    if (nPubKeys == 0) {
+        return (nMessages == 0 && signature == G2Element() ? GOOD : BAD);
+    }
+    if (nPubKeys != nMessages) {
+        return BAD;
+    }
+    return CONTINUE;
+}
+
+// Same as above for the min-signature-size variant
+InvariantResult VerifyAggregateSignatureArguments(
+    const size_t nPubKeys,
+    const size_t nMessages,
+    const G1Element& signature)
+{
+    if (nPubKeys == 0) {
+        return (nMessages == 0 && signature == G1Element() ? GOOD : BAD);
+    }
+    if (nPubKeys != nMessages) {
+        return BAD;
+    }
+    return CONTINUE;
+}
+
+// Size of the random coefficients used by batch verification
+const size_t BATCH_SCALAR_BITS = 64;
+const size_t BATCH_SCALAR_BYTES = BATCH_SCALAR_BITS / 8;
+
+// Fills buffer with random batch verification coefficients
+void RandomBatchScalars(uint8_t* buffer, size_t count)
+{
+#if BLSALLOC_SODIUM
+    randombytes_buf(buffer, count * BATCH_SCALAR_BYTES);
+#else
+    static thread_local std::random_device rd;
+    for (size_t i = 0; i < count * BATCH_SCALAR_BYTES; i++) {
+        buffer[i] = (uint8_t)rd();
+    }
+#endif
+}
+
+// A blst_pairing context taken from a small per thread pool, so that
+// verification does not allocate one (several KB) on every call.
+class PooledPairing {
+public:
+    // blst keeps a pointer to dst, which must outlive the context's use
+    explicit PooledPairing(std::string_view dst)
+    {
+        Pool& pool = LocalPool();
+        ctx = pool.nFree > 0 ? pool.free[--pool.nFree] : Allocate();
+        blst_pairing_init(
+            ctx, true /*hash*/, (const uint8_t*)dst.data(), dst.length());
+    }
+
+    ~PooledPairing()
+    {
+        Pool& pool = LocalPool();
+        if (pool.nFree < POOL_SIZE) {
+            pool.free[pool.nFree++] = ctx;
+        } else {
+            Free(ctx);
+        }
+    }
+
+    PooledPairing(const PooledPairing&) = delete;
+    PooledPairing& operator=(const PooledPairing&) = delete;
+
+    blst_pairing* get() const { return ctx; }
+
+private:
+    static const size_t POOL_SIZE = 4;
+
+    struct Pool {
+        blst_pairing* free[POOL_SIZE];
+        size_t nFree = 0;
+
+        ~Pool()
+        {
+            while (nFree > 0) {
+                Free(free[--nFree]);
+            }
+        }
+    };
+
+    // 64 bit words keep the context suitably aligned
+    static blst_pairing* Allocate()
+    {
+        return (blst_pairing*)new uint64_t[(blst_pairing_sizeof() + 7) / 8];
+    }
+
+    static void Free(blst_pairing* ctx) { delete[](uint64_t*) ctx; }
+
+    static Pool& LocalPool()
+    {
+        static thread_local Pool pool;
+        return pool;
+    }
+
+    blst_pairing* ctx;
+};
+
+inline const uint8_t* MessageData(const Bytes& message)
+{
+    return message.begin();
+}
+
+inline const uint8_t* MessageData(const vector<uint8_t>& message)
+{
+    return message.data();
+}
+
+inline std::string_view MessageView(const Bytes& message)
+{
+    return std::string_view((const char*)message.begin(), message.size());
+}
+
+inline std::string_view MessageView(const vector<uint8_t>& message)
+{
+    return std::string_view((const char*)message.data(), message.size());
+}
+
+// True if no two messages are equal. Sorts (hash, index) pairs in a per
+// thread scratch buffer and only compares the messages whose hashes collide,
+// so nothing is copied and the steady state does not allocate.
+template <typename Messages>
+bool MessagesAreDistinct(const Messages& messages)
+{
+    static thread_local vector<std::pair<size_t, size_t>> hashes;
+    hashes.clear();
+    for (size_t i = 0; i < messages.size(); i++) {
+        hashes.emplace_back(
+            std::hash<std::string_view>()(MessageView(messages[i])), i);
+    }
+    std::sort(hashes.begin(), hashes.end());
+
+    for (size_t begin = 0, end; begin < hashes.size(); begin = end) {
+        end = begin + 1;
+        while (end < hashes.size() && hashes[end].first == hashes[begin].first) {
+            end++;
+        }
+        for (size_t i = begin; i < end; i++) {
+            for (size_t j = i + 1; j < end; j++) {
+                if (MessageView(messages[hashes[i].second]) ==
+                    MessageView(messages[hashes[j].second])) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+inline void PubKeyToAffine(blst_p1_affine* out, const G1Element& pubkey)
+{
+    pubkey.ToAffine(out);
+}
+
+inline void PubKeyToAffine(blst_p1_affine* out, const Bytes& pubkey)
+{
+    G1Element::FromBytes(pubkey).ToAffine(out);
+}
+
+inline void PubKeyToAffine(blst_p2_affine* out, const G2Element& pubkey)
+{
+    pubkey.ToAffine(out);
+}
+
+inline void PubKeyToAffine(blst_p2_affine* out, const Bytes& pubkey)
+{
+    G2Element::FromBytes(pubkey).ToAffine(out);
+}
+
+// aug, if not null, is hashed in front of the message
+inline BLST_ERROR AggregatePubKey(
+    blst_pairing* ctx,
+    const blst_p1_affine* pubkey,
+    const uint8_t* message,
+    size_t len,
+    const uint8_t* aug = nullptr,
+    size_t augLen = 0)
+{
+    return blst_pairing_aggregate_pk_in_g1(
+        ctx, pubkey, nullptr, message, len, aug, augLen);
+}
+
+inline BLST_ERROR AggregatePubKey(
+    blst_pairing* ctx,
+    const blst_p2_affine* pubkey,
+    const uint8_t* message,
+    size_t len,
+    const uint8_t* aug = nullptr,
+    size_t augLen = 0)
+{
+    return blst_pairing_aggregate_pk_in_g2(
+        ctx, pubkey, nullptr, message, len, aug, augLen);
+}
+
+inline void AggregatedSignature(blst_fp12* out, const G2Element& signature)
+{
+    blst_p2_affine sig_affine;
+    signature.ToAffine(&sig_affine);
+    blst_aggregated_in_g2(out, &sig_affine);
+}
+
+inline void AggregatedSignature(blst_fp12* out, const G1Element& signature)
+{
+    blst_p1_affine sig_affine;
+    signature.ToAffine(&sig_affine);
+    blst_aggregated_in_g1(out, &sig_affine);
+}
+
+// Core of every AggregateVerify overload of both scheme families, generic
+// over how public keys and messages are held so that no overload has to
+// convert its arguments into temporary vectors. The public key group is
+// the one opposite to the signature. fAugment prepends each serialized
+// public key to its message, as the augmented schemes do, and needs the
+// public keys as bytes.
+template <
+    typename PubKeyAffine,
+    bool fAugment = false,
+    typename PubKeys,
+    typename Messages,
+    typename Sig>
+bool AggregateVerifyPairs(
+    std::string_view dst,
+    const PubKeys& pubkeys,
+    const Messages& messages,
+    const Sig& signature)
+{
+    const size_t nPubKeys = pubkeys.size();
+    const auto arg_check =
+        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
+    if (arg_check != CONTINUE) {
+        return arg_check;
+    }
+
+    PooledPairing ctx(dst);
+    PubKeyAffine pk_affine;
+    blst_fp12 gtsig;
+    AggregatedSignature(&gtsig, signature);
+
+    for (size_t i = 0; i < nPubKeys; i++) {
+        PubKeyToAffine(&pk_affine, pubkeys[i]);
+        BLST_ERROR err;
+        if constexpr (fAugment) {
+            err = AggregatePubKey(
+                ctx.get(),
+                &pk_affine,
+                MessageData(messages[i]),
+                messages[i].size(),
+                pubkeys[i].begin(),
+                pubkeys[i].size());
+        } else {
+            err = AggregatePubKey(
+                ctx.get(),
+                &pk_affine,
+                MessageData(messages[i]),
+                messages[i].size());
+        }
+        if (err != BLST_SUCCESS) {
+            return false;
+        }
+    }
+
+    blst_pairing_commit(ctx.get());
+    return blst_pairing_finalverify(ctx.get(), &gtsig);
+}
+
+inline bool CoreVerify(
+    std::string_view dst,
+    const G1Element& pubkey,
+    const Bytes& message,
+    const G2Element& signature)
+{
+    blst_p1_affine pubkeyAffine;
+    blst_p2_affine sigAffine;
+
+    pubkey.ToAffine(&pubkeyAffine);
+    signature.ToAffine(&sigAffine);
+
+    auto err = blst_core_verify_pk_in_g1(
+        &pubkeyAffine,
+        &sigAffine,
+        true, /*hash*/
+        message.begin(),
+        message.size(),
+        (const uint8_t*)dst.data(),
+        dst.length());
+
+    return err == BLST_SUCCESS;
+}
+
+inline bool CoreVerify(
+    std::string_view dst,
+    const G2Element& pubkey,
+    const Bytes& message,
+    const G1Element& signature)
+{
+    blst_p2_affine pubkeyAffine;
+    blst_p1_affine sigAffine;
+
+    pubkey.ToAffine(&pubkeyAffine);
+    signature.ToAffine(&sigAffine);
+
+    auto err = blst_core_verify_pk_in_g2(
+        &pubkeyAffine,
+        &sigAffine,
+        true, /*hash*/
+        message.begin(),
+        message.size(),
+        (const uint8_t*)dst.data(),
+        dst.length());
+
+    return err == BLST_SUCCESS;
+}
+
+// Verify through the global SignatureCache, if one is set. The encodings
+// key the cache, so this variant only parses them on a miss.
+template <typename PubKey, typename Sig>
+bool CachedVerify(
+    std::string_view dst,
+    const Bytes& pubkey,
+    const Bytes& message,
+    const Bytes& signature)
+{
+    const std::shared_ptr<SignatureCacheBase> cache =
+        SignatureCacheBase::GetGlobal();
+    if (cache && cache->Contains(dst, pubkey, message, signature)) {
+        return true;
+    }
+    const bool fValid = CoreVerify(
+        dst, PubKey::FromBytes(pubkey), message, Sig::FromBytes(signature));
+    if (fValid && cache) {
+        cache->Insert(dst, pubkey, message, signature);
+    }
+    return fValid;
+}
+
+template <typename PubKey, typename Sig>
+bool CachedVerify(
+    std::string_view dst,
+    const PubKey& pubkey,
+    const Bytes& message,
+    const Sig& signature)
+{
+    const std::shared_ptr<SignatureCacheBase> cache =
+        SignatureCacheBase::GetGlobal();
+    if (!cache) {
+        return CoreVerify(dst, pubkey, message, signature);
+    }
+    const vector<uint8_t> pubkeyBytes = pubkey.Serialize();
+    const vector<uint8_t> signatureBytes = signature.Serialize();
+    if (cache->Contains(dst, pubkeyBytes, message, signatureBytes)) {
+        return true;
+    }
+    const bool fValid = CoreVerify(dst, pubkey, message, signature);
+    if (fValid) {
+        cache->Insert(dst, pubkeyBytes, message, signatureBytes);
+    }
+    return fValid;
+}
+
+bool MessagesAreDistinct(const MessagesView& messages)
+{
+    return MessagesAreDistinct<MessagesView>(messages);
+}
+
+bool VerifyMPL(
+    std::string_view dst,
+    const G1Element& pubkey,
+    const Bytes& message,
+    const G2Element& signature)
+{
+    return CachedVerify(dst, pubkey, message, signature);
+}
+
+bool VerifyMPL(
+    std::string_view dst,
+    const Bytes& pubkey,
+    const Bytes& message,
+    const Bytes& signature)
+{
+    return CachedVerify<G1Element, G2Element>(dst, pubkey, message, signature);
+}
+
+bool CoreVerifyMPL(
+    std::string_view dst,
+    const G1Element& pubkey,
+    const Bytes& message,
+    const G2Element& signature)
+{
+    return CoreVerify(dst, pubkey, message, signature);
+}
+
+bool AggregateVerifyMPL(
+    std::string_view dst,
+    const PubKeysView& pubkeys,
+    const MessagesView& messages,
+    const G2Element& signature)
+{
+    return AggregateVerifyPairs<blst_p1_affine>(
+        dst, pubkeys, messages, signature);
+}
+
+/* These are all for the min-pubkey-size variant.
+   The min-signature-size analogs follow below.
+*/
+const std::string BasicSchemeMPL::CIPHERSUITE_ID = BasicSuiteMPL::ID;
+const std::string AugSchemeMPL::CIPHERSUITE_ID = AugSuiteMPL::ID;
+const std::string PopSchemeMPL::CIPHERSUITE_ID = PopSuiteMPL::ID;
+const std::string PopSchemeMPL::POP_CIPHERSUITE_ID = PopSuiteMPL::POP_ID;
+
+PrivateKey CoreMPL::KeyGen(const vector<uint8_t>& seed)
+{
+    return HDKeys::KeyGen(seed);
+}
+
+PrivateKey CoreMPL::KeyGen(const Bytes& seed) { return HDKeys::KeyGen(seed); }
+
+vector<uint8_t> CoreMPL::SkToPk(const PrivateKey& seckey)
+{
+    return seckey.GetG1Element().Serialize();
+}
+
+G1Element CoreMPL::SkToG1(const PrivateKey& seckey)
+{
+    return seckey.GetG1Element();
+}
+
+G2Element CoreMPL::Sign(
+    const PrivateKey& seckey,
+    const vector<uint8_t>& message)
+{
+    return CoreMPL::Sign(seckey, Bytes(message));
+}
+
+G2Element CoreMPL::Sign(const PrivateKey& seckey, const Bytes& message)
+{
+    return seckey.SignG2(
+        message.begin(),
+        message.size(),
+        (const uint8_t*)strCiphersuiteId.c_str(),
+        strCiphersuiteId.length());
+}
+
+bool CoreMPL::Verify(
+    const vector<uint8_t>& pubkey,
+    const vector<uint8_t>& message,  // unhashed
+    const vector<uint8_t>& signature)
+{
+    return CoreMPL::Verify(Bytes(pubkey), Bytes(message), Bytes(signature));
+}
+
+bool CoreMPL::Verify(
+    const Bytes& pubkey,
+    const Bytes& message,
+    const Bytes& signature)
+{
+    return CachedVerify<G1Element, G2Element>(
+        strCiphersuiteId, pubkey, message, signature);
+}
+
+bool CoreMPL::Verify(
+    const G1Element& pubkey,
+    const vector<uint8_t>& message,  // unhashed
+    const G2Element& signature)
+{
+    return CoreMPL::Verify(pubkey, Bytes(message), signature);
+}
+
+bool CoreMPL::Verify(
+    const G1Element& pubkey,
+    const Bytes& message,
+    const G2Element& signature)
+{
+    return CachedVerify(strCiphersuiteId, pubkey, message, signature);
+}
+
+vector<uint8_t> CoreMPL::Aggregate(const vector<vector<uint8_t>>& signatures)
+{
+    vector<G2Element> elements;
+    for (const vector<uint8_t>& signature : signatures) {
+        elements.push_back(G2Element::FromByteVector(signature));
+    }
+    return CoreMPL::Aggregate(elements).Serialize();
+}
+
+vector<uint8_t> CoreMPL::Aggregate(const vector<Bytes>& signatures)
+{
+    vector<G2Element> elements;
+    for (const Bytes& signature : signatures) {
+        elements.push_back(G2Element::FromBytes(signature));
+    }
+    return CoreMPL::Aggregate(elements).Serialize();
+}
+
+G2Element CoreMPL::Aggregate(const vector<G2Element>& signatures)
+{
+    G2Element aggregated;
+    for (const G2Element& signature : signatures) {
+        aggregated += signature;
+    }
+    return aggregated;
+}
+
+G1Element CoreMPL::Aggregate(const vector<G1Element>& publicKeys)
+{
+    G1Element aggregated;
+    for (const G1Element& publicKey : publicKeys) {
+        aggregated += publicKey;
+    }
+    return aggregated;
+}
+
+bool CoreMPL::AggregateVerify(
+    const vector<vector<uint8_t>>& pubkeys,
+    const vector<vector<uint8_t>>& messages,  // unhashed
+    const vector<uint8_t>& signature)
+{
+    return AggregateVerifyPairs<blst_p1_affine>(
+        strCiphersuiteId,
+        pubkeys,
+        messages,
+        G2Element::FromByteVector(signature));
+}
+
+bool CoreMPL::AggregateVerify(
+    const vector<Bytes>& pubkeys,
+    const vector<Bytes>& messages,  // unhashed
+    const Bytes& signature)
+{
+    return AggregateVerifyPairs<blst_p1_affine>(
+        strCiphersuiteId, pubkeys, messages, G2Element::FromBytes(signature));
+}
+
+bool CoreMPL::AggregateVerify(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature)
+{
+    return AggregateVerifyPairs<blst_p1_affine>(
+        strCiphersuiteId, pubkeys, messages, signature);
+}
+
+bool CoreMPL::AggregateVerify(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature)
+{
+    return AggregateVerifyPairs<blst_p1_affine>(
+        strCiphersuiteId, pubkeys, messages, signature);
+}
+
+bool CoreMPL::AggregateVerifyCached(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature,
+    PairingCache& cache)
+{
+    return CoreMPL::AggregateVerifyCached(
+        pubkeys,
+        std::vector<Bytes>(messages.begin(), messages.end()),
+        signature,
+        cache);
+}
+
+bool CoreMPL::AggregateVerifyCached(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature,
+    PairingCache& cache)
+{
+    const size_t nPubKeys = pubkeys.size();
+    const auto arg_check =
+        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
+    if (arg_check != CONTINUE) {
+        return arg_check;
+    }
+
+    vector<blst_p1_affine> pkAffines(nPubKeys);
+    vector<std::array<uint8_t, G1Element::SIZE>> pkBytes(nPubKeys);
+    vector<blst_fp12> loops(nPubKeys);
+    vector<size_t> missing;
+    for (size_t i = 0; i < nPubKeys; i++) {
+        pubkeys[i].ToAffine(&pkAffines[i]);
+        // Rejected by blst_pairing_aggregate_pk_in_g1 as well
+        if (blst_p1_affine_is_inf(&pkAffines[i])) {
+            return false;
+        }
+        blst_p1_affine_compress(pkBytes[i].data(), &pkAffines[i]);
+        if (!cache.Get(strCiphersuiteId, pkBytes[i], messages[i], &loops[i])) {
+            missing.push_back(i);
+        }
+    }
+
+    vector<Bytes> missingMessages;
+    missingMessages.reserve(missing.size());
+    for (size_t i : missing) {
+        missingMessages.push_back(messages[i]);
+    }
+    const vector<G2Element> hashes = G2Element::FromMessages(
+        missingMessages,
+        (const uint8_t*)strCiphersuiteId.c_str(),
+        strCiphersuiteId.length());
+    ThreadPool::Default().ParallelFor(
+        missing.size(), [&](size_t, size_t begin, size_t end) {
+            blst_p2_affine hashAffine;
+            for (size_t j = begin; j < end; j++) {
+                const size_t i = missing[j];
+                hashes[j].ToAffine(&hashAffine);
+                blst_miller_loop(&loops[i], &hashAffine, &pkAffines[i]);
+            }
+        });
+    for (size_t i : missing) {
+        cache.Insert(strCiphersuiteId, pkBytes[i], messages[i], loops[i]);
+    }
+
+    // e(-g1, signature) * prod e(pk_i, H(m_i)) == 1
+    blst_fp12 acc = *blst_fp12_one();
+    for (const blst_fp12& loop : loops) {
+        blst_fp12_mul(&acc, &acc, &loop);
+    }
+    blst_p2 sig;
+    signature.ToNative(&sig);
+    return BatchCheckIsOne(sig, acc);
+}
+
+PartialVerification CoreMPL::AggregateVerifyPartial(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages)
+{
+    return CoreMPL::AggregateVerifyPartial(
+        pubkeys, std::vector<Bytes>(messages.begin(), messages.end()));
+}
+
+PartialVerification CoreMPL::AggregateVerifyPartial(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages)
+{
+    const size_t nPubKeys = pubkeys.size();
+    if (messages.size() != nPubKeys) {
+        throw std::invalid_argument(
+            "AggregateVerifyPartial: pubkeys and messages sizes differ");
+    }
+    vector<blst_p1_affine> pkAffines(nPubKeys);
+    for (size_t i = 0; i < nPubKeys; i++) {
+        pubkeys[i].ToAffine(&pkAffines[i]);
+        // Rejected by blst_pairing_aggregate_pk_in_g1 as well
+        if (blst_p1_affine_is_inf(&pkAffines[i])) {
+            throw std::invalid_argument(
+                "AggregateVerifyPartial: infinity public key");
+        }
+    }
+
+    // Each chunk multiplies its Miller loops together
+    const vector<G2Element> hashes = G2Element::FromMessages(
+        messages,
+        (const uint8_t*)strCiphersuiteId.c_str(),
+        strCiphersuiteId.length());
+    PartialVerification partial(strCiphersuiteId);
+    vector<PartialVerification::MessageDigest> digests(
+        partial.fDistinctMessages ? nPubKeys : 0);
+    ThreadPool& pool = ThreadPool::Default();
+    vector<blst_fp12> products(pool.NumChunks(nPubKeys), *blst_fp12_one());
+    pool.ParallelFor(nPubKeys, [&](size_t chunk, size_t begin, size_t end) {
+        blst_p2_affine hashAffine;
+        blst_fp12 loop;
+        for (size_t i = begin; i < end; i++) {
+            hashes[i].ToAffine(&hashAffine);
+            if (!digests.empty()) {
+                digests[i] = PartialVerification::Digest(hashAffine);
+            }
+            blst_miller_loop(&loop, &hashAffine, &pkAffines[i]);
+            blst_fp12_mul(&products[chunk], &products[chunk], &loop);
+        }
+    });
+
+    std::sort(digests.begin(), digests.end());
+    partial.AddDigests(digests);
+    for (const blst_fp12& product : products) {
+        blst_fp12_mul(&partial.millerLoop, &partial.millerLoop, &product);
+    }
+    partial.nPairs = nPubKeys;
+    return partial;
+}
+
+vector<bool> CoreMPL::VerifyManySameKey(
+    const G1Element& pubkey,
+    const vector<vector<uint8_t>>& messages,
+    const vector<G2Element>& signatures)
+{
+    return CoreMPL::VerifyManySameKey(
+        pubkey,
+        std::vector<Bytes>(messages.begin(), messages.end()),
+        signatures);
+}
+
+vector<bool> CoreMPL::VerifyManySameKey(
+    const G1Element& pubkey,
+    const vector<Bytes>& messages,
+    const vector<G2Element>& signatures)
+{
+    const size_t n = messages.size();
+    if (signatures.size() != n) {
+        throw std::length_error(
+            "VerifyManySameKey: messages and signatures sizes differ");
+    }
+
+    // The random linear combination is only sound for signatures in G2
+    bool fBatchOk = n > 1;
+    for (size_t i = 0; i < n && fBatchOk; i++) {
+        fBatchOk = signatures[i].IsValid();
+    }
+
+    if (fBatchOk) {
+        const uint8_t* dst = (const uint8_t*)strCiphersuiteId.c_str();
+        const int dst_len = strCiphersuiteId.length();
+        const vector<G2Element> hashes =
+            G2Element::FromMessages(messages, dst, dst_len);
+
+        vector<uint8_t> scalars(n * BATCH_SCALAR_BYTES);
+        RandomBatchScalars(scalars.data(), n);
+        const G2Element hashSum = G2Element::MultiScalarMul(
+            hashes, scalars.data(), BATCH_SCALAR_BITS);
+        const G2Element sigSum = G2Element::MultiScalarMul(
+            signatures, scalars.data(), BATCH_SCALAR_BITS);
+
+        // Mirror Verify, which rejects the identity public key
+        fBatchOk = pubkey != G1Element() &&
+                   GTElement::PairingProductIsOne(
+                       {pubkey, G1Element::Generator().Negate()},
+                       {hashSum, sigSum});
+    }
+    if (fBatchOk) {
+        return vector<bool>(n, true);
+    }
+
+    vector<bool> results(n);
+    for (size_t i = 0; i < n; i++) {
+        results[i] = CoreMPL::Verify(pubkey, messages[i], signatures[i]);
+    }
+    return results;
+}
+
+bool CoreMPL::AggregateVerifyMerged(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature)
+{
+    return CoreMPL::AggregateVerifyMerged(
+        pubkeys,
+        std::vector<Bytes>(messages.begin(), messages.end()),
+        signature);
+}
+
+bool CoreMPL::AggregateVerifyMerged(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature)
+{
+    const size_t nPubKeys = pubkeys.size();
+    const auto arg_check =
+        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
+    if (arg_check != CONTINUE) {
+        return arg_check;
+    }
+
+    // Plan: number the distinct public keys and distinct messages
+    std::unordered_map<std::string, size_t> pkIndex;
+    std::unordered_map<std::string_view, size_t> messageIndex;
+    vector<size_t> pkGroup(nPubKeys);
+    vector<size_t> messageGroup(nPubKeys);
+    blst_p1_affine pk_affine;
+    for (size_t i = 0; i < nPubKeys; i++) {
+        pubkeys[i].ToAffine(&pk_affine);
+        // Rejected by blst_pairing_aggregate_pk_in_g1 as well
+        if (blst_p1_affine_is_inf(&pk_affine)) {
+            return false;
+        }
+        pkGroup[i] =
+            pkIndex
+                .emplace(
+                    std::string((const char*)&pk_affine, sizeof(pk_affine)),
+                    pkIndex.size())
+                .first->second;
+        messageGroup[i] =
+            messageIndex
+                .emplace(
+                    std::string_view(
+                        (const char*)messages[i].begin(), messages[i].size()),
+                    messageIndex.size())
+                .first->second;
+    }
+
+    const uint8_t* dst = (const uint8_t*)strCiphersuiteId.c_str();
+    const int dst_len = strCiphersuiteId.length();
+    vector<G1Element> g1s;
+    vector<G2Element> g2s;
+    if (messageIndex.size() <= pkIndex.size()) {
+        // e(pk1, H(m)) * e(pk2, H(m)) = e(pk1 + pk2, H(m))
+        g1s.resize(messageIndex.size());
+        vector<Bytes> distinctMessages;
+        distinctMessages.reserve(messageIndex.size());
+        for (size_t i = 0; i < nPubKeys; i++) {
+            const size_t group = messageGroup[i];
+            g1s[group] += pubkeys[i];
+            if (group == distinctMessages.size()) {
+                distinctMessages.push_back(messages[i]);
+            }
+        }
+        g2s = G2Element::FromMessages(distinctMessages, dst, dst_len);
+    } else {
+        // e(pk, H(m1)) * e(pk, H(m2)) = e(pk, H(m1) + H(m2))
+        g1s.resize(pkIndex.size());
+        g2s.resize(pkIndex.size());
+        const vector<G2Element> hashes =
+            G2Element::FromMessages(messages, dst, dst_len);
+        for (size_t i = 0; i < nPubKeys; i++) {
+            const size_t group = pkGroup[i];
+            g1s[group] = pubkeys[i];
+            g2s[group] += hashes[i];
+        }
+    }
+
+    g1s.push_back(G1Element::Generator().Negate());
+    g2s.push_back(signature);
+    return GTElement::PairingProductIsOne(g1s, g2s);
+}
+
+// Sorts the sets of a batch verification by what their arguments decide:
+// fGood[j] is set for the sets that are good without pairings, and the
+// sets that need pairings are appended to setIndex. Returns false if any
+// set is bad, after the first one if fStopOnBad. With fDistinctMessages,
+// sets that repeat a message are bad.
+template <typename PubKeySets, typename MessageSets, typename Signatures>
+static bool PlanBatch(
+    const PubKeySets& pubkeys,
+    const MessageSets& messages,
+    const Signatures& signatures,
+    vector<uint8_t>& fGood,
+    vector<size_t>& setIndex,
+    bool fStopOnBad,
+    bool fDistinctMessages)
+{
+    bool fAllGood = true;
+    for (size_t j = 0; j < signatures.size(); j++) {
+        auto arg_check = VerifyAggregateSignatureArguments(
+            pubkeys[j].size(), messages[j].size(), signatures[j]);
+        if (fDistinctMessages && !MessagesAreDistinct(messages[j])) {
+            arg_check = BAD;
+        }
+        if (arg_check == GOOD) {
+            fGood[j] = 1;
+            continue;
+        }
+        // The random linear combination is only sound for signatures in G2
+        if (arg_check == BAD || !signatures[j].IsValid()) {
+            fAllGood = false;
+            if (fStopOnBad) {
+                return false;
+            }
+            continue;
+        }
+        setIndex.push_back(j);
+    }
+    return fAllGood;
+}
+
+// For each planned set j, the product of the Miller loops of
+// e(r_j * pk_i, H(m_i)) over its pairs, computed in parallel. Sets with an
+// infinity pubkey get fInfinity and a neutral product.
+template <typename PubKeySets, typename MessageSets>
+static void BatchSetLoops(
+    std::string_view dst,
+    const PubKeySets& pubkeys,
+    const MessageSets& messages,
+    const vector<size_t>& setIndex,
+    const uint8_t* scalars,
+    vector<blst_fp12>& setLoops,
+    vector<uint8_t>& fInfinity)
+{
+    vector<Bytes> pairMessages;
+    vector<size_t> pairSet;
+    for (size_t s = 0; s < setIndex.size(); s++) {
+        const auto& set = messages[setIndex[s]];
+        for (size_t i = 0; i < set.size(); i++) {
+            pairMessages.push_back(Bytes(set[i]));
+            pairSet.push_back(s);
+        }
+    }
+    vector<size_t> pairOffset(setIndex.size() + 1, 0);
+    for (size_t s = 0; s < setIndex.size(); s++) {
+        pairOffset[s + 1] = pairOffset[s] + messages[setIndex[s]].size();
+    }
+
+    const vector<G2Element> hashes = G2Element::FromMessages(
+        pairMessages, (const uint8_t*)dst.data(), dst.size());
+    const size_t nPairs = pairMessages.size();
+    vector<blst_fp12> loops(nPairs);
+    fInfinity.assign(setIndex.size(), 0);
+    ThreadPool::Default().ParallelFor(
+        nPairs, [&](size_t, size_t begin, size_t end) {
+            blst_p1_affine pkAffine;
+            blst_p1 pk;
+            blst_p2_affine hashAffine;
+            for (size_t k = begin; k < end; k++) {
+                const size_t s = pairSet[k];
+                pubkeys[setIndex[s]][k - pairOffset[s]].ToAffine(&pkAffine);
+                // Rejected by blst_pairing_aggregate_pk_in_g1 as well
+                if (blst_p1_affine_is_inf(&pkAffine)) {
+                    fInfinity[s] = 1;
+                    loops[k] = *blst_fp12_one();
+                    continue;
+                }
+                blst_p1_from_affine(&pk, &pkAffine);
+                blst_p1_mult(
+                    &pk,
+                    &pk,
+                    scalars + s * BATCH_SCALAR_BYTES,
+                    BATCH_SCALAR_BITS);
+                blst_p1_to_affine(&pkAffine, &pk);
+                hashes[k].ToAffine(&hashAffine);
+                blst_miller_loop(&loops[k], &hashAffine, &pkAffine);
+            }
+        });
+
+    setLoops.assign(setIndex.size(), *blst_fp12_one());
+    for (size_t s = 0; s < setIndex.size(); s++) {
+        if (fInfinity[s]) {
+            continue;
+        }
+        for (size_t k = pairOffset[s]; k < pairOffset[s + 1]; k++) {
+            blst_fp12_mul(&setLoops[s], &setLoops[s], &loops[k]);
+        }
+    }
+}
+
+// Sub-checks over the ranges of sets of a failed batch, each node holding
+// the products of the Miller loops and of the scaled signatures under it,
+// so that no pairing is computed twice. A failing range is split in two,
+// and when its left half passes the right one fails without a check, so k
+// bad sets out of n cost O(k log n) sub-checks.
+class BatchBisection {
+public:
+    BatchBisection(
+        const vector<blst_fp12>& loops,
+        const vector<blst_p2>& sigs,
+        vector<uint8_t>& fGood)
+        : fGood(fGood)
+    {
+        nodes.reserve(2 * loops.size());
+        Build(loops, sigs, 0, loops.size());
+    }
+
+    // Marks the good sets in fGood
+    void Run() { Bisect(0, false); }
+
+private:
+    struct Node {
+        blst_fp12 loop;
+        blst_p2 sig;
+        size_t begin, end;
+        size_t left, right;
+    };
+
+    size_t Build(
+        const vector<blst_fp12>& loops,
+        const vector<blst_p2>& sigs,
+        size_t begin,
+        size_t end)
+    {
+        const size_t index = nodes.size();
+        nodes.push_back(Node());
+        nodes[index].begin = begin;
+        nodes[index].end = end;
+        if (end - begin == 1) {
+            nodes[index].loop = loops[begin];
+            nodes[index].sig = sigs[begin];
+            return index;
+        }
+        const size_t middle = begin + (end - begin) / 2;
+        const size_t left = Build(loops, sigs, begin, middle);
+        const size_t right = Build(loops, sigs, middle, end);
+        Node& node = nodes[index];
+        node.left = left;
+        node.right = right;
+        blst_fp12_mul(&node.loop, &nodes[left].loop, &nodes[right].loop);
+        blst_p2_add_or_double(&node.sig, &nodes[left].sig, &nodes[right].sig);
+        return index;
+    }
+
+    bool Check(size_t index) const
+    {
+        return BatchCheckIsOne(nodes[index].sig, nodes[index].loop);
+    }
+
+    void Bisect(size_t index, bool fFails)
+    {
+        const Node& node = nodes[index];
+        if (!fFails && Check(index)) {
+            std::fill(fGood.begin() + node.begin, fGood.begin() + node.end, 1);
+            return;
+        }
+        if (node.end - node.begin == 1) {
+            return;
+        }
+        if (Check(node.left)) {
+            const Node& left = nodes[node.left];
+            std::fill(fGood.begin() + left.begin, fGood.begin() + left.end, 1);
+            Bisect(node.right, true);
+        } else {
+            Bisect(node.left, true);
+            Bisect(node.right, false);
+        }
+    }
+
+    vector<Node> nodes;
+    vector<uint8_t>& fGood;
+};
+
+// The batch verifications of CoreMPL, over any containers
+template <typename PubKeySets, typename MessageSets, typename Signatures>
+static bool BatchVerify(
+    std::string_view dst,
+    const PubKeySets& pubkeys,
+    const MessageSets& messages,
+    const Signatures& signatures,
+    bool fDistinctMessages)
+{
+    const size_t nSets = signatures.size();
+    if (pubkeys.size() != nSets || messages.size() != nSets) {
+        return false;
+    }
+
+    vector<uint8_t> fGood(nSets, 0);
+    vector<size_t> setIndex;
+    if (!PlanBatch(
+            pubkeys,
+            messages,
+            signatures,
+            fGood,
+            setIndex,
+            true,
+            fDistinctMessages)) {
+        return false;
+    }
+    if (setIndex.empty()) {
+        return true;
+    }
+
+    vector<uint8_t> scalars(setIndex.size() * BATCH_SCALAR_BYTES);
+    RandomBatchScalars(scalars.data(), setIndex.size());
+    vector<blst_fp12> setLoops;
+    vector<uint8_t> fInfinity;
+    BatchSetLoops(
+        dst,
+        pubkeys,
+        messages,
+        setIndex,
+        scalars.data(),
+        setLoops,
+        fInfinity);
+    for (uint8_t fInf : fInfinity) {
+        if (fInf) {
+            return false;
+        }
+    }
+
+    // e(-g1, sum r_j * sig_j) * prod e(r_j * pk_i, H(m_i)) == 1
+    vector<G2Element> setSigs;
+    setSigs.reserve(setIndex.size());
+    for (size_t j : setIndex) {
+        setSigs.push_back(signatures[j]);
+    }
+    const G2Element sigSum = G2Element::MultiScalarMul(
+        setSigs, scalars.data(), BATCH_SCALAR_BITS);
+    blst_p2 sig;
+    sigSum.ToNative(&sig);
+    blst_fp12 acc = *blst_fp12_one();
+    for (const blst_fp12& loop : setLoops) {
+        blst_fp12_mul(&acc, &acc, &loop);
+    }
+    return BatchCheckIsOne(sig, acc);
+}
+
+bool CoreMPL::AggregateVerifyBatch(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<vector<uint8_t>>>& messages,
+    const vector<G2Element>& signatures)
+{
+    vector<vector<Bytes>> vecMessagesBytes;
+    vecMessagesBytes.reserve(messages.size());
+    for (const auto& set : messages) {
+        vecMessagesBytes.emplace_back(set.begin(), set.end());
+    }
+    return CoreMPL::AggregateVerifyBatch(pubkeys, vecMessagesBytes, signatures);
+}
+
+bool CoreMPL::AggregateVerifyBatch(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<Bytes>>& messages,
+    const vector<G2Element>& signatures)
+{
+    return BatchVerify(strCiphersuiteId, pubkeys, messages, signatures, false);
+}
+
+template <typename PubKeySets, typename MessageSets, typename Signatures>
+static vector<bool> BatchVerifyEach(
+    std::string_view dst,
+    const PubKeySets& pubkeys,
+    const MessageSets& messages,
+    const Signatures& signatures,
+    bool fDistinctMessages)
+{
+    const size_t nSets = signatures.size();
+    if (pubkeys.size() != nSets || messages.size() != nSets) {
+        throw std::length_error(
+            "AggregateVerifyBatchEach: pubkeys, messages and signatures "
+            "sizes differ");
+    }
+
+    vector<uint8_t> fGood(nSets, 0);
+    vector<size_t> setIndex;
+    PlanBatch(
+        pubkeys,
+        messages,
+        signatures,
+        fGood,
+        setIndex,
+        false,
+        fDistinctMessages);
+    const size_t nPlanned = setIndex.size();
+    if (nPlanned > 0) {
+        vector<uint8_t> scalars(nPlanned * BATCH_SCALAR_BYTES);
+        RandomBatchScalars(scalars.data(), nPlanned);
+        vector<blst_fp12> setLoops;
+        vector<uint8_t> fInfinity;
+        BatchSetLoops(
+            dst,
+            pubkeys,
+            messages,
+            setIndex,
+            scalars.data(),
+            setLoops,
+            fInfinity);
+
+        // r_j * sig_j of each set, which the sub-checks add up per range
+        vector<blst_p2> setSigs(nPlanned);
+        ThreadPool::Default().ParallelFor(
+            nPlanned, [&](size_t, size_t begin, size_t end) {
+                for (size_t s = begin; s < end; s++) {
+                    blst_p2 sig;
+                    signatures[setIndex[s]].ToNative(&sig);
+                    blst_p2_mult(
+                        &setSigs[s],
+                        &sig,
+                        scalars.data() + s * BATCH_SCALAR_BYTES,
+                        BATCH_SCALAR_BITS);
+                }
+            });
+        for (size_t s = 0; s < nPlanned; s++) {
+            if (fInfinity[s]) {
+                setSigs[s] = blst_p2();  // neutral in every range
+            }
+        }
+
+        vector<uint8_t> fPlannedGood(nPlanned, 0);
+        BatchBisection(setLoops, setSigs, fPlannedGood).Run();
+        for (size_t s = 0; s < nPlanned; s++) {
+            fGood[setIndex[s]] = fPlannedGood[s] && !fInfinity[s];
+        }
+    }
+    return vector<bool>(fGood.begin(), fGood.end());
+}
+
+vector<bool> CoreMPL::AggregateVerifyBatchEach(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<vector<uint8_t>>>& messages,
+    const vector<G2Element>& signatures)
+{
+    vector<vector<Bytes>> vecMessagesBytes;
+    vecMessagesBytes.reserve(messages.size());
+    for (const auto& set : messages) {
+        vecMessagesBytes.emplace_back(set.begin(), set.end());
+    }
+    return CoreMPL::AggregateVerifyBatchEach(
+        pubkeys, vecMessagesBytes, signatures);
+}
+
+vector<bool> CoreMPL::AggregateVerifyBatchEach(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<Bytes>>& messages,
+    const vector<G2Element>& signatures)
+{
+    return BatchVerifyEach(
+        strCiphersuiteId, pubkeys, messages, signatures, false);
+}
+
+bool AggregateVerifyBatchMPL(
+    std::string_view dst,
+    const PubKeySetsView& pubkeys,
+    const MessageSetsView& messages,
+    const SignaturesView& signatures,
+    bool fDistinctMessages)
+{
+    return BatchVerify(dst, pubkeys, messages, signatures, fDistinctMessages);
+}
+
+vector<bool> AggregateVerifyBatchEachMPL(
+    std::string_view dst,
+    const PubKeySetsView& pubkeys,
+    const MessageSetsView& messages,
+    const SignaturesView& signatures,
+    bool fDistinctMessages)
+{
+    return BatchVerifyEach(
+        dst, pubkeys, messages, signatures, fDistinctMessages);
+}
+
+PrivateKey CoreMPL::DeriveChildSk(const PrivateKey& sk, uint32_t index)
+{
+    return HDKeys::DeriveChildSk(sk, index);
+}
+
+PrivateKey CoreMPL::DeriveChildSkUnhardened(
+    const PrivateKey& sk,
+    uint32_t index)
+{
+    return HDKeys::DeriveChildSkUnhardened(sk, index);
+}
+
+G1Element CoreMPL::DeriveChildPkUnhardened(const G1Element& pk, uint32_t index)
+{
+    return HDKeys::DeriveChildG1Unhardened(pk, index);
+}
+
+bool BasicSchemeMPL::AggregateVerify(
+    const vector<vector<uint8_t>>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const vector<uint8_t>& signature)
+{
+    const size_t nPubKeys = pubkeys.size();
+    auto arg_check = VerifyAggregateSignatureArguments(
+        nPubKeys, messages.size(), G2Element::FromByteVector(signature));
+    if (arg_check != CONTINUE) {
+        return arg_check;
+    }
+
+    if (!MessagesAreDistinct(messages)) {
+        return false;
+    }
+    return CoreMPL::AggregateVerify(pubkeys, messages, signature);
+}
+
+bool BasicSchemeMPL::AggregateVerify(
+    const vector<Bytes>& pubkeys,
+    const vector<Bytes>& messages,
+    const Bytes& signature)
+{
+    const size_t nPubKeys = pubkeys.size();
+    const auto arg_check = VerifyAggregateSignatureArguments(
+        nPubKeys, messages.size(), G2Element::FromBytes(signature));
+    if (arg_check != CONTINUE)
+        return arg_check;
+
+    if (!MessagesAreDistinct(messages)) {
+        return false;
+    }
+    return CoreMPL::AggregateVerify(pubkeys, messages, signature);
+}
+
+bool BasicSchemeMPL::AggregateVerifyMerged(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature)
+{
+    return BasicSchemeMPL::AggregateVerifyMerged(
+        pubkeys,
+        std::vector<Bytes>(messages.begin(), messages.end()),
+        signature);
+}
+
+bool BasicSchemeMPL::AggregateVerifyMerged(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature)
+{
+    const size_t nPubKeys = pubkeys.size();
+    const auto arg_check =
+        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
+    if (arg_check != CONTINUE)
+        return arg_check;
+
+    if (!MessagesAreDistinct(messages)) {
+        return false;
+    }
+    return CoreMPL::AggregateVerifyMerged(pubkeys, messages, signature);
+}
+
+bool BasicSchemeMPL::AggregateVerifyBatch(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<vector<uint8_t>>>& messages,
+    const vector<G2Element>& signatures)
+{
+    vector<vector<Bytes>> vecMessagesBytes;
+    vecMessagesBytes.reserve(messages.size());
+    for (const auto& set : messages) {
+        vecMessagesBytes.emplace_back(set.begin(), set.end());
+    }
+    return BasicSchemeMPL::AggregateVerifyBatch(
+        pubkeys, vecMessagesBytes, signatures);
+}
+
+bool BasicSchemeMPL::AggregateVerifyBatch(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<Bytes>>& messages,
+    const vector<G2Element>& signatures)
+{
+    // Messages only have to be distinct within each aggregate
+    return BatchVerify(strCiphersuiteId, pubkeys, messages, signatures, true);
+}
+
+vector<bool> BasicSchemeMPL::AggregateVerifyBatchEach(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<vector<uint8_t>>>& messages,
+    const vector<G2Element>& signatures)
+{
+    vector<vector<Bytes>> vecMessagesBytes;
+    vecMessagesBytes.reserve(messages.size());
+    for (const auto& set : messages) {
+        vecMessagesBytes.emplace_back(set.begin(), set.end());
+    }
+    return BasicSchemeMPL::AggregateVerifyBatchEach(
+        pubkeys, vecMessagesBytes, signatures);
+}
+
+vector<bool> BasicSchemeMPL::AggregateVerifyBatchEach(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<Bytes>>& messages,
+    const vector<G2Element>& signatures)
+{
+    // Sets with repeated messages fail on their own
+    return BatchVerifyEach(
+        strCiphersuiteId, pubkeys, messages, signatures, true);
+}
+
+bool BasicSchemeMPL::AggregateVerifyCached(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature,
+    PairingCache& cache)
+{
+    return BasicSchemeMPL::AggregateVerifyCached(
+        pubkeys,
+        std::vector<Bytes>(messages.begin(), messages.end()),
+        signature,
+        cache);
+}
+
+bool BasicSchemeMPL::AggregateVerifyCached(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature,
+    PairingCache& cache)
+{
+    if (!MessagesAreDistinct(messages)) {
+        return false;
+    }
+    return CoreMPL::AggregateVerifyCached(pubkeys, messages, signature, cache);
+}
+
+PartialVerification BasicSchemeMPL::AggregateVerifyPartial(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages)
+{
+    return BasicSchemeMPL::AggregateVerifyPartial(
+        pubkeys, std::vector<Bytes>(messages.begin(), messages.end()));
+}
+
+PartialVerification BasicSchemeMPL::AggregateVerifyPartial(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages)
+{
+    // Fails early here; the partial's digests catch messages repeated in
+    // other slices when they merge
+    if (!MessagesAreDistinct(messages)) {
+        throw std::invalid_argument(
+            "AggregateVerifyPartial: messages must be distinct");
+    }
+    return CoreMPL::AggregateVerifyPartial(pubkeys, messages);
+}
+
+bool AugSchemeMPL::AggregateVerify(
+    const vector<vector<uint8_t>>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const vector<uint8_t>& signature)
+{
+    std::vector<Bytes> vecPubKeyBytes(pubkeys.begin(), pubkeys.end());
+    std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
+    return AugSchemeMPL::AggregateVerify(
+        vecPubKeyBytes, vecMessagesBytes, Bytes(signature));
+}
+
+bool AugSchemeMPL::AggregateVerify(
+    const vector<Bytes>& pubkeys,
+    const vector<Bytes>& messages,
+    const Bytes& signature)
+{
+    // blst hashes the public key bytes in front of each message
+    return AggregateVerifyPairs<blst_p1_affine, true>(
+        strCiphersuiteId, pubkeys, messages, G2Element::FromBytes(signature));
+}
+
+bool AugSchemeMPL::AggregateVerifyMerged(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature)
+{
+    std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
+    return AugSchemeMPL::AggregateVerifyMerged(
+        pubkeys, vecMessagesBytes, signature);
+}
+
+bool AugSchemeMPL::AggregateVerifyMerged(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature)
+{
+    size_t nPubKeys = pubkeys.size();
+    auto arg_check =
+        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
+    if (arg_check != CONTINUE) {
+        return arg_check;
+    }
+
+    vector<vector<uint8_t>> augMessages(nPubKeys);
+    for (size_t i = 0; i < nPubKeys; ++i) {
+        vector<uint8_t>& aug = augMessages[i];
+        vector<uint8_t>&& pubkey = pubkeys[i].Serialize();
+        aug.reserve(pubkey.size() + messages[i].size());
+        aug.insert(aug.end(), pubkey.begin(), pubkey.end());
+        aug.insert(aug.end(), messages[i].begin(), messages[i].end());
+    }
+
+    return CoreMPL::AggregateVerifyMerged(pubkeys, augMessages, signature);
+}
+
+bool AugSchemeMPL::AggregateVerifyCached(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages,
+    const G2Element& signature,
+    PairingCache& cache)
+{
+    std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
+    return AugSchemeMPL::AggregateVerifyCached(
+        pubkeys, vecMessagesBytes, signature, cache);
+}
+
+bool AugSchemeMPL::AggregateVerifyCached(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages,
+    const G2Element& signature,
+    PairingCache& cache)
+{
+    size_t nPubKeys = pubkeys.size();
+    auto arg_check =
+        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
+    if (arg_check != CONTINUE) {
+        return arg_check;
+    }
+
+    vector<vector<uint8_t>> augMessages(nPubKeys);
+    for (size_t i = 0; i < nPubKeys; ++i) {
+        vector<uint8_t>& aug = augMessages[i];
+        vector<uint8_t>&& pubkey = pubkeys[i].Serialize();
+        aug.reserve(pubkey.size() + messages[i].size());
+        aug.insert(aug.end(), pubkey.begin(), pubkey.end());
+        aug.insert(aug.end(), messages[i].begin(), messages[i].end());
+    }
+
+    return CoreMPL::AggregateVerifyCached(
+        pubkeys, augMessages, signature, cache);
+}
+
+PartialVerification AugSchemeMPL::AggregateVerifyPartial(
+    const vector<G1Element>& pubkeys,
+    const vector<vector<uint8_t>>& messages)
+{
+    return AugSchemeMPL::AggregateVerifyPartial(
+        pubkeys, std::vector<Bytes>(messages.begin(), messages.end()));
+}
+
+PartialVerification AugSchemeMPL::AggregateVerifyPartial(
+    const vector<G1Element>& pubkeys,
+    const vector<Bytes>& messages)
+{
+    const size_t nPubKeys = pubkeys.size();
+    if (messages.size() != nPubKeys) {
+        throw std::invalid_argument(
+            "AggregateVerifyPartial: pubkeys and messages sizes differ");
+    }
+
+    vector<vector<uint8_t>> augMessages(nPubKeys);
+    for (size_t i = 0; i < nPubKeys; ++i) {
+        vector<uint8_t>& aug = augMessages[i];
+        vector<uint8_t>&& pubkey = pubkeys[i].Serialize();
+        aug.reserve(pubkey.size() + messages[i].size());
+        aug.insert(aug.end(), pubkey.begin(), pubkey.end());
+        aug.insert(aug.end(), messages[i].begin(), messages[i].end());
+    }
+
+    return CoreMPL::AggregateVerifyPartial(pubkeys, augMessages);
+}
+
+vector<bool> AugSchemeMPL::VerifyManySameKey(
+    const G1Element& pubkey,
+    const vector<vector<uint8_t>>& messages,
+    const vector<G2Element>& signatures)
+{
+    std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
+    return AugSchemeMPL::VerifyManySameKey(
+        pubkey, vecMessagesBytes, signatures);
+}
+
+vector<bool> AugSchemeMPL::VerifyManySameKey(
+    const G1Element& pubkey,
+    const vector<Bytes>& messages,
+    const vector<G2Element>& signatures)
+{
+    const vector<uint8_t> pubkeyBytes = pubkey.Serialize();
+    vector<vector<uint8_t>> augMessages(messages.size());
+    for (size_t i = 0; i < messages.size(); ++i) {
+        vector<uint8_t>& aug = augMessages[i];
+        aug.reserve(pubkeyBytes.size() + messages[i].size());
+        aug.insert(aug.end(), pubkeyBytes.begin(), pubkeyBytes.end());
+        aug.insert(aug.end(), messages[i].begin(), messages[i].end());
+    }
 
-enum InvariantResult { BAD = false, GOOD = true, CONTINUE };
+    return CoreMPL::VerifyManySameKey(pubkey, augMessages, signatures);
+}
 
-// Enforce argument invariants for Agg Sig Verification
-InvariantResult VerifyAggregateSignatureArguments(
-    const size_t nPubKeys,
-    const size_t nMessages,
-    const G2Element& signature)
+bool AugSchemeMPL::AggregateVerifyBatch(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<vector<uint8_t>>>& messages,
+    const vector<G2Element>& signatures)
+{
+    vector<vector<Bytes>> vecMessagesBytes;
+    vecMessagesBytes.reserve(messages.size());
+    for (const auto& set : messages) {
+        vecMessagesBytes.emplace_back(set.begin(), set.end());
+    }
+    return AugSchemeMPL::AggregateVerifyBatch(
+        pubkeys, vecMessagesBytes, signatures);
+}
+
+bool AugSchemeMPL::AggregateVerifyBatch(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<Bytes>>& messages,
+    const vector<G2Element>& signatures)
+{
+    const size_t nSets = pubkeys.size();
+    if (messages.size() != nSets) {
+        return false;
+    }
+
+    vector<vector<vector<uint8_t>>> augMessages(nSets);
+    for (size_t j = 0; j < nSets; ++j) {
+        if (pubkeys[j].size() != messages[j].size()) {
+            return false;
+        }
+        augMessages[j].resize(pubkeys[j].size());
+        for (size_t i = 0; i < pubkeys[j].size(); ++i) {
+            vector<uint8_t>& aug = augMessages[j][i];
+            vector<uint8_t>&& pubkey = pubkeys[j][i].Serialize();
+            aug.reserve(pubkey.size() + messages[j][i].size());
+            aug.insert(aug.end(), pubkey.begin(), pubkey.end());
+            aug.insert(aug.end(), messages[j][i].begin(), messages[j][i].end());
+        }
+    }
+
+    return CoreMPL::AggregateVerifyBatch(pubkeys, augMessages, signatures);
+}
+
+vector<bool> AugSchemeMPL::AggregateVerifyBatchEach(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<vector<uint8_t>>>& messages,
+    const vector<G2Element>& signatures)
+{
+    vector<vector<Bytes>> vecMessagesBytes;
+    vecMessagesBytes.reserve(messages.size());
+    for (const auto& set : messages) {
+        vecMessagesBytes.emplace_back(set.begin(), set.end());
+    }
+    return AugSchemeMPL::AggregateVerifyBatchEach(
+        pubkeys, vecMessagesBytes, signatures);
+}
+
+vector<bool> AugSchemeMPL::AggregateVerifyBatchEach(
+    const vector<vector<G1Element>>& pubkeys,
+    const vector<vector<Bytes>>& messages,
+    const vector<G2Element>& signatures)
+{
+    const size_t nSets = pubkeys.size();
+    if (messages.size() != nSets) {
+        throw std::length_error(
+            "AggregateVerifyBatchEach: pubkeys, messages and signatures "
+            "sizes differ");
+    }
+
+    // A set whose sizes differ keeps its message count, and CoreMPL
+    // rejects it
+    vector<vector<vector<uint8_t>>> augMessages(nSets);
+    for (size_t j = 0; j < nSets; ++j) {
+        augMessages[j].resize(messages[j].size());
+        if (pubkeys[j].size() != messages[j].size()) {
+            continue;
+        }
+        for (size_t i = 0; i < pubkeys[j].size(); ++i) {
+            vector<uint8_t>& aug = augMessages[j][i];
+            vector<uint8_t>&& pubkey = pubkeys[j][i].Serialize();
+            aug.reserve(pubkey.size() + messages[j][i].size());
+            aug.insert(aug.end(), pubkey.begin(), pubkey.end());
+            aug.insert(aug.end(), messages[j][i].begin(), messages[j][i].end());
+        }
+    }
+
+    return CoreMPL::AggregateVerifyBatchEach(pubkeys, augMessages, signatures);
+}
+
+bool PopSchemeMPL::PopVerify(
+    const vector<uint8_t>& pubkey,
+    const vector<uint8_t>& proof)
+{
+    return PopSchemeMPL::PopVerify(Bytes(pubkey), Bytes(proof));
+}
+
+bool PopSchemeMPL::PopVerify(const Bytes& pubkey, const Bytes& proof)
+{
+    return PopSchemeMPL::PopVerify(
+        G1Element::FromBytes(pubkey), G2Element::FromBytes(proof));
+}
+
+bool PopSchemeMPL::FastAggregateVerify(
+    const vector<vector<uint8_t>>& pubkeys,
+    const vector<uint8_t>& message,
+    const vector<uint8_t>& signature)
+{
+    const std::vector<Bytes> vecPubKeyBytes(pubkeys.begin(), pubkeys.end());
+    return PopSchemeMPL::FastAggregateVerify(
+        vecPubKeyBytes, Bytes(message), Bytes(signature));
+}
+
+bool PopSchemeMPL::FastAggregateVerify(
+    const vector<Bytes>& pubkeys,
+    const Bytes& message,
+    const Bytes& signature)
 {
+    const size_t nPubKeys = pubkeys.size();
     if (nPubKeys == 0) {
-        return (nMessages == 0 && signature == G2Element() ? GOOD : BAD);
+        return false;
     }
-    if (nPubKeys != nMessages) {
-        return BAD;
+
+    vector<G1Element> pkelements;
+    for (size_t i = 0; i < nPubKeys; ++i) {
+        pkelements.push_back(G1Element::FromBytes(pubkeys[i]));
     }
-    return CONTINUE;
+
+    return PopSchemeMPL::FastAggregateVerify(
+        pkelements, message, G2Element::FromBytes(signature));
 }
 
-/* These are all for the min-pubkey-size variant.
-   TODO : analogs for min-signature-size
+/* These are all for the min-signature-size variant, public keys in G2 and
+   signatures in G1.
 */
-const std::string BasicSchemeMPL::CIPHERSUITE_ID =
-    "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_NUL_";
-const std::string AugSchemeMPL::CIPHERSUITE_ID =
-    "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_AUG_";
-const std::string PopSchemeMPL::CIPHERSUITE_ID =
-    "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_POP_";
-const std::string PopSchemeMPL::POP_CIPHERSUITE_ID =
-    "BLS_POP_BLS12381G2_XMD:SHA-256_SSWU_RO_POP_";
-
-PrivateKey CoreMPL::KeyGen(const vector<uint8_t>& seed)
+const std::string BasicSchemeMSL::CIPHERSUITE_ID =
+    "BLS_SIG_BLS12381G1_XMD:SHA-256_SSWU_RO_NUL_";
+const std::string AugSchemeMSL::CIPHERSUITE_ID =
+    "BLS_SIG_BLS12381G1_XMD:SHA-256_SSWU_RO_AUG_";
+const std::string PopSchemeMSL::CIPHERSUITE_ID =
+    "BLS_SIG_BLS12381G1_XMD:SHA-256_SSWU_RO_POP_";
+const std::string PopSchemeMSL::POP_CIPHERSUITE_ID =
+    "BLS_POP_BLS12381G1_XMD:SHA-256_SSWU_RO_POP_";
+
+PrivateKey CoreMSL::KeyGen(const vector<uint8_t>& seed)
 {
     return HDKeys::KeyGen(seed);
 }
 
-PrivateKey CoreMPL::KeyGen(const Bytes& seed) { return HDKeys::KeyGen(seed); }
+PrivateKey CoreMSL::KeyGen(const Bytes& seed) { return HDKeys::KeyGen(seed); }
 
-vector<uint8_t> CoreMPL::SkToPk(const PrivateKey& seckey)
+vector<uint8_t> CoreMSL::SkToPk(const PrivateKey& seckey)
 {
-    return seckey.GetG1Element().Serialize();
+    return seckey.GetG2Element().Serialize();
 }
 
-G1Element CoreMPL::SkToG1(const PrivateKey& seckey)
+G2Element CoreMSL::SkToG2(const PrivateKey& seckey)
 {
-    return seckey.GetG1Element();
+    return seckey.GetG2Element();
 }
 
-G2Element CoreMPL::Sign(
+G1Element CoreMSL::Sign(
     const PrivateKey& seckey,
     const vector<uint8_t>& message)
 {
-    return CoreMPL::Sign(seckey, Bytes(message));
+    return CoreMSL::Sign(seckey, Bytes(message));
 }
 
-G2Element CoreMPL::Sign(const PrivateKey& seckey, const Bytes& message)
+G1Element CoreMSL::Sign(const PrivateKey& seckey, const Bytes& message)
 {
-    return seckey.SignG2(
+    return seckey.SignG1(
         message.begin(),
         message.size(),
         (const uint8_t*)strCiphersuiteId.c_str(),
         strCiphersuiteId.length());
 }
 
-bool CoreMPL::Verify(
+bool CoreMSL::Verify(
     const vector<uint8_t>& pubkey,
     const vector<uint8_t>& message,  // unhashed
     const vector<uint8_t>& signature)
 {
-    return CoreMPL::Verify(
-        G1Element::FromBytes(Bytes(pubkey)),
-        Bytes(message),
-        G2Element::FromBytes(Bytes(signature)));
+    return CoreMSL::Verify(Bytes(pubkey), Bytes(message), Bytes(signature));
 }
 
-bool CoreMPL::Verify(
+bool CoreMSL::Verify(
     const Bytes& pubkey,
     const Bytes& message,
     const Bytes& signature)
 {
-    return CoreMPL::Verify(
-        G1Element::FromBytes(pubkey), message, G2Element::FromBytes(signature));
+    return CachedVerify<G2Element, G1Element>(
+        strCiphersuiteId, pubkey, message, signature);
 }
 
-bool CoreMPL::Verify(
-    const G1Element& pubkey,
+bool CoreMSL::Verify(
+    const G2Element& pubkey,
     const vector<uint8_t>& message,  // unhashed
-    const G2Element& signature)
+    const G1Element& signature)
 {
-    return CoreMPL::Verify(pubkey, Bytes(message), signature);
+    return CoreMSL::Verify(pubkey, Bytes(message), signature);
 }
 
-bool CoreMPL::Verify(
-    const G1Element& pubkey,
+bool CoreMSL::Verify(
+    const G2Element& pubkey,
     const Bytes& message,
-    const G2Element& signature)
+    const G1Element& signature)
 {
-    blst_p1_affine pubkeyAffine;
-    blst_p2_affine sigAffine;
-
-    pubkey.ToAffine(&pubkeyAffine);
-    signature.ToAffine(&sigAffine);
-
-    auto err = blst_core_verify_pk_in_g1(
-        &pubkeyAffine,
-        &sigAffine,
-        true, /*hash*/
-        message.begin(),
-        message.size(),
-        (const uint8_t*)strCiphersuiteId.c_str(),
-        strCiphersuiteId.length());
-
-    return err == BLST_SUCCESS;
+    return CachedVerify(strCiphersuiteId, pubkey, message, signature);
 }
 
-vector<uint8_t> CoreMPL::Aggregate(const vector<vector<uint8_t>>& signatures)
+vector<uint8_t> CoreMSL::Aggregate(const vector<vector<uint8_t>>& signatures)
 {
-    vector<G2Element> elements;
+    vector<G1Element> elements;
     for (const vector<uint8_t>& signature : signatures) {
-        elements.push_back(G2Element::FromByteVector(signature));
+        elements.push_back(G1Element::FromByteVector(signature));
     }
-    return CoreMPL::Aggregate(elements).Serialize();
+    return CoreMSL::Aggregate(elements).Serialize();
 }
 
-vector<uint8_t> CoreMPL::Aggregate(const vector<Bytes>& signatures)
+vector<uint8_t> CoreMSL::Aggregate(const vector<Bytes>& signatures)
 {
-    vector<G2Element> elements;
+    vector<G1Element> elements;
     for (const Bytes& signature : signatures) {
-        elements.push_back(G2Element::FromBytes(signature));
+        elements.push_back(G1Element::FromBytes(signature));
     }
-    return CoreMPL::Aggregate(elements).Serialize();
+    return CoreMSL::Aggregate(elements).Serialize();
 }
 
-G2Element CoreMPL::Aggregate(const vector<G2Element>& signatures)
+G1Element CoreMSL::Aggregate(const vector<G1Element>& signatures)
 {
-    G2Element aggregated;
-    for (const G2Element& signature : signatures) {
+    G1Element aggregated;
+    for (const G1Element& signature : signatures) {
         aggregated += signature;
     }
     return aggregated;
 }
 
-G1Element CoreMPL::Aggregate(const vector<G1Element>& publicKeys)
+G2Element CoreMSL::Aggregate(const vector<G2Element>& publicKeys)
 {
-    G1Element aggregated;
-    for (const G1Element& publicKey : publicKeys) {
+    G2Element aggregated;
+    for (const G2Element& publicKey : publicKeys) {
         aggregated += publicKey;
     }
     return aggregated;
 }
 
-bool CoreMPL::AggregateVerify(
+bool CoreMSL::AggregateVerify(
     const vector<vector<uint8_t>>& pubkeys,
     const vector<vector<uint8_t>>& messages,  // unhashed
     const vector<uint8_t>& signature)
 {
-    const std::vector<Bytes> vecPubKeyBytes(pubkeys.begin(), pubkeys.end());
-    const std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
-    return CoreMPL::AggregateVerify(
-        vecPubKeyBytes, vecMessagesBytes, Bytes(signature));
+    return AggregateVerifyPairs<blst_p2_affine>(
+        strCiphersuiteId,
+        pubkeys,
+        messages,
+        G1Element::FromByteVector(signature));
 }
 
-bool CoreMPL::AggregateVerify(
+bool CoreMSL::AggregateVerify(
     const vector<Bytes>& pubkeys,
     const vector<Bytes>& messages,  // unhashed
     const Bytes& signature)
 {
-    const size_t nPubKeys = pubkeys.size();
-    const G2Element signatureElement = G2Element::FromBytes(signature);
-    const auto arg_check = VerifyAggregateSignatureArguments(
-        nPubKeys, messages.size(), signatureElement);
-    if (arg_check != CONTINUE) {
-        return arg_check;
-    }
-
-    vector<G1Element> pubkeyElements;
-    for (size_t i = 0; i < nPubKeys; ++i) {
-        pubkeyElements.push_back(G1Element::FromBytes(pubkeys[i]));
-    }
-    return CoreMPL::AggregateVerify(pubkeyElements, messages, signatureElement);
+    return AggregateVerifyPairs<blst_p2_affine>(
+        strCiphersuiteId, pubkeys, messages, G1Element::FromBytes(signature));
 }
 
-bool CoreMPL::AggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool CoreMSL::AggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<vector<uint8_t>>& messages,
-    const G2Element& signature)
+    const G1Element& signature)
 {
-    return CoreMPL::AggregateVerify(
-        pubkeys,
-        std::vector<Bytes>(messages.begin(), messages.end()),
-        signature);
+    return AggregateVerifyPairs<blst_p2_affine>(
+        strCiphersuiteId, pubkeys, messages, signature);
 }
 
-bool CoreMPL::AggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool CoreMSL::AggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<Bytes>& messages,
-    const G2Element& signature)
+    const G1Element& signature)
 {
-    const size_t nPubKeys = pubkeys.size();
-    const auto arg_check =
-        VerifyAggregateSignatureArguments(nPubKeys, messages.size(), signature);
-    if (arg_check != CONTINUE) {
-        return arg_check;
-    }
-
-    blst_pairing* ctx = (blst_pairing*)malloc(blst_pairing_sizeof());
-    blst_pairing_init(
-        ctx,
-        true /*hash*/,
-        (const uint8_t*)strCiphersuiteId.c_str(),
-        strCiphersuiteId.length());
-
-    blst_p1_affine pk_affine;
-    blst_p2_affine sig_affine;
-    blst_fp12 gtsig;
-
-    signature.ToAffine(&sig_affine);
-
-    blst_aggregated_in_g2(&gtsig, &sig_affine);
-
-    for (size_t i = 0; i < nPubKeys; i++) {
-        pubkeys[i].ToAffine(&pk_affine);
-
-        auto err = blst_pairing_aggregate_pk_in_g1(
-            ctx, &pk_affine, nullptr, messages[i].begin(), messages[i].size());
-
-        if (err != BLST_SUCCESS) {
-            free(ctx);
-            return false;
-        }
-    }
-
-    blst_pairing_commit(ctx);
-    auto ret = blst_pairing_finalverify(ctx, &gtsig);
-    free(ctx);
-    return ret;
+    return AggregateVerifyPairs<blst_p2_affine>(
+        strCiphersuiteId, pubkeys, messages, signature);
 }
 
-PrivateKey CoreMPL::DeriveChildSk(const PrivateKey& sk, uint32_t index)
+PrivateKey CoreMSL::DeriveChildSk(const PrivateKey& sk, uint32_t index)
 {
     return HDKeys::DeriveChildSk(sk, index);
 }
 
-PrivateKey CoreMPL::DeriveChildSkUnhardened(
+PrivateKey CoreMSL::DeriveChildSkUnhardened(
     const PrivateKey& sk,
     uint32_t index)
 {
-    return HDKeys::DeriveChildSkUnhardened(sk, index);
+    return HDKeys::DeriveChildSkUnhardenedG2(sk, index);
 }
 
-G1Element CoreMPL::DeriveChildPkUnhardened(const G1Element& pk, uint32_t index)
+G2Element CoreMSL::DeriveChildPkUnhardened(const G2Element& pk, uint32_t index)
 {
-    return HDKeys::DeriveChildG1Unhardened(pk, index);
+    return HDKeys::DeriveChildG2Unhardened(pk, index);
 }
 
-bool BasicSchemeMPL::AggregateVerify(
+bool BasicSchemeMSL::AggregateVerify(
     const vector<vector<uint8_t>>& pubkeys,
     const vector<vector<uint8_t>>& messages,
     const vector<uint8_t>& signature)
 {
     const size_t nPubKeys = pubkeys.size();
     auto arg_check = VerifyAggregateSignatureArguments(
-        nPubKeys, messages.size(), G2Element::FromByteVector(signature));
+        nPubKeys, messages.size(), G1Element::FromByteVector(signature));
     if (arg_check != CONTINUE) {
         return arg_check;
     }
 
-    const std::set<vector<uint8_t>> setMessages(
-        messages.begin(), messages.end());
-    if (setMessages.size() != nPubKeys) {
+    if (!MessagesAreDistinct(messages)) {
         return false;
     }
-    return CoreMPL::AggregateVerify(pubkeys, messages, signature);
+    return CoreMSL::AggregateVerify(pubkeys, messages, signature);
 }
 
-bool BasicSchemeMPL::AggregateVerify(
+bool BasicSchemeMSL::AggregateVerify(
     const vector<Bytes>& pubkeys,
     const vector<Bytes>& messages,
     const Bytes& signature)
 {
     const size_t nPubKeys = pubkeys.size();
     const auto arg_check = VerifyAggregateSignatureArguments(
-        nPubKeys, messages.size(), G2Element::FromBytes(signature));
+        nPubKeys, messages.size(), G1Element::FromBytes(signature));
     if (arg_check != CONTINUE)
         return arg_check;
 
-    std::set<vector<uint8_t>> setMessages;
-    for (const auto& message : messages) {
-        setMessages.insert({message.begin(), message.end()});
-    }
-    if (setMessages.size() != nPubKeys) {
+    if (!MessagesAreDistinct(messages)) {
         return false;
     }
-    return CoreMPL::AggregateVerify(pubkeys, messages, signature);
+    return CoreMSL::AggregateVerify(pubkeys, messages, signature);
 }
 
-bool BasicSchemeMPL::AggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool BasicSchemeMSL::AggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<vector<uint8_t>>& messages,
-    const G2Element& signature)
+    const G1Element& signature)
 {
     const size_t nPubKeys = pubkeys.size();
     const auto arg_check =
@@ -334,18 +1932,16 @@ bool BasicSchemeMPL::AggregateVerify(
         return arg_check;
     }
 
-    const std::set<vector<uint8_t>> setMessages(
-        messages.begin(), messages.end());
-    if (setMessages.size() != nPubKeys) {
+    if (!MessagesAreDistinct(messages)) {
         return false;
     }
-    return CoreMPL::AggregateVerify(pubkeys, messages, signature);
+    return CoreMSL::AggregateVerify(pubkeys, messages, signature);
 }
 
-bool BasicSchemeMPL::AggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool BasicSchemeMSL::AggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<Bytes>& messages,
-    const G2Element& signature)
+    const G1Element& signature)
 {
     const size_t nPubKeys = pubkeys.size();
     const auto arg_check =
@@ -353,50 +1949,46 @@ bool BasicSchemeMPL::AggregateVerify(
     if (arg_check != CONTINUE)
         return arg_check;
 
-    std::set<vector<uint8_t>> setMessages;
-    for (const auto& message : messages) {
-        setMessages.insert({message.begin(), message.end()});
-    }
-    if (setMessages.size() != nPubKeys) {
+    if (!MessagesAreDistinct(messages)) {
         return false;
     }
-    return CoreMPL::AggregateVerify(pubkeys, messages, signature);
+    return CoreMSL::AggregateVerify(pubkeys, messages, signature);
 }
 
-G2Element AugSchemeMPL::Sign(
+G1Element AugSchemeMSL::Sign(
     const PrivateKey& seckey,
     const vector<uint8_t>& message)
 {
-    return AugSchemeMPL::Sign(seckey, message, seckey.GetG1Element());
+    return AugSchemeMSL::Sign(seckey, message, seckey.GetG2Element());
 }
 
-G2Element AugSchemeMPL::Sign(const PrivateKey& seckey, const Bytes& message)
+G1Element AugSchemeMSL::Sign(const PrivateKey& seckey, const Bytes& message)
 {
-    return AugSchemeMPL::Sign(seckey, message, seckey.GetG1Element());
+    return AugSchemeMSL::Sign(seckey, message, seckey.GetG2Element());
 }
 
 // Used for prepending different augMessage
-G2Element AugSchemeMPL::Sign(
+G1Element AugSchemeMSL::Sign(
     const PrivateKey& seckey,
     const vector<uint8_t>& message,
-    const G1Element& prepend_pk)
+    const G2Element& prepend_pk)
 {
-    return AugSchemeMPL::Sign(seckey, Bytes(message), prepend_pk);
+    return AugSchemeMSL::Sign(seckey, Bytes(message), prepend_pk);
 }
 
 // Used for prepending different augMessage
-G2Element AugSchemeMPL::Sign(
+G1Element AugSchemeMSL::Sign(
     const PrivateKey& seckey,
     const Bytes& message,
-    const G1Element& prepend_pk)
+    const G2Element& prepend_pk)
 {
     vector<uint8_t> augMessage = prepend_pk.Serialize();
     augMessage.reserve(augMessage.size() + message.size());
     augMessage.insert(augMessage.end(), message.begin(), message.end());
-    return CoreMPL::Sign(seckey, augMessage);
+    return CoreMSL::Sign(seckey, augMessage);
 }
 
-bool AugSchemeMPL::Verify(
+bool AugSchemeMSL::Verify(
     const vector<uint8_t>& pubkey,
     const vector<uint8_t>& message,
     const vector<uint8_t>& signature)
@@ -404,10 +1996,10 @@ bool AugSchemeMPL::Verify(
     vector<uint8_t> augMessage(pubkey);
     augMessage.reserve(augMessage.size() + message.size());
     augMessage.insert(augMessage.end(), message.begin(), message.end());
-    return CoreMPL::Verify(pubkey, augMessage, signature);
+    return CoreMSL::Verify(pubkey, augMessage, signature);
 }
 
-bool AugSchemeMPL::Verify(
+bool AugSchemeMSL::Verify(
     const Bytes& pubkey,
     const Bytes& message,
     const Bytes& signature)
@@ -415,77 +2007,62 @@ bool AugSchemeMPL::Verify(
     vector<uint8_t> augMessage(pubkey.begin(), pubkey.end());
     augMessage.reserve(augMessage.size() + message.size());
     augMessage.insert(augMessage.end(), message.begin(), message.end());
-    return CoreMPL::Verify(pubkey, Bytes(augMessage), Bytes(signature));
+    return CoreMSL::Verify(pubkey, Bytes(augMessage), Bytes(signature));
 }
 
-bool AugSchemeMPL::Verify(
-    const G1Element& pubkey,
+bool AugSchemeMSL::Verify(
+    const G2Element& pubkey,
     const vector<uint8_t>& message,
-    const G2Element& signature)
+    const G1Element& signature)
 {
-    return AugSchemeMPL::Verify(pubkey, Bytes(message), signature);
+    return AugSchemeMSL::Verify(pubkey, Bytes(message), signature);
 }
 
-bool AugSchemeMPL::Verify(
-    const G1Element& pubkey,
+bool AugSchemeMSL::Verify(
+    const G2Element& pubkey,
     const Bytes& message,
-    const G2Element& signature)
+    const G1Element& signature)
 {
     vector<uint8_t> augMessage = pubkey.Serialize();
     augMessage.reserve(augMessage.size() + message.size());
     augMessage.insert(augMessage.end(), message.begin(), message.end());
-    return CoreMPL::Verify(pubkey, augMessage, signature);
+    return CoreMSL::Verify(pubkey, augMessage, signature);
 }
 
-bool AugSchemeMPL::AggregateVerify(
+bool AugSchemeMSL::AggregateVerify(
     const vector<vector<uint8_t>>& pubkeys,
     const vector<vector<uint8_t>>& messages,
     const vector<uint8_t>& signature)
 {
     std::vector<Bytes> vecPubKeyBytes(pubkeys.begin(), pubkeys.end());
     std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
-    return AugSchemeMPL::AggregateVerify(
+    return AugSchemeMSL::AggregateVerify(
         vecPubKeyBytes, vecMessagesBytes, Bytes(signature));
 }
 
-bool AugSchemeMPL::AggregateVerify(
+bool AugSchemeMSL::AggregateVerify(
     const vector<Bytes>& pubkeys,
     const vector<Bytes>& messages,
     const Bytes& signature)
 {
-    size_t nPubKeys = pubkeys.size();
-    auto arg_check = VerifyAggregateSignatureArguments(
-        nPubKeys, messages.size(), G2Element::FromBytes(signature));
-    if (arg_check != CONTINUE) {
-        return arg_check;
-    }
-
-    vector<vector<uint8_t>> augMessages(nPubKeys);
-    for (size_t i = 0; i < nPubKeys; ++i) {
-        vector<uint8_t>& aug = augMessages[i];
-        aug.reserve(pubkeys[i].size() + messages[i].size());
-        aug.insert(aug.end(), pubkeys[i].begin(), pubkeys[i].end());
-        aug.insert(aug.end(), messages[i].begin(), messages[i].end());
-    }
-
-    std::vector<Bytes> vecAugMessageBytes(
-        augMessages.begin(), augMessages.end());
-    return CoreMPL::AggregateVerify(pubkeys, vecAugMessageBytes, signature);
+    // blst hashes the public key bytes in front of each message
+    return AggregateVerifyPairs<blst_p2_affine, true>(
+        strCiphersuiteId, pubkeys, messages, G1Element::FromBytes(signature));
 }
 
-bool AugSchemeMPL::AggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool AugSchemeMSL::AggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<vector<uint8_t>>& messages,
-    const G2Element& signature)
+    const G1Element& signature)
 {
     std::vector<Bytes> vecMessagesBytes(messages.begin(), messages.end());
-    return AugSchemeMPL::AggregateVerify(pubkeys, vecMessagesBytes, signature);
+    return AugSchemeMSL::AggregateVerify(pubkeys, vecMessagesBytes, signature);
 }
 
-bool AugSchemeMPL::AggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool AugSchemeMSL::AggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<Bytes>& messages,
-    const G2Element& signature)
+    const G1Element& signature)
 {
     size_t nPubKeys = pubkeys.size();
     auto arg_check =
@@ -503,32 +2080,32 @@ bool AugSchemeMPL::AggregateVerify(
         aug.insert(aug.end(), messages[i].begin(), messages[i].end());
     }
 
-    return CoreMPL::AggregateVerify(pubkeys, augMessages, signature);
+    return CoreMSL::AggregateVerify(pubkeys, augMessages, signature);
 }
 
-G2Element PopSchemeMPL::PopProve(const PrivateKey& seckey)
+G1Element PopSchemeMSL::PopProve(const PrivateKey& seckey)
 {
-    std::vector<uint8_t> pubkey_bytes = seckey.GetG1Element().Serialize();
+    std::vector<uint8_t> pubkey_bytes = seckey.GetG2Element().Serialize();
 
-    return seckey.SignG2(
+    return seckey.SignG1(
         pubkey_bytes.data(),
         pubkey_bytes.size(),
         (const uint8_t*)POP_CIPHERSUITE_ID.c_str(),
         POP_CIPHERSUITE_ID.length());
 }
 
-bool PopSchemeMPL::PopVerify(
-    const G1Element& pubkey,
-    const G2Element& signature_proof)
+bool PopSchemeMSL::PopVerify(
+    const G2Element& pubkey,
+    const G1Element& signature_proof)
 {
-    blst_p1_affine pubkeyAffine;
-    blst_p2_affine sigAffine;
+    blst_p2_affine pubkeyAffine;
+    blst_p1_affine sigAffine;
 
     pubkey.ToAffine(&pubkeyAffine);
     signature_proof.ToAffine(&sigAffine);
     std::vector<uint8_t> pubkey_bytes = pubkey.Serialize();
 
-    auto err = blst_core_verify_pk_in_g1(
+    auto err = blst_core_verify_pk_in_g2(
         &pubkeyAffine,
         &sigAffine,
         true, /*hash*/
@@ -540,52 +2117,52 @@ bool PopSchemeMPL::PopVerify(
     return err == BLST_SUCCESS;
 }
 
-bool PopSchemeMPL::PopVerify(
+bool PopSchemeMSL::PopVerify(
     const vector<uint8_t>& pubkey,
     const vector<uint8_t>& proof)
 {
-    return PopSchemeMPL::PopVerify(Bytes(pubkey), Bytes(proof));
+    return PopSchemeMSL::PopVerify(Bytes(pubkey), Bytes(proof));
 }
 
-bool PopSchemeMPL::PopVerify(const Bytes& pubkey, const Bytes& proof)
+bool PopSchemeMSL::PopVerify(const Bytes& pubkey, const Bytes& proof)
 {
-    return PopSchemeMPL::PopVerify(
-        G1Element::FromBytes(pubkey), G2Element::FromBytes(proof));
+    return PopSchemeMSL::PopVerify(
+        G2Element::FromBytes(pubkey), G1Element::FromBytes(proof));
 }
 
-bool PopSchemeMPL::FastAggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool PopSchemeMSL::FastAggregateVerify(
+    const vector<G2Element>& pubkeys,
     const vector<uint8_t>& message,
-    const G2Element& signature)
+    const G1Element& signature)
 {
-    return PopSchemeMPL::FastAggregateVerify(
+    return PopSchemeMSL::FastAggregateVerify(
         pubkeys, Bytes(message), signature);
 }
 
-bool PopSchemeMPL::FastAggregateVerify(
-    const vector<G1Element>& pubkeys,
+bool PopSchemeMSL::FastAggregateVerify(
+    const vector<G2Element>& pubkeys,
     const Bytes& message,
-    const G2Element& signature)
+    const G1Element& signature)
 {
     if (pubkeys.size() == 0) {
         return false;
     }
     // No VerifyAggregateSignatureArguments checks required here as we have
     // exactly one pubkey and one message.
-    return CoreMPL::Verify(CoreMPL::Aggregate(pubkeys), message, signature);
+    return CoreMSL::Verify(CoreMSL::Aggregate(pubkeys), message, signature);
 }
 
-bool PopSchemeMPL::FastAggregateVerify(
+bool PopSchemeMSL::FastAggregateVerify(
     const vector<vector<uint8_t>>& pubkeys,
     const vector<uint8_t>& message,
     const vector<uint8_t>& signature)
 {
     const std::vector<Bytes> vecPubKeyBytes(pubkeys.begin(), pubkeys.end());
-    return PopSchemeMPL::FastAggregateVerify(
+    return PopSchemeMSL::FastAggregateVerify(
         vecPubKeyBytes, Bytes(message), Bytes(signature));
 }
 
-bool PopSchemeMPL::FastAggregateVerify(
+bool PopSchemeMSL::FastAggregateVerify(
     const vector<Bytes>& pubkeys,
     const Bytes& message,
     const Bytes& signature)
@@ -595,12 +2172,12 @@ bool PopSchemeMPL::FastAggregateVerify(
         return false;
     }
 
-    vector<G1Element> pkelements;
+    vector<G2Element> pkelements;
     for (size_t i = 0; i < nPubKeys; ++i) {
-        pkelements.push_back(G1Element::FromBytes(pubkeys[i]));
+        pkelements.push_back(G2Element::FromBytes(pubkeys[i]));
     }
 
-    return PopSchemeMPL::FastAggregateVerify(
-        pkelements, message, G2Element::FromBytes(signature));
+    return PopSchemeMSL::FastAggregateVerify(
+        pkelements, message, G1Element::FromBytes(signature));
 }
 }  // end namespace bls
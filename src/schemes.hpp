@@ -18,8 +18,11 @@
 #include <iostream>
 #include <vector>
 
+#include "cache.hpp"
 #include "elements.hpp"
+#include "partial.hpp"
 #include "privatekey.hpp"
+#include "staticschemes.hpp"
 
 using std::vector;
 
@@ -96,6 +99,88 @@ public:
         const vector<Bytes>& messages,
         const G2Element& signature);
 
+    // Verifies several independent aggregate signatures, set j being
+    // (pubkeys[j], messages[j], signatures[j]), with a single final
+    // exponentiation. Each set's pairings and signature are scaled by a
+    // random 64 bit coefficient. True only if every set verifies.
+    virtual bool AggregateVerifyBatch(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<vector<uint8_t>>>& messages,
+        const vector<G2Element>& signatures);
+
+    virtual bool AggregateVerifyBatch(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<Bytes>>& messages,
+        const vector<G2Element>& signatures);
+
+    // AggregateVerifyBatch with a result per set. When the batch fails, the
+    // bad sets are found by bisecting it, reusing the Miller loops already
+    // computed, so k bad sets out of n cost O(k log n) sub-checks rather
+    // than n verifications. Throws std::length_error if the sizes differ.
+    virtual vector<bool> AggregateVerifyBatchEach(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<vector<uint8_t>>>& messages,
+        const vector<G2Element>& signatures);
+
+    virtual vector<bool> AggregateVerifyBatchEach(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<Bytes>>& messages,
+        const vector<G2Element>& signatures);
+
+    // AggregateVerify that takes the Miller loop of each (pubkey, message)
+    // pair from cache when present, and only hashes and pairs the missing
+    // ones, which are then added to it.
+    virtual bool AggregateVerifyCached(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature,
+        PairingCache& cache);
+
+    virtual bool AggregateVerifyCached(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature,
+        PairingCache& cache);
+
+    // The part of an AggregateVerify contributed by a slice of its pairs,
+    // for merging with the other slices' and a final check elsewhere. The
+    // signature share starts empty. Throws std::invalid_argument for
+    // mismatched sizes or an infinity public key.
+    virtual PartialVerification AggregateVerifyPartial(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages);
+
+    virtual PartialVerification AggregateVerifyPartial(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages);
+
+    // Verifies many individual signatures by the same public key at the cost
+    // of two pairings, checking e(pk, sum r_i * H(m_i)) against
+    // e(g1, sum r_i * sig_i) for random 64 bit r_i. If the batch fails each
+    // signature is verified on its own. Returns one result per signature.
+    virtual vector<bool> VerifyManySameKey(
+        const G1Element& pubkey,
+        const vector<vector<uint8_t>>& messages,
+        const vector<G2Element>& signatures);
+
+    virtual vector<bool> VerifyManySameKey(
+        const G1Element& pubkey,
+        const vector<Bytes>& messages,
+        const vector<G2Element>& signatures);
+
+    // Same result as AggregateVerify, but first merges pairs which share a
+    // public key, e(pk, H(m1)) * e(pk, H(m2)) = e(pk, H(m1) + H(m2)), or
+    // which share a message, whichever leaves fewer Miller loops.
+    virtual bool AggregateVerifyMerged(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature);
+
+    virtual bool AggregateVerifyMerged(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature);
+
     PrivateKey DeriveChildSk(const PrivateKey& sk, uint32_t index);
     PrivateKey DeriveChildSkUnhardened(const PrivateKey& sk, uint32_t index);
     G1Element DeriveChildPkUnhardened(const G1Element& sk, uint32_t index);
@@ -110,6 +195,51 @@ class BasicSchemeMPL final : public CoreMPL {
 public:
     static const std::string CIPHERSUITE_ID;
     BasicSchemeMPL() : CoreMPL(BasicSchemeMPL::CIPHERSUITE_ID) {}
+
+    G2Element Sign(const PrivateKey& seckey, const vector<uint8_t>& message)
+        override
+    {
+        return StaticBasicSchemeMPL::Sign(seckey, message);
+    }
+
+    G2Element Sign(const PrivateKey& seckey, const Bytes& message) override
+    {
+        return StaticBasicSchemeMPL::Sign(seckey, message);
+    }
+
+    bool Verify(
+        const vector<uint8_t>& pubkey,
+        const vector<uint8_t>& message,
+        const vector<uint8_t>& signature) override
+    {
+        return StaticBasicSchemeMPL::Verify(
+            Bytes(pubkey), Bytes(message), Bytes(signature));
+    }
+
+    bool Verify(
+        const Bytes& pubkey,
+        const Bytes& message,
+        const Bytes& signature) override
+    {
+        return StaticBasicSchemeMPL::Verify(pubkey, message, signature);
+    }
+
+    bool Verify(
+        const G1Element& pubkey,
+        const vector<uint8_t>& message,
+        const G2Element& signature) override
+    {
+        return StaticBasicSchemeMPL::Verify(pubkey, message, signature);
+    }
+
+    bool Verify(
+        const G1Element& pubkey,
+        const Bytes& message,
+        const G2Element& signature) override
+    {
+        return StaticBasicSchemeMPL::Verify(pubkey, message, signature);
+    }
+
     bool AggregateVerify(
         const vector<vector<uint8_t>>& pubkeys,
         const vector<vector<uint8_t>>& messages,
@@ -123,12 +253,69 @@ public:
     bool AggregateVerify(
         const vector<G1Element>& pubkeys,
         const vector<vector<uint8_t>>& messages,
-        const G2Element& signature) override;
+        const G2Element& signature) override
+    {
+        return StaticBasicSchemeMPL::AggregateVerify(
+            pubkeys, messages, signature);
+    }
 
     bool AggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature) override
+    {
+        return StaticBasicSchemeMPL::AggregateVerify(
+            pubkeys, messages, signature);
+    }
+    bool AggregateVerifyMerged(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature) override;
+
+    bool AggregateVerifyMerged(
         const vector<G1Element>& pubkeys,
         const vector<Bytes>& messages,
         const G2Element& signature) override;
+
+    bool AggregateVerifyBatch(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<vector<uint8_t>>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    bool AggregateVerifyBatch(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<Bytes>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    vector<bool> AggregateVerifyBatchEach(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<vector<uint8_t>>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    vector<bool> AggregateVerifyBatchEach(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<Bytes>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    bool AggregateVerifyCached(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature,
+        PairingCache& cache) override;
+
+    bool AggregateVerifyCached(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature,
+        PairingCache& cache) override;
+
+    PartialVerification AggregateVerifyPartial(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages) override;
+
+    PartialVerification AggregateVerifyPartial(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages) override;
 };
 
 class AugSchemeMPL final : public CoreMPL {
@@ -137,42 +324,351 @@ public:
     AugSchemeMPL() : CoreMPL(AugSchemeMPL::CIPHERSUITE_ID) {}
 
     G2Element Sign(const PrivateKey& seckey, const vector<uint8_t>& message)
-        override;
+        override
+    {
+        return StaticAugSchemeMPL::Sign(seckey, message);
+    }
+
+    G2Element Sign(const PrivateKey& seckey, const Bytes& message) override
+    {
+        return StaticAugSchemeMPL::Sign(seckey, message);
+    }
 
-    G2Element Sign(const PrivateKey& seckey, const Bytes& message) override;
+    bool Verify(
+        const vector<uint8_t>& pubkey,
+        const vector<uint8_t>& message,
+        const vector<uint8_t>& signature) override
+    {
+        return StaticAugSchemeMPL::Verify(
+            Bytes(pubkey), Bytes(message), Bytes(signature));
+    }
+
+    bool Verify(
+        const Bytes& pubkey,
+        const Bytes& message,
+        const Bytes& signature) override
+    {
+        return StaticAugSchemeMPL::Verify(pubkey, message, signature);
+    }
+
+    bool Verify(
+        const G1Element& pubkey,
+        const vector<uint8_t>& message,
+        const G2Element& signature) override
+    {
+        return StaticAugSchemeMPL::Verify(pubkey, message, signature);
+    }
+
+    bool Verify(
+        const G1Element& pubkey,
+        const Bytes& message,
+        const G2Element& signature) override
+    {
+        return StaticAugSchemeMPL::Verify(pubkey, message, signature);
+    }
 
     // Used for prepending different augMessage
     G2Element Sign(
         const PrivateKey& seckey,
         const vector<uint8_t>& message,
-        const G1Element& prepend_pk);
+        const G1Element& prepend_pk)
+    {
+        return StaticAugSchemeMPL::Sign(seckey, message, prepend_pk);
+    }
 
     // Used for prepending different augMessage
     G2Element Sign(
         const PrivateKey& seckey,
         const Bytes& message,
-        const G1Element& prepend_pk);
+        const G1Element& prepend_pk)
+    {
+        return StaticAugSchemeMPL::Sign(seckey, message, prepend_pk);
+    }
+
+    bool AggregateVerify(
+        const vector<vector<uint8_t>>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const vector<uint8_t>& signature) override;
+
+    bool AggregateVerify(
+        const vector<Bytes>& pubkeys,
+        const vector<Bytes>& messages,
+        const Bytes& signature) override;
+
+    bool AggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature) override
+    {
+        return StaticAugSchemeMPL::AggregateVerify(
+            pubkeys, messages, signature);
+    }
+
+    bool AggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature) override
+    {
+        return StaticAugSchemeMPL::AggregateVerify(
+            pubkeys, messages, signature);
+    }
+    bool AggregateVerifyMerged(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature) override;
+
+    bool AggregateVerifyMerged(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature) override;
+
+    vector<bool> VerifyManySameKey(
+        const G1Element& pubkey,
+        const vector<vector<uint8_t>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    vector<bool> VerifyManySameKey(
+        const G1Element& pubkey,
+        const vector<Bytes>& messages,
+        const vector<G2Element>& signatures) override;
+
+    bool AggregateVerifyBatch(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<vector<uint8_t>>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    bool AggregateVerifyBatch(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<Bytes>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    vector<bool> AggregateVerifyBatchEach(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<vector<uint8_t>>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    vector<bool> AggregateVerifyBatchEach(
+        const vector<vector<G1Element>>& pubkeys,
+        const vector<vector<Bytes>>& messages,
+        const vector<G2Element>& signatures) override;
+
+    bool AggregateVerifyCached(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature,
+        PairingCache& cache) override;
+
+    bool AggregateVerifyCached(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature,
+        PairingCache& cache) override;
+
+    PartialVerification AggregateVerifyPartial(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages) override;
+
+    PartialVerification AggregateVerifyPartial(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages) override;
+};
+
+class PopSchemeMPL final : public CoreMPL {
+public:
+    static const std::string CIPHERSUITE_ID;
+    static const std::string POP_CIPHERSUITE_ID;
+    PopSchemeMPL() : CoreMPL(PopSchemeMPL::CIPHERSUITE_ID) {}
+
+    G2Element Sign(const PrivateKey& seckey, const vector<uint8_t>& message)
+        override
+    {
+        return StaticPopSchemeMPL::Sign(seckey, message);
+    }
+
+    G2Element Sign(const PrivateKey& seckey, const Bytes& message) override
+    {
+        return StaticPopSchemeMPL::Sign(seckey, message);
+    }
 
     bool Verify(
         const vector<uint8_t>& pubkey,
         const vector<uint8_t>& message,
-        const vector<uint8_t>& signature) override;
+        const vector<uint8_t>& signature) override
+    {
+        return StaticPopSchemeMPL::Verify(
+            Bytes(pubkey), Bytes(message), Bytes(signature));
+    }
 
     bool Verify(
         const Bytes& pubkey,
         const Bytes& message,
-        const Bytes& signature) override;
+        const Bytes& signature) override
+    {
+        return StaticPopSchemeMPL::Verify(pubkey, message, signature);
+    }
 
     bool Verify(
         const G1Element& pubkey,
         const vector<uint8_t>& message,
-        const G2Element& signature) override;
+        const G2Element& signature) override
+    {
+        return StaticPopSchemeMPL::Verify(pubkey, message, signature);
+    }
 
     bool Verify(
         const G1Element& pubkey,
         const Bytes& message,
-        const G2Element& signature) override;
+        const G2Element& signature) override
+    {
+        return StaticPopSchemeMPL::Verify(pubkey, message, signature);
+    }
+
+    // The serialized forms stay in CoreMPL
+    using CoreMPL::AggregateVerify;
+
+    bool AggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G2Element& signature) override
+    {
+        return StaticPopSchemeMPL::AggregateVerify(
+            pubkeys, messages, signature);
+    }
 
+    bool AggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G2Element& signature) override
+    {
+        return StaticPopSchemeMPL::AggregateVerify(
+            pubkeys, messages, signature);
+    }
+
+    G2Element PopProve(const PrivateKey& seckey)
+    {
+        return StaticPopSchemeMPL::PopProve(seckey);
+    }
+
+    bool PopVerify(const G1Element& pubkey, const G2Element& signature_proof)
+    {
+        return StaticPopSchemeMPL::PopVerify(pubkey, signature_proof);
+    }
+
+    bool PopVerify(const vector<uint8_t>& pubkey, const vector<uint8_t>& proof);
+
+    bool PopVerify(const Bytes& pubkey, const Bytes& proof);
+
+    bool FastAggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const vector<uint8_t>& message,
+        const G2Element& signature)
+    {
+        return StaticPopSchemeMPL::FastAggregateVerify(
+            pubkeys, message, signature);
+    }
+
+    bool FastAggregateVerify(
+        const vector<G1Element>& pubkeys,
+        const Bytes& message,
+        const G2Element& signature)
+    {
+        return StaticPopSchemeMPL::FastAggregateVerify(
+            pubkeys, message, signature);
+    }
+
+    bool FastAggregateVerify(
+        const vector<vector<uint8_t>>& pubkeys,
+        const vector<uint8_t>& message,
+        const vector<uint8_t>& signature);
+
+    bool FastAggregateVerify(
+        const vector<Bytes>& pubkeys,
+        const Bytes& message,
+        const Bytes& signature);
+};
+
+// Minimal signature size (MSL) variants: public keys are G2Elements
+// (96 bytes) and signatures are G1Elements (48 bytes).
+class CoreMSL {
+public:
+    CoreMSL() = delete;
+    CoreMSL(const std::string& strId) : strCiphersuiteId(strId) {}
+    virtual ~CoreMSL() {}
+    // Generates a private key from a seed, similar to HD key generation
+    // (hashes the seed), and reduces it mod the group order
+    virtual PrivateKey KeyGen(const vector<uint8_t>& seed);
+    virtual PrivateKey KeyGen(const Bytes& seed);
+
+    // Generates a public key from a secret key
+    virtual vector<uint8_t> SkToPk(const PrivateKey& seckey);
+
+    virtual G2Element SkToG2(const PrivateKey& seckey);
+
+    virtual G1Element Sign(
+        const PrivateKey& seckey,
+        const vector<uint8_t>& message);
+    virtual G1Element Sign(const PrivateKey& seckey, const Bytes& message);
+
+    virtual bool Verify(
+        const vector<uint8_t>& pubkey,
+        const vector<uint8_t>& message,
+        const vector<uint8_t>& signature);
+
+    virtual bool Verify(
+        const Bytes& pubkey,
+        const Bytes& message,
+        const Bytes& signature);
+
+    virtual bool Verify(
+        const G2Element& pubkey,
+        const vector<uint8_t>& message,
+        const G1Element& signature);
+
+    virtual bool Verify(
+        const G2Element& pubkey,
+        const Bytes& message,
+        const G1Element& signature);
+
+    virtual vector<uint8_t> Aggregate(
+        const vector<vector<uint8_t>>& signatures);
+    virtual vector<uint8_t> Aggregate(const vector<Bytes>& signatures);
+
+    virtual G1Element Aggregate(const vector<G1Element>& signatures);
+
+    virtual G2Element Aggregate(const vector<G2Element>& publicKeys);
+
+    virtual bool AggregateVerify(
+        const vector<vector<uint8_t>>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const vector<uint8_t>& signature);
+
+    virtual bool AggregateVerify(
+        const vector<Bytes>& pubkeys,
+        const vector<Bytes>& messages,
+        const Bytes& signature);
+
+    virtual bool AggregateVerify(
+        const vector<G2Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G1Element& signature);
+
+    virtual bool AggregateVerify(
+        const vector<G2Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G1Element& signature);
+
+    PrivateKey DeriveChildSk(const PrivateKey& sk, uint32_t index);
+    PrivateKey DeriveChildSkUnhardened(const PrivateKey& sk, uint32_t index);
+    G2Element DeriveChildPkUnhardened(const G2Element& pk, uint32_t index);
+
+protected:
+    const std::string& strCiphersuiteId;
+};
+
+class BasicSchemeMSL final : public CoreMSL {
+public:
+    static const std::string CIPHERSUITE_ID;
+    BasicSchemeMSL() : CoreMSL(BasicSchemeMSL::CIPHERSUITE_ID) {}
     bool AggregateVerify(
         const vector<vector<uint8_t>>& pubkeys,
         const vector<vector<uint8_t>>& messages,
@@ -184,39 +680,102 @@ public:
         const Bytes& signature) override;
 
     bool AggregateVerify(
-        const vector<G1Element>& pubkeys,
+        const vector<G2Element>& pubkeys,
         const vector<vector<uint8_t>>& messages,
-        const G2Element& signature) override;
+        const G1Element& signature) override;
 
     bool AggregateVerify(
-        const vector<G1Element>& pubkeys,
+        const vector<G2Element>& pubkeys,
         const vector<Bytes>& messages,
-        const G2Element& signature) override;
+        const G1Element& signature) override;
 };
 
-class PopSchemeMPL final : public CoreMPL {
+class AugSchemeMSL final : public CoreMSL {
+public:
+    static const std::string CIPHERSUITE_ID;
+    AugSchemeMSL() : CoreMSL(AugSchemeMSL::CIPHERSUITE_ID) {}
+
+    G1Element Sign(const PrivateKey& seckey, const vector<uint8_t>& message)
+        override;
+
+    G1Element Sign(const PrivateKey& seckey, const Bytes& message) override;
+
+    // Used for prepending different augMessage
+    G1Element Sign(
+        const PrivateKey& seckey,
+        const vector<uint8_t>& message,
+        const G2Element& prepend_pk);
+
+    // Used for prepending different augMessage
+    G1Element Sign(
+        const PrivateKey& seckey,
+        const Bytes& message,
+        const G2Element& prepend_pk);
+
+    bool Verify(
+        const vector<uint8_t>& pubkey,
+        const vector<uint8_t>& message,
+        const vector<uint8_t>& signature) override;
+
+    bool Verify(
+        const Bytes& pubkey,
+        const Bytes& message,
+        const Bytes& signature) override;
+
+    bool Verify(
+        const G2Element& pubkey,
+        const vector<uint8_t>& message,
+        const G1Element& signature) override;
+
+    bool Verify(
+        const G2Element& pubkey,
+        const Bytes& message,
+        const G1Element& signature) override;
+
+    bool AggregateVerify(
+        const vector<vector<uint8_t>>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const vector<uint8_t>& signature) override;
+
+    bool AggregateVerify(
+        const vector<Bytes>& pubkeys,
+        const vector<Bytes>& messages,
+        const Bytes& signature) override;
+
+    bool AggregateVerify(
+        const vector<G2Element>& pubkeys,
+        const vector<vector<uint8_t>>& messages,
+        const G1Element& signature) override;
+
+    bool AggregateVerify(
+        const vector<G2Element>& pubkeys,
+        const vector<Bytes>& messages,
+        const G1Element& signature) override;
+};
+
+class PopSchemeMSL final : public CoreMSL {
 public:
     static const std::string CIPHERSUITE_ID;
     static const std::string POP_CIPHERSUITE_ID;
-    PopSchemeMPL() : CoreMPL(PopSchemeMPL::CIPHERSUITE_ID) {}
+    PopSchemeMSL() : CoreMSL(PopSchemeMSL::CIPHERSUITE_ID) {}
 
-    G2Element PopProve(const PrivateKey& seckey);
+    G1Element PopProve(const PrivateKey& seckey);
 
-    bool PopVerify(const G1Element& pubkey, const G2Element& signature_proof);
+    bool PopVerify(const G2Element& pubkey, const G1Element& signature_proof);
 
     bool PopVerify(const vector<uint8_t>& pubkey, const vector<uint8_t>& proof);
 
     bool PopVerify(const Bytes& pubkey, const Bytes& proof);
 
     bool FastAggregateVerify(
-        const vector<G1Element>& pubkeys,
+        const vector<G2Element>& pubkeys,
         const vector<uint8_t>& message,
-        const G2Element& signature);
+        const G1Element& signature);
 
     bool FastAggregateVerify(
-        const vector<G1Element>& pubkeys,
+        const vector<G2Element>& pubkeys,
         const Bytes& message,
-        const G2Element& signature);
+        const G1Element& signature);
 
     bool FastAggregateVerify(
         const vector<vector<uint8_t>>& pubkeys,
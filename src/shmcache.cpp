@@ -0,0 +1,305 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "shmcache.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define BLS_HAVE_SHM 1
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace bls {
+
+static_assert(
+    std::atomic<uint64_t>::is_always_lock_free &&
+        std::atomic<uint32_t>::is_always_lock_free,
+    "shared memory atomics must be lock free");
+
+static const uint32_t SHM_CACHE_MAGIC = 0x424c5343;  // "BLSC"
+static const uint32_t SHM_STATE_READY = 1;
+
+// How long an opener waits for the creator to initialize the segment
+static const std::chrono::milliseconds SHM_INIT_TIMEOUT(2000);
+
+struct SharedSignatureCache::Header {
+    std::atomic<uint32_t> state;  // SHM_STATE_READY once initialized
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotSize;
+    uint64_t nSlots;
+    uint8_t salt[CACHE_SALT_SIZE];
+};
+
+// An even seq means the slot is stable, odd that a writer holds it. An
+// all zero key is an empty slot.
+struct SharedSignatureCache::Slot {
+    std::atomic<uint64_t> seq;
+    std::atomic<uint64_t> key[4];
+};
+
+// Slots start on a cache line
+static const size_t SHM_HEADER_SIZE = 64;
+
+static void KeyWords(uint64_t *words, const CacheKey &key)
+{
+    memcpy(words, key.data(), 4 * sizeof(uint64_t));
+}
+
+#if BLS_HAVE_SHM
+static std::string SegmentName(const std::string &name)
+{
+    if (name.empty() || name.find('/', 1) != std::string::npos) {
+        throw std::invalid_argument("Invalid shared memory cache name");
+    }
+    return name[0] == '/' ? name : "/" + name;
+}
+
+static size_t RoundSlots(size_t nSlots)
+{
+    if (nSlots == 0) {
+        throw std::invalid_argument("Shared cache needs at least one slot");
+    }
+    size_t n = SharedSignatureCache::PROBE_LENGTH;
+    while (n < nSlots) {
+        n <<= 1;
+    }
+    return n;
+}
+#endif
+
+SharedSignatureCache::SharedSignatureCache(
+    const std::string &name,
+    size_t nSlots)
+{
+#if BLS_HAVE_SHM
+    static_assert(sizeof(Header) <= SHM_HEADER_SIZE, "header too large");
+    const std::string segment = SegmentName(name);
+    const size_t nRequested = RoundSlots(nSlots);
+
+    bool fCreated = true;
+    int fd = shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        fCreated = false;
+        fd = shm_open(segment.c_str(), O_RDWR, 0600);
+    }
+    if (fd < 0) {
+        throw std::runtime_error(
+            "Can't open shared memory cache " + segment + ": " +
+            strerror(errno));
+    }
+
+    if (fCreated) {
+        mappingSize = SHM_HEADER_SIZE + nRequested * sizeof(Slot);
+        if (ftruncate(fd, mappingSize) != 0) {
+            const int err = errno;
+            close(fd);
+            shm_unlink(segment.c_str());
+            throw std::runtime_error(
+                "Can't size shared memory cache: " +
+                std::string(strerror(err)));
+        }
+    } else {
+        // The creator may not have sized the segment yet
+        const auto deadline =
+            std::chrono::steady_clock::now() + SHM_INIT_TIMEOUT;
+        struct stat st;
+        while (fstat(fd, &st) == 0 && (size_t)st.st_size < SHM_HEADER_SIZE &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        if ((size_t)st.st_size < SHM_HEADER_SIZE) {
+            close(fd);
+            throw std::runtime_error("Shared memory cache is not initialized");
+        }
+        mappingSize = st.st_size;
+    }
+
+    mapping = mmap(
+        nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Can't map shared memory cache");
+    }
+    header = (Header *)mapping;
+    slots = (Slot *)((uint8_t *)mapping + SHM_HEADER_SIZE);
+
+    if (fCreated) {
+        // ftruncate zero filled the slots, which makes them empty
+        new (&header->state) std::atomic<uint32_t>(0);
+        header->magic = SHM_CACHE_MAGIC;
+        header->version = LAYOUT_VERSION;
+        header->slotSize = sizeof(Slot);
+        header->nSlots = nRequested;
+        RandomCacheSalt(header->salt);
+        header->state.store(SHM_STATE_READY, std::memory_order_release);
+    } else {
+        const auto deadline =
+            std::chrono::steady_clock::now() + SHM_INIT_TIMEOUT;
+        while (header->state.load(std::memory_order_acquire) !=
+                   SHM_STATE_READY &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        const char *error = nullptr;
+        if (header->state.load(std::memory_order_acquire) != SHM_STATE_READY) {
+            error = "Shared memory cache is not initialized";
+        } else if (
+            header->magic != SHM_CACHE_MAGIC ||
+            header->version != LAYOUT_VERSION ||
+            header->slotSize != sizeof(Slot)) {
+            error = "Shared memory cache has an incompatible layout";
+        } else if (
+            header->nSlots < PROBE_LENGTH ||
+            (header->nSlots & (header->nSlots - 1)) != 0 ||
+            SHM_HEADER_SIZE + header->nSlots * sizeof(Slot) > mappingSize) {
+            error = "Shared memory cache is corrupt";
+        }
+        if (error) {
+            munmap(mapping, mappingSize);
+            throw std::runtime_error(error);
+        }
+    }
+    this->nSlots = header->nSlots;
+#else
+    (void)name;
+    (void)nSlots;
+    throw std::runtime_error(
+        "Shared memory caches are not supported on this platform");
+#endif
+}
+
+SharedSignatureCache::~SharedSignatureCache()
+{
+#if BLS_HAVE_SHM
+    munmap(mapping, mappingSize);
+#endif
+}
+
+bool SharedSignatureCache::Unlink(const std::string &name)
+{
+#if BLS_HAVE_SHM
+    return shm_unlink(SegmentName(name).c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+bool SharedSignatureCache::Lookup(const CacheKey &key) const
+{
+    uint64_t words[4];
+    KeyWords(words, key);
+    const size_t mask = nSlots - 1;
+    for (size_t i = 0; i < PROBE_LENGTH; i++) {
+        const Slot &slot = slots[(words[0] + i) & mask];
+        const uint64_t seq = slot.seq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        bool fMatch = true;
+        for (size_t j = 0; j < 4; j++) {
+            fMatch &= slot.key[j].load(std::memory_order_relaxed) == words[j];
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (fMatch && slot.seq.load(std::memory_order_relaxed) == seq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SharedSignatureCache::Contains(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    const bool fFound = Lookup(SignatureCacheKey(
+        header->salt, ciphersuite, pubkey, message, signature));
+    if (fFound) {
+        nHits++;
+    } else {
+        nMisses++;
+    }
+    return fFound;
+}
+
+void SharedSignatureCache::Insert(
+    std::string_view ciphersuite,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    const CacheKey key = SignatureCacheKey(
+        header->salt, ciphersuite, pubkey, message, signature);
+    if (Lookup(key)) {
+        return;
+    }
+    uint64_t words[4];
+    KeyWords(words, key);
+    const size_t mask = nSlots - 1;
+
+    // Prefer an empty slot, otherwise overwrite one picked by the key
+    Slot *target = &slots[(words[0] + words[1] % PROBE_LENGTH) & mask];
+    for (size_t i = 0; i < PROBE_LENGTH; i++) {
+        Slot &slot = slots[(words[0] + i) & mask];
+        bool fEmpty = true;
+        for (size_t j = 0; j < 4; j++) {
+            fEmpty &= slot.key[j].load(std::memory_order_relaxed) == 0;
+        }
+        if (fEmpty) {
+            target = &slot;
+            break;
+        }
+    }
+
+    // Best effort: give up if another writer holds the slot
+    uint64_t seq = target->seq.load(std::memory_order_relaxed);
+    if ((seq & 1) || !target->seq.compare_exchange_strong(
+                         seq, seq + 1, std::memory_order_relaxed)) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t j = 0; j < 4; j++) {
+        target->key[j].store(words[j], std::memory_order_relaxed);
+    }
+    target->seq.store(seq + 2, std::memory_order_release);
+}
+
+size_t SharedSignatureCache::Size() const
+{
+    size_t n = 0;
+    for (size_t i = 0; i < nSlots; i++) {
+        for (size_t j = 0; j < 4; j++) {
+            if (slots[i].key[j].load(std::memory_order_relaxed) != 0) {
+                n++;
+                break;
+            }
+        }
+    }
+    return n;
+}
+
+}  // end namespace bls
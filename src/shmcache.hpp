@@ -0,0 +1,94 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SRC_BLSSHMCACHE_HPP_
+#define SRC_BLSSHMCACHE_HPP_
+
+#include <atomic>
+#include <string>
+
+#include "cache.hpp"
+
+namespace bls {
+
+/*
+ * SignatureCacheBase stored in a named POSIX shared memory segment, so that
+ * every process mapping the same name shares verified results. The table
+ * is fixed size and open addressed: a key lives in one of PROBE_LENGTH
+ * slots after its home slot, and when they are all taken one of them is
+ * overwritten. Each slot is guarded by a sequence counter (a seqlock), so
+ * lookups and inserts never block and a process dying mid-write only
+ * loses that slot.
+ *
+ * The first process to open a name creates the segment with a random salt
+ * and the current layout version; later ones check that the layout
+ * matches and throw std::runtime_error otherwise. Not available on Windows
+ * or Emscripten, where the constructor throws.
+ */
+class SharedSignatureCache : public SignatureCacheBase {
+public:
+    static const uint32_t LAYOUT_VERSION = 1;
+    static const size_t PROBE_LENGTH = 8;
+
+    // Opens the segment called name, creating it with nSlots slots (rounded
+    // up to a power of two) if it doesn't exist
+    SharedSignatureCache(const std::string &name, size_t nSlots);
+    ~SharedSignatureCache();
+
+    SharedSignatureCache(const SharedSignatureCache &) = delete;
+    SharedSignatureCache &operator=(const SharedSignatureCache &) = delete;
+
+    bool Contains(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature) override;
+
+    void Insert(
+        std::string_view ciphersuite,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature) override;
+
+    // Number of occupied slots, by scanning the table
+    size_t Size() const;
+    size_t Capacity() const { return nSlots; }
+    // Hits and misses of this process only
+    uint64_t Hits() const { return nHits; }
+    uint64_t Misses() const { return nMisses; }
+
+    // Removes the name; existing mappings stay valid until destroyed.
+    // Returns false if there was no such segment.
+    static bool Unlink(const std::string &name);
+
+private:
+    struct Header;
+    struct Slot;
+
+    bool Lookup(const CacheKey &key) const;
+
+    void *mapping;
+    size_t mappingSize;
+    Header *header;
+    Slot *slots;
+    size_t nSlots;
+
+    std::atomic<uint64_t> nHits{0};
+    std::atomic<uint64_t> nMisses{0};
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSSHMCACHE_HPP_
@@ -0,0 +1,361 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSSTATICSCHEMES_HPP_
+#define SRC_BLSSTATICSCHEMES_HPP_
+
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#include "elements.hpp"
+#include "privatekey.hpp"
+#include "views.hpp"
+
+namespace bls {
+
+// Ciphersuites of the MPL schemes: public keys in G1, signatures in G2
+struct BasicSuiteMPL {
+    static constexpr char ID[] = "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_NUL_";
+    static constexpr bool AUGMENTED = false;
+    static constexpr bool DISTINCT_MESSAGES = true;
+};
+
+struct AugSuiteMPL {
+    static constexpr char ID[] = "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_AUG_";
+    static constexpr bool AUGMENTED = true;
+    static constexpr bool DISTINCT_MESSAGES = false;
+};
+
+struct PopSuiteMPL {
+    static constexpr char ID[] = "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_POP_";
+    static constexpr char POP_ID[] =
+        "BLS_POP_BLS12381G2_XMD:SHA-256_SSWU_RO_POP_";
+    static constexpr bool AUGMENTED = false;
+    static constexpr bool DISTINCT_MESSAGES = false;
+};
+
+// Out of line cores for a given DST, in schemes.cpp. Verification goes
+// through the global SignatureCache like CoreMPL::Verify.
+bool VerifyMPL(
+    std::string_view dst,
+    const G1Element &pubkey,
+    const Bytes &message,
+    const G2Element &signature);
+
+bool VerifyMPL(
+    std::string_view dst,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature);
+
+// Same, without the cache
+bool CoreVerifyMPL(
+    std::string_view dst,
+    const G1Element &pubkey,
+    const Bytes &message,
+    const G2Element &signature);
+
+bool AggregateVerifyMPL(
+    std::string_view dst,
+    const PubKeysView &pubkeys,
+    const MessagesView &messages,
+    const G2Element &signature);
+
+// Batch verification as in CoreMPL. With fDistinctMessages, sets that
+// repeat a message fail.
+bool AggregateVerifyBatchMPL(
+    std::string_view dst,
+    const PubKeySetsView &pubkeys,
+    const MessageSetsView &messages,
+    const SignaturesView &signatures,
+    bool fDistinctMessages);
+
+std::vector<bool> AggregateVerifyBatchEachMPL(
+    std::string_view dst,
+    const PubKeySetsView &pubkeys,
+    const MessageSetsView &messages,
+    const SignaturesView &signatures,
+    bool fDistinctMessages);
+
+bool MessagesAreDistinct(const MessagesView &messages);
+
+/*
+ * An MPL scheme resolved at compile time: the DST is a constexpr array
+ * and every operation is static, so calls need neither a scheme object
+ * nor virtual dispatch, and the scheme logic inlines into the caller.
+ * BasicSchemeMPL, AugSchemeMPL and PopSchemeMPL forward to these.
+ *
+ * Pubkeys, messages and signatures are taken as any random access
+ * sequence an IndexedView accepts, so callers verify from their own
+ * containers without copying into vectors. Messages are anything Bytes
+ * converts from; batches take a sequence of such sequences per argument.
+ */
+template <class Suite>
+class StaticSchemeMPL {
+public:
+    static constexpr std::string_view CIPHERSUITE_ID{
+        Suite::ID,
+        sizeof(Suite::ID) - 1};
+
+    static G2Element Sign(const PrivateKey &seckey, const Bytes &message)
+    {
+        if constexpr (Suite::AUGMENTED) {
+            return Sign(seckey, message, seckey.GetG1Element());
+        } else {
+            return SignRaw(seckey, message);
+        }
+    }
+
+    // Signs with a different public key prepended, for the AUG scheme
+    static G2Element Sign(
+        const PrivateKey &seckey,
+        const Bytes &message,
+        const G1Element &prepend_pk)
+    {
+        static_assert(Suite::AUGMENTED, "only augmented schemes prepend");
+        const std::vector<uint8_t> augMessage =
+            Augment(prepend_pk.Serialize(), message);
+        return SignRaw(seckey, Bytes(augMessage));
+    }
+
+    static bool Verify(
+        const G1Element &pubkey,
+        const Bytes &message,
+        const G2Element &signature)
+    {
+        if constexpr (Suite::AUGMENTED) {
+            const std::vector<uint8_t> augMessage =
+                Augment(pubkey.Serialize(), message);
+            return VerifyMPL(
+                CIPHERSUITE_ID, pubkey, Bytes(augMessage), signature);
+        } else {
+            return VerifyMPL(CIPHERSUITE_ID, pubkey, message, signature);
+        }
+    }
+
+    static bool Verify(
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature)
+    {
+        if constexpr (Suite::AUGMENTED) {
+            const std::vector<uint8_t> augMessage = Augment(
+                std::vector<uint8_t>(pubkey.begin(), pubkey.end()), message);
+            return VerifyMPL(
+                CIPHERSUITE_ID, pubkey, Bytes(augMessage), signature);
+        } else {
+            return VerifyMPL(CIPHERSUITE_ID, pubkey, message, signature);
+        }
+    }
+
+    template <
+        typename PubKeys = std::vector<G1Element>,
+        typename Messages = std::vector<Bytes>>
+    static bool AggregateVerify(
+        const PubKeys &pubkeys,
+        const Messages &messages,
+        const G2Element &signature)
+    {
+        const PubKeysView pubkeysView(pubkeys);
+        const MessagesView messagesView(messages);
+        if constexpr (Suite::AUGMENTED) {
+            if (pubkeysView.size() != messagesView.size()) {
+                return false;
+            }
+            const std::vector<std::vector<uint8_t>> augMessages =
+                AugmentSet(pubkeysView, messagesView);
+            return AggregateVerifyMPL(
+                CIPHERSUITE_ID, pubkeysView, augMessages, signature);
+        } else {
+            if (Suite::DISTINCT_MESSAGES &&
+                !MessagesAreDistinct(messagesView)) {
+                return false;
+            }
+            return AggregateVerifyMPL(
+                CIPHERSUITE_ID, pubkeysView, messagesView, signature);
+        }
+    }
+
+    template <
+        typename PubKeySets = std::vector<std::vector<G1Element>>,
+        typename MessageSets = std::vector<std::vector<Bytes>>,
+        typename Signatures = std::vector<G2Element>>
+    static bool AggregateVerifyBatch(
+        const PubKeySets &pubkeys,
+        const MessageSets &messages,
+        const Signatures &signatures)
+    {
+        if constexpr (Suite::AUGMENTED) {
+            return AggregateVerifyBatchMPL(
+                CIPHERSUITE_ID,
+                pubkeys,
+                AugmentSets(pubkeys, messages),
+                signatures,
+                false);
+        } else {
+            return AggregateVerifyBatchMPL(
+                CIPHERSUITE_ID,
+                pubkeys,
+                messages,
+                signatures,
+                Suite::DISTINCT_MESSAGES);
+        }
+    }
+
+    // Throws std::length_error if the numbers of sets differ
+    template <
+        typename PubKeySets = std::vector<std::vector<G1Element>>,
+        typename MessageSets = std::vector<std::vector<Bytes>>,
+        typename Signatures = std::vector<G2Element>>
+    static std::vector<bool> AggregateVerifyBatchEach(
+        const PubKeySets &pubkeys,
+        const MessageSets &messages,
+        const Signatures &signatures)
+    {
+        if constexpr (Suite::AUGMENTED) {
+            return AggregateVerifyBatchEachMPL(
+                CIPHERSUITE_ID,
+                pubkeys,
+                AugmentSets(pubkeys, messages),
+                signatures,
+                false);
+        } else {
+            return AggregateVerifyBatchEachMPL(
+                CIPHERSUITE_ID,
+                pubkeys,
+                messages,
+                signatures,
+                Suite::DISTINCT_MESSAGES);
+        }
+    }
+
+    // Elements are G1Element or G2Element
+    template <typename Elements>
+    static auto Aggregate(const Elements &elements)
+    {
+        std::decay_t<decltype(*std::begin(elements))> aggregated;
+        for (const auto &element : elements) {
+            aggregated += element;
+        }
+        return aggregated;
+    }
+
+    static G2Element Aggregate(const std::vector<G2Element> &signatures)
+    {
+        return Aggregate<std::vector<G2Element>>(signatures);
+    }
+
+    static G1Element Aggregate(const std::vector<G1Element> &publicKeys)
+    {
+        return Aggregate<std::vector<G1Element>>(publicKeys);
+    }
+
+protected:
+    static G2Element SignRaw(const PrivateKey &seckey, const Bytes &message)
+    {
+        return seckey.SignG2(
+            message.begin(),
+            message.size(),
+            (const uint8_t *)CIPHERSUITE_ID.data(),
+            CIPHERSUITE_ID.size());
+    }
+
+    static std::vector<uint8_t> Augment(
+        std::vector<uint8_t> &&prefix,
+        const Bytes &message)
+    {
+        prefix.reserve(prefix.size() + message.size());
+        prefix.insert(prefix.end(), message.begin(), message.end());
+        return std::move(prefix);
+    }
+
+    static std::vector<std::vector<uint8_t>> AugmentSet(
+        const PubKeysView &pubkeys,
+        const MessagesView &messages)
+    {
+        std::vector<std::vector<uint8_t>> augMessages;
+        augMessages.reserve(messages.size());
+        for (size_t i = 0; i < messages.size(); i++) {
+            augMessages.push_back(
+                Augment(pubkeys[i].Serialize(), messages[i]));
+        }
+        return augMessages;
+    }
+
+    // A set whose sizes differ keeps its message count, and the batch
+    // verification rejects it, as well as any mismatch in the set counts
+    static std::vector<std::vector<std::vector<uint8_t>>> AugmentSets(
+        const PubKeySetsView &pubkeys,
+        const MessageSetsView &messages)
+    {
+        std::vector<std::vector<std::vector<uint8_t>>> augMessages(
+            messages.size());
+        for (size_t j = 0; j < messages.size(); j++) {
+            if (j < pubkeys.size() &&
+                pubkeys[j].size() == messages[j].size()) {
+                augMessages[j] = AugmentSet(pubkeys[j], messages[j]);
+            } else {
+                augMessages[j].resize(messages[j].size());
+            }
+        }
+        return augMessages;
+    }
+};
+
+using StaticBasicSchemeMPL = StaticSchemeMPL<BasicSuiteMPL>;
+using StaticAugSchemeMPL = StaticSchemeMPL<AugSuiteMPL>;
+
+// The POP scheme adds proofs of possession and fast aggregation
+class StaticPopSchemeMPL : public StaticSchemeMPL<PopSuiteMPL> {
+public:
+    static constexpr std::string_view POP_CIPHERSUITE_ID{
+        PopSuiteMPL::POP_ID,
+        sizeof(PopSuiteMPL::POP_ID) - 1};
+
+    static G2Element PopProve(const PrivateKey &seckey)
+    {
+        const std::vector<uint8_t> pubkey = seckey.GetG1Element().Serialize();
+        return seckey.SignG2(
+            pubkey.data(),
+            pubkey.size(),
+            (const uint8_t *)POP_CIPHERSUITE_ID.data(),
+            POP_CIPHERSUITE_ID.size());
+    }
+
+    // Not cached, since each proof is checked once
+    static bool PopVerify(const G1Element &pubkey, const G2Element &proof)
+    {
+        const std::vector<uint8_t> pubkeyBytes = pubkey.Serialize();
+        return CoreVerifyMPL(POP_CIPHERSUITE_ID, pubkey, pubkeyBytes, proof);
+    }
+
+    // Only sound for public keys whose proofs of possession were verified
+    template <typename PubKeys = std::vector<G1Element>>
+    static bool FastAggregateVerify(
+        const PubKeys &pubkeys,
+        const Bytes &message,
+        const G2Element &signature)
+    {
+        if (std::size(pubkeys) == 0) {
+            return false;
+        }
+        return Verify(Aggregate<PubKeys>(pubkeys), message, signature);
+    }
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSSTATICSCHEMES_HPP_
@@ -13,6 +13,8 @@
 // limitations under the License.
 
 #include <chrono>
+#include <future>
+#include <memory>
 
 #include "bls.hpp"
 #include "test-utils.hpp"
@@ -42,7 +44,7 @@ void benchSigs()
     auto start = startStopwatch();
 
     for (int i = 0; i < numIters; i++) {
-        AugSchemeMPL().Sign(sk, message1);
+        StaticAugSchemeMPL::Sign(sk, message1);
     }
     endStopwatch(testName, start, numIters);
 }
@@ -68,12 +70,64 @@ void benchVerification()
         uint8_t message[4];
         Util::IntToFourBytes(message, i);
         vector<uint8_t> messageBytes(message, message + 4);
-        bool ok = AugSchemeMPL().Verify(pk, messageBytes, sigs[i]);
+        bool ok = StaticAugSchemeMPL::Verify(pk, messageBytes, sigs[i]);
         ASSERT(ok);
     }
     endStopwatch(testName, start, numIters);
 }
 
+void benchVerificationCached()
+{
+    const int numIters = 10000;
+    PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+    vector<uint8_t> pkBytes = sk.GetG1Element().Serialize();
+    vector<vector<uint8_t>> ms;
+    vector<vector<uint8_t>> sigs;
+
+    for (int i = 0; i < numIters; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        ms.emplace_back(message, message + 4);
+        sigs.push_back(AugSchemeMPL().Sign(sk, ms.back()).Serialize());
+    }
+
+    auto cache = std::make_shared<SignatureCache>(numIters);
+    SignatureCache::SetGlobal(cache);
+    for (int i = 0; i < numIters; i++) {
+        ASSERT(AugSchemeMPL().Verify(pkBytes, ms[i], sigs[i]));
+    }
+
+    auto start = startStopwatch();
+    for (int i = 0; i < numIters; i++) {
+        bool ok = AugSchemeMPL().Verify(pkBytes, ms[i], sigs[i]);
+        ASSERT(ok);
+    }
+    endStopwatch("Verification, signature cache hits", start, numIters);
+    ASSERT(cache->Hits() == (uint64_t)numIters);
+    SignatureCache::SetGlobal(nullptr);
+}
+
+void benchVerificationSameKey()
+{
+    string testName = "Same key batch verification";
+    const int numIters = 10000;
+    PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+    G1Element pk = sk.GetG1Element();
+    vector<vector<uint8_t>> ms;
+    vector<G2Element> sigs;
+
+    for (int i = 0; i < numIters; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        ms.emplace_back(message, message + 4);
+        sigs.push_back(AugSchemeMPL().Sign(sk, ms.back()));
+    }
+    auto start = startStopwatch();
+    vector<bool> results = AugSchemeMPL().VerifyManySameKey(pk, ms, sigs);
+    ASSERT(results == vector<bool>(numIters, true));
+    endStopwatch(testName, start, numIters);
+}
+
 void benchBatchVerification()
 {
     const int numIters = 100000;
@@ -121,6 +175,258 @@ void benchBatchVerification()
     endStopwatch("Batch verification", start, numIters);
 }
 
+void benchMergedBatchVerification()
+{
+    const int numKeys = 100;
+    const int numMessagesPerKey = 20;
+    const int numIters = numKeys * numMessagesPerKey;
+
+    vector<G1Element> pks;
+    vector<vector<uint8_t>> ms;
+    vector<G2Element> sigs;
+
+    for (int k = 0; k < numKeys; k++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        for (int i = 0; i < numMessagesPerKey; i++) {
+            uint8_t message[4];
+            Util::IntToFourBytes(message, i);
+            vector<uint8_t> messageBytes(message, message + 4);
+            sigs.push_back(AugSchemeMPL().Sign(sk, messageBytes));
+            pks.push_back(sk.GetG1Element());
+            ms.push_back(messageBytes);
+        }
+    }
+    G2Element aggSig = AugSchemeMPL().Aggregate(sigs);
+
+    auto start = startStopwatch();
+    bool ok = AugSchemeMPL().AggregateVerify(pks, ms, aggSig);
+    ASSERT(ok);
+    endStopwatch("Batch verification, repeated keys", start, numIters);
+
+    start = startStopwatch();
+    ok = AugSchemeMPL().AggregateVerifyMerged(pks, ms, aggSig);
+    ASSERT(ok);
+    endStopwatch("Merged batch verification, repeated keys", start, numIters);
+}
+
+void benchAggregateVerificationBatch()
+{
+    const int numAggregates = 50;
+    const int numSigsPerAggregate = 20;
+    const int numIters = numAggregates * numSigsPerAggregate;
+
+    vector<vector<G1Element>> pks(numAggregates);
+    vector<vector<vector<uint8_t>>> ms(numAggregates);
+    vector<G2Element> aggSigs;
+
+    for (int j = 0; j < numAggregates; j++) {
+        vector<G2Element> sigs;
+        for (int i = 0; i < numSigsPerAggregate; i++) {
+            PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+            uint8_t message[4];
+            Util::IntToFourBytes(message, j * numSigsPerAggregate + i);
+            vector<uint8_t> messageBytes(message, message + 4);
+            sigs.push_back(AugSchemeMPL().Sign(sk, messageBytes));
+            pks[j].push_back(sk.GetG1Element());
+            ms[j].push_back(messageBytes);
+        }
+        aggSigs.push_back(AugSchemeMPL().Aggregate(sigs));
+    }
+
+    auto start = startStopwatch();
+    for (int j = 0; j < numAggregates; j++) {
+        bool ok = AugSchemeMPL().AggregateVerify(pks[j], ms[j], aggSigs[j]);
+        ASSERT(ok);
+    }
+    endStopwatch("Separate aggregate verification", start, numIters);
+
+    start = startStopwatch();
+    bool ok = AugSchemeMPL().AggregateVerifyBatch(pks, ms, aggSigs);
+    ASSERT(ok);
+    endStopwatch("Batched aggregate verification", start, numIters);
+
+    // Two bad aggregates, found by bisection
+    aggSigs[7] = aggSigs[8];
+    aggSigs[31] = aggSigs[30];
+    start = startStopwatch();
+    vector<bool> results = AugSchemeMPL().AggregateVerifyBatchEach(
+        pks, ms, aggSigs);
+    endStopwatch("Batched aggregate verification, 2 bad", start, numIters);
+    ASSERT(!results[7] && !results[31] && results[8]);
+}
+
+void benchBatchDeserialization()
+{
+    const int numIters = 5000;
+
+    vector<vector<uint8_t>> pkBytes;
+    for (int i = 0; i < numIters; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        pkBytes.push_back(sk.GetG1Element().Serialize());
+    }
+    const vector<Bytes> pks(pkBytes.begin(), pkBytes.end());
+
+    auto start = startStopwatch();
+    vector<G1Element> serial = G1Element::FromBytesBatch(pks, false);
+    endStopwatch("Public key deserialization, serial", start, numIters);
+
+    start = startStopwatch();
+    vector<G1Element> parallel = G1Element::FromBytesBatch(pks);
+    endStopwatch("Public key deserialization, parallel", start, numIters);
+    ASSERT(serial == parallel);
+}
+
+void benchFieldBackends()
+{
+    const int numIters = 1000;
+
+    // Field elements from public key x coordinates, and their squares
+    vector<blst_fp> values(numIters), squares(numIters), roots(numIters);
+    vector<vector<uint8_t>> pkBytes;
+    for (int i = 0; i < numIters; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        pkBytes.push_back(sk.GetG1Element().Serialize());
+        vector<uint8_t> x = pkBytes.back();
+        x[0] &= 0x1f;
+        blst_fp_from_bendian(&values[i], x.data());
+        blst_fp_sqr(&squares[i], &values[i]);
+    }
+    const vector<Bytes> pkViews(pkBytes.begin(), pkBytes.end());
+    std::unique_ptr<bool[]> fRoots(new bool[numIters]);
+
+    const std::pair<FpBackend, string> backends[] = {
+        {FP_BLST, "blst"}, {FP_IFMA, "ifma"}};
+    for (const auto& backend : backends) {
+        if (!FpHasBackend(backend.first)) {
+            continue;
+        }
+        blst_fp product = values[0];
+        auto start = startStopwatch();
+        for (int j = 0; j < 1000; j++) {
+            for (int i = 0; i < numIters; i++) {
+                FpMul(product, product, values[i], backend.first);
+            }
+        }
+        endStopwatch(
+            "Fp multiplication, " + backend.second, start, numIters * 1000);
+
+        start = startStopwatch();
+        FpSqrtBatch(
+            roots.data(),
+            fRoots.get(),
+            squares.data(),
+            numIters,
+            backend.first);
+        endStopwatch("Fp square roots, " + backend.second, start, numIters);
+        for (int i = 0; i < numIters; i++) {
+            ASSERT(fRoots[i]);
+        }
+
+        start = startStopwatch();
+        vector<G1Element> pks =
+            G1Element::FromBytesBatch(pkViews, false, backend.first);
+        endStopwatch(
+            "Public key deserialization, serial, " + backend.second,
+            start,
+            numIters);
+        ASSERT(pks.size() == pkViews.size());
+    }
+}
+
+void benchHashToG2()
+{
+    const int numIters = 5000;
+    const uint8_t* dst = (const uint8_t*)AugSchemeMPL::CIPHERSUITE_ID.c_str();
+    const int dst_len = AugSchemeMPL::CIPHERSUITE_ID.length();
+
+    vector<vector<uint8_t>> ms;
+    for (int i = 0; i < numIters; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        ms.emplace_back(message, message + 4);
+    }
+
+    auto start = startStopwatch();
+    vector<G2Element> single;
+    for (const vector<uint8_t>& m : ms) {
+        single.push_back(G2Element::FromMessage(m, dst, dst_len));
+    }
+    endStopwatch("Hash to G2, one by one", start, numIters);
+
+    start = startStopwatch();
+    vector<G2Element> batch = G2Element::FromMessages(ms, dst, dst_len);
+    endStopwatch("Hash to G2, batched", start, numIters);
+    ASSERT(single == batch);
+}
+
+void benchSchedulerUnderFlood()
+{
+    const int numFlood = 4000;
+    const int numIters = 50;
+
+    PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+    vector<uint8_t> pk = sk.GetG1Element().Serialize();
+    vector<vector<uint8_t>> ms, sigs;
+    for (int i = 0; i < numFlood; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        ms.emplace_back(message, message + 4);
+        sigs.push_back(AugSchemeMPL().Sign(sk, ms.back()).Serialize());
+    }
+
+    // Spam with bad signatures fills the best effort lane
+    VerifyScheduler scheduler;
+    vector<std::future<VerifyStatus>> flood;
+    for (int i = 0; i < numFlood; i++) {
+        flood.push_back(scheduler.Submit(
+            PRIORITY_BEST_EFFORT,
+            VERIFY_AUG,
+            pk,
+            ms[i],
+            sigs[(i + 1) % numFlood]));
+    }
+
+    auto start = startStopwatch();
+    for (int i = 0; i < numIters; i++) {
+        std::future<VerifyStatus> status = scheduler.Submit(
+            PRIORITY_CONSENSUS, VERIFY_AUG, pk, ms[i], sigs[i]);
+        ASSERT(status.get() == VERIFY_VALID);
+    }
+    endStopwatch("Consensus verification under a spam flood", start, numIters);
+    scheduler.Stop();
+}
+
+void benchAggregateVerificationCached()
+{
+    const int numIters = 1000;
+    const int numNew = numIters / 10;
+
+    vector<G1Element> pks;
+    vector<vector<uint8_t>> ms;
+    vector<G2Element> sigs;
+    for (int i = 0; i < numIters; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        ms.emplace_back(message, message + 4);
+        sigs.push_back(AugSchemeMPL().Sign(sk, ms.back()));
+        pks.push_back(sk.GetG1Element());
+    }
+    G2Element aggSig = AugSchemeMPL().Aggregate(sigs);
+
+    // All but numNew pairs were seen before, e.g. in the mempool
+    PairingCache cache(numIters);
+    for (int i = numNew; i < numIters; i++) {
+        ASSERT(AugSchemeMPL().AggregateVerifyCached(
+            {pks[i]}, vector<vector<uint8_t>>{ms[i]}, sigs[i], cache));
+    }
+
+    auto start = startStopwatch();
+    bool ok = AugSchemeMPL().AggregateVerifyCached(pks, ms, aggSig, cache);
+    ASSERT(ok);
+    endStopwatch("Aggregate verification, 90% cached pairs", start, numIters);
+}
+
 void benchFastAggregateVerification()
 {
     const int numIters = 5000;
@@ -155,10 +461,147 @@ void benchFastAggregateVerification()
     endStopwatch("PopScheme verification", start, numIters);
 }
 
+void benchSigsMinSig()
+{
+    string testName = "MinSig signing";
+    const int numIters = 5000;
+    PrivateKey sk = AugSchemeMSL().KeyGen(getRandomSeed());
+    vector<uint8_t> message1 = sk.GetG2Element().Serialize();
+
+    auto start = startStopwatch();
+
+    for (int i = 0; i < numIters; i++) {
+        AugSchemeMSL().Sign(sk, message1);
+    }
+    endStopwatch(testName, start, numIters);
+}
+
+void benchVerificationMinSig()
+{
+    string testName = "MinSig verification";
+    const int numIters = 10000;
+    PrivateKey sk = AugSchemeMSL().KeyGen(getRandomSeed());
+    G2Element pk = sk.GetG2Element();
+    std::vector<G1Element> sigs;
+
+    for (int i = 0; i < numIters; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        vector<uint8_t> messageBytes(message, message + 4);
+        sigs.push_back(AugSchemeMSL().Sign(sk, messageBytes));
+    }
+    auto start = startStopwatch();
+    for (int i = 0; i < numIters; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        vector<uint8_t> messageBytes(message, message + 4);
+        bool ok = AugSchemeMSL().Verify(pk, messageBytes, sigs[i]);
+        ASSERT(ok);
+    }
+    endStopwatch(testName, start, numIters);
+}
+
+void benchBatchVerificationMinSig()
+{
+    const int numIters = 100000;
+
+    vector<vector<uint8_t>> sig_bytes;
+    vector<vector<uint8_t>> pk_bytes;
+    vector<vector<uint8_t>> ms;
+
+    for (int i = 0; i < numIters; i++) {
+        uint8_t message[4];
+        Util::IntToFourBytes(message, i);
+        vector<uint8_t> messageBytes(message, message + 4);
+        PrivateKey sk = AugSchemeMSL().KeyGen(getRandomSeed());
+        G2Element pk = sk.GetG2Element();
+        sig_bytes.push_back(AugSchemeMSL().Sign(sk, messageBytes).Serialize());
+        pk_bytes.push_back(pk.Serialize());
+        ms.push_back(messageBytes);
+    }
+
+    vector<G2Element> pks;
+    pks.reserve(numIters);
+
+    auto start = startStopwatch();
+    for (auto const& pk : pk_bytes) {
+        pks.emplace_back(G2Element::FromBytes(Bytes(pk)));
+    }
+    endStopwatch("MinSig public key validation", start, numIters);
+
+    vector<G1Element> sigs;
+    sigs.reserve(numIters);
+
+    start = startStopwatch();
+    for (auto const& sig : sig_bytes) {
+        sigs.emplace_back(G1Element::FromBytes(Bytes(sig)));
+    }
+    endStopwatch("MinSig signature validation", start, numIters);
+
+    start = startStopwatch();
+    G1Element aggSig = AugSchemeMSL().Aggregate(sigs);
+    endStopwatch("MinSig aggregation", start, numIters);
+
+    start = startStopwatch();
+    bool ok = AugSchemeMSL().AggregateVerify(pks, ms, aggSig);
+    ASSERT(ok);
+    endStopwatch("MinSig batch verification", start, numIters);
+}
+
+void benchFastAggregateVerificationMinSig()
+{
+    const int numIters = 5000;
+
+    vector<G1Element> sigs;
+    vector<G2Element> pks;
+    vector<uint8_t> message = {1, 2, 3, 4, 5, 6, 7, 8};
+    vector<G1Element> pops;
+
+    for (int i = 0; i < numIters; i++) {
+        PrivateKey sk = PopSchemeMSL().KeyGen(getRandomSeed());
+        G2Element pk = sk.GetG2Element();
+        sigs.push_back(PopSchemeMSL().Sign(sk, message));
+        pops.push_back(PopSchemeMSL().PopProve(sk));
+        pks.push_back(pk);
+    }
+
+    auto start = startStopwatch();
+    G1Element aggSig = PopSchemeMSL().Aggregate(sigs);
+    endStopwatch("MinSig PopScheme Aggregation", start, numIters);
+
+    start = startStopwatch();
+    for (int i = 0; i < numIters; i++) {
+        bool ok = PopSchemeMSL().PopVerify(pks[i], pops[i]);
+        ASSERT(ok);
+    }
+    endStopwatch("MinSig PopScheme Proofs verification", start, numIters);
+
+    start = startStopwatch();
+    bool ok = PopSchemeMSL().FastAggregateVerify(pks, message, aggSig);
+    ASSERT(ok);
+    endStopwatch("MinSig PopScheme verification", start, numIters);
+}
+
 int main(int argc, char* argv[])
 {
+    cout << "Backend: " << BLS::GetBackendName() << endl;
+
     benchSigs();
     benchVerification();
+    benchVerificationCached();
+    benchVerificationSameKey();
     benchBatchVerification();
+    benchMergedBatchVerification();
+    benchAggregateVerificationBatch();
+    benchAggregateVerificationCached();
     benchFastAggregateVerification();
+    benchBatchDeserialization();
+    benchFieldBackends();
+    benchHashToG2();
+    benchSchedulerUnderFlood();
+
+    benchSigsMinSig();
+    benchVerificationMinSig();
+    benchBatchVerificationMinSig();
+    benchFastAggregateVerificationMinSig();
 }
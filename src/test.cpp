@@ -14,16 +14,48 @@
 // limitations under the License.
 
 #include <catch2/catch_session.hpp>
+#include <atomic>
 #include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <new>
 #include <thread>
 
 #include "bls.hpp"
 #include "test-utils.hpp"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 using std::string;
 using std::vector;
 
 using namespace bls;
 
+// Counts allocations made through operator new, see "Allocation free
+// aggregate verification"
+static std::atomic<size_t> nAllocations{0};
+// argv[0], for tests that run the binary again with another environment
+static const char* testBinary = nullptr;
+
+void* operator new(size_t size)
+{
+    nAllocations++;
+    if (void* p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
 void TestHKDF(
     string ikm_hex,
     string salt_hex,
@@ -165,6 +197,41 @@ TEST_CASE("class PrivateKey")
         REQUIRE_THROWS(
             pk1.SignG2(buffer, sizeof(buffer), buffer, sizeof(buffer)));
     }
+    SECTION("Public keys shared between threads")
+    {
+        PrivateKey pk1 = PrivateKey::FromByteVector(getRandomSeed(), true);
+        const PrivateKey expected = PrivateKey(pk1);
+        std::atomic<bool> fStart{false};
+        std::vector<std::thread> threads;
+        std::vector<const G1Element *> g1s(8);
+        std::vector<const G2Element *> g2s(8);
+        for (size_t i = 0; i < g1s.size(); i++) {
+            threads.emplace_back([&, i] {
+                while (!fStart) {
+                    std::this_thread::yield();
+                }
+                g1s[i] = &pk1.GetG1Element();
+                g2s[i] = &pk1.GetG2Element();
+            });
+        }
+        fStart = true;
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        for (size_t i = 0; i < g1s.size(); i++) {
+            REQUIRE(g1s[i] == &pk1.GetG1Element());
+            REQUIRE(g2s[i] == &pk1.GetG2Element());
+        }
+        REQUIRE(pk1.GetG1Element() == expected.GetG1Element());
+        REQUIRE(pk1.GetG2Element() == expected.GetG2Element());
+
+        // Copies and moves take the caches along
+        PrivateKey pk2 = PrivateKey(pk1);
+        REQUIRE(pk2.GetG1Element() == expected.GetG1Element());
+        PrivateKey pk3 = std::move(pk2);
+        REQUIRE(pk3.GetG2Element() == expected.GetG2Element());
+        REQUIRE_THROWS(pk2.GetG1Element());
+    }
 }
 
 TEST_CASE("HKDF")
@@ -1364,6 +1431,1746 @@ TEST_CASE("Schemes")
     }
 }
 
+TEST_CASE("Static schemes")
+{
+    static_assert(
+        StaticAugSchemeMPL::CIPHERSUITE_ID ==
+        "BLS_SIG_BLS12381G2_XMD:SHA-256_SSWU_RO_AUG_");
+    REQUIRE(
+        std::string(StaticBasicSchemeMPL::CIPHERSUITE_ID) ==
+        BasicSchemeMPL::CIPHERSUITE_ID);
+    REQUIRE(
+        std::string(StaticPopSchemeMPL::POP_CIPHERSUITE_ID) ==
+        PopSchemeMPL::POP_CIPHERSUITE_ID);
+
+    PrivateKey sk1 = AugSchemeMPL().KeyGen(vector<uint8_t>(32, 0x08));
+    PrivateKey sk2 = AugSchemeMPL().KeyGen(vector<uint8_t>(32, 0x09));
+    G1Element pk1 = sk1.GetG1Element();
+    G1Element pk2 = sk2.GetG1Element();
+    vector<uint8_t> msg1 = {1, 2, 3};
+    vector<uint8_t> msg2 = {4, 5, 6};
+    vector<Bytes> msgs = {Bytes(msg1), Bytes(msg2)};
+
+    SECTION("Same signatures as the scheme objects")
+    {
+        REQUIRE(
+            StaticBasicSchemeMPL::Sign(sk1, msg1) ==
+            BasicSchemeMPL().CoreMPL::Sign(sk1, msg1));
+        vector<uint8_t> aug1 = pk1.Serialize();
+        vector<uint8_t> aug2 = pk2.Serialize();
+        aug1.insert(aug1.end(), msg1.begin(), msg1.end());
+        aug2.insert(aug2.end(), msg1.begin(), msg1.end());
+        REQUIRE(
+            StaticAugSchemeMPL::Sign(sk1, msg1) ==
+            AugSchemeMPL().CoreMPL::Sign(sk1, aug1));
+        REQUIRE(
+            StaticAugSchemeMPL::Sign(sk1, msg1, pk2) ==
+            AugSchemeMPL().CoreMPL::Sign(sk1, aug2));
+        REQUIRE(
+            StaticPopSchemeMPL::PopProve(sk1) ==
+            PopSchemeMPL().PopProve(sk1));
+    }
+
+    SECTION("Verification")
+    {
+        G2Element sig1 = StaticAugSchemeMPL::Sign(sk1, msg1);
+        G2Element sig2 = StaticAugSchemeMPL::Sign(sk2, msg2);
+        REQUIRE(StaticAugSchemeMPL::Verify(pk1, msg1, sig1));
+        REQUIRE(!StaticAugSchemeMPL::Verify(pk2, msg1, sig1));
+        REQUIRE(StaticAugSchemeMPL::Verify(
+            Bytes(pk1.Serialize()), msg1, Bytes(sig1.Serialize())));
+        REQUIRE(!StaticBasicSchemeMPL::Verify(pk1, msg1, sig1));
+
+        G2Element aggsig = StaticAugSchemeMPL::Aggregate({sig1, sig2});
+        REQUIRE(StaticAugSchemeMPL::AggregateVerify({pk1, pk2}, msgs, aggsig));
+        REQUIRE(!StaticAugSchemeMPL::AggregateVerify({pk1}, msgs, aggsig));
+        REQUIRE(AugSchemeMPL().AggregateVerify({pk1, pk2}, msgs, aggsig));
+
+        // Basic requires distinct messages
+        G2Element same = StaticBasicSchemeMPL::Aggregate(
+            {StaticBasicSchemeMPL::Sign(sk1, msg1),
+             StaticBasicSchemeMPL::Sign(sk2, msg1)});
+        vector<Bytes> sameMsgs = {Bytes(msg1), Bytes(msg1)};
+        REQUIRE(!StaticBasicSchemeMPL::AggregateVerify(
+            {pk1, pk2}, sameMsgs, same));
+    }
+
+    SECTION("Proofs of possession")
+    {
+        REQUIRE(StaticPopSchemeMPL::PopVerify(
+            pk1, StaticPopSchemeMPL::PopProve(sk1)));
+        REQUIRE(!StaticPopSchemeMPL::PopVerify(
+            pk2, StaticPopSchemeMPL::PopProve(sk1)));
+
+        G2Element aggsig = StaticPopSchemeMPL::Aggregate(
+            {StaticPopSchemeMPL::Sign(sk1, msg1),
+             StaticPopSchemeMPL::Sign(sk2, msg1)});
+        REQUIRE(StaticPopSchemeMPL::FastAggregateVerify(
+            {pk1, pk2}, msg1, aggsig));
+        REQUIRE(!StaticPopSchemeMPL::FastAggregateVerify({}, msg1, aggsig));
+        REQUIRE(PopSchemeMPL().FastAggregateVerify({pk1, pk2}, msg1, aggsig));
+    }
+
+    SECTION("Ranges")
+    {
+        // Sequences of the wrong elements are not viewed
+        static_assert(
+            !std::is_constructible<
+                PubKeysView,
+                const vector<vector<uint8_t>> &>::value,
+            "serialized pubkeys are not G1Elements");
+        static_assert(
+            !std::is_constructible<SignaturesView, const vector<G1Element> &>::
+                value,
+            "G1Elements are not signatures");
+        static_assert(
+            !std::is_constructible<MessagesView, const vector<G1Element> &>::
+                value,
+            "G1Elements are not messages");
+        static_assert(
+            std::is_constructible<PubKeysView, const std::deque<G1Element> &>::
+                value,
+            "deques of G1Elements are pubkeys");
+
+        // Keys and messages held outside of vectors
+        const std::deque<G1Element> pks = {pk1, pk2};
+        const std::array<uint8_t, 3> rawMsgs[] = {{1, 2, 3}, {4, 5, 6}};
+        G2Element aggsig = StaticAugSchemeMPL::Aggregate(
+            {StaticAugSchemeMPL::Sign(sk1, msg1),
+             StaticAugSchemeMPL::Sign(sk2, msg2)});
+        REQUIRE(StaticAugSchemeMPL::AggregateVerify(pks, rawMsgs, aggsig));
+        REQUIRE(!StaticAugSchemeMPL::AggregateVerify(
+            IteratorRange(pks.begin(), pks.begin() + 1),
+            IteratorRange(rawMsgs, rawMsgs + 1),
+            aggsig));
+        REQUIRE(StaticPopSchemeMPL::FastAggregateVerify(
+            pks,
+            msg1,
+            StaticPopSchemeMPL::Aggregate(
+                {StaticPopSchemeMPL::Sign(sk1, msg1),
+                 StaticPopSchemeMPL::Sign(sk2, msg1)})));
+
+        // Batches: one set per signature, the second with a bad signature
+        const std::deque<G1Element> set1 = {pk1};
+        const std::deque<G1Element> set2 = {pk2};
+        const vector<PubKeysView> pkSets = {
+            PubKeysView(set1), PubKeysView(set2)};
+        const vector<IteratorRange<const std::array<uint8_t, 3> *>> msgSets = {
+            IteratorRange(rawMsgs, rawMsgs + 1),
+            IteratorRange(rawMsgs + 1, rawMsgs + 2)};
+        const G2Element sigs[] = {
+            StaticBasicSchemeMPL::Sign(sk1, msg1),
+            StaticBasicSchemeMPL::Sign(sk1, msg2)};
+        REQUIRE(!StaticBasicSchemeMPL::AggregateVerifyBatch(
+            pkSets, msgSets, sigs));
+        REQUIRE(
+            StaticBasicSchemeMPL::AggregateVerifyBatchEach(
+                pkSets, msgSets, sigs) == vector<bool>{true, false});
+        REQUIRE(StaticBasicSchemeMPL::AggregateVerifyBatch(
+            IteratorRange(pkSets.begin(), pkSets.begin() + 1),
+            IteratorRange(msgSets.begin(), msgSets.begin() + 1),
+            IteratorRange(sigs, sigs + 1)));
+
+        // Aug sets, and a Basic set repeating its message
+        const G2Element augSigs[] = {
+            StaticAugSchemeMPL::Sign(sk1, msg1),
+            StaticAugSchemeMPL::Sign(sk2, msg2)};
+        REQUIRE(StaticAugSchemeMPL::AggregateVerifyBatch(
+            pkSets, msgSets, augSigs));
+        const std::deque<G1Element> both = {pk1, pk2};
+        const vector<vector<uint8_t>> same = {msg1, msg1};
+        const vector<PubKeysView> repeatPks = {PubKeysView(both)};
+        const vector<MessagesView> repeatMsgs = {MessagesView(same)};
+        const G2Element repeatSig = StaticBasicSchemeMPL::Aggregate(
+            {StaticBasicSchemeMPL::Sign(sk1, msg1),
+             StaticBasicSchemeMPL::Sign(sk2, msg1)});
+        REQUIRE(
+            StaticBasicSchemeMPL::AggregateVerifyBatchEach(
+                repeatPks, repeatMsgs, vector<G2Element>{repeatSig}) ==
+            vector<bool>{false});
+        REQUIRE_THROWS_AS(
+            StaticAugSchemeMPL::AggregateVerifyBatchEach(
+                pkSets, repeatMsgs, augSigs),
+            std::length_error);
+    }
+}
+
+TEST_CASE("Merged aggregate verification")
+{
+    SECTION("Aug scheme with several messages per key")
+    {
+        vector<G1Element> pks;
+        vector<vector<uint8_t>> msgs;
+        vector<G2Element> sigs;
+        for (uint8_t k = 0; k < 3; k++) {
+            PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+            for (uint8_t m = 0; m < 4; m++) {
+                vector<uint8_t> msg = {m, 1, 2, 3};
+                pks.push_back(sk.GetG1Element());
+                msgs.push_back(msg);
+                sigs.push_back(AugSchemeMPL().Sign(sk, msg));
+            }
+        }
+        G2Element aggsig = AugSchemeMPL().Aggregate(sigs);
+        REQUIRE(AugSchemeMPL().AggregateVerify(pks, msgs, aggsig));
+        REQUIRE(AugSchemeMPL().AggregateVerifyMerged(pks, msgs, aggsig));
+
+        vector<vector<uint8_t>> badMsgs(msgs);
+        badMsgs[5][0] = 9;
+        REQUIRE(!AugSchemeMPL().AggregateVerify(pks, badMsgs, aggsig));
+        REQUIRE(!AugSchemeMPL().AggregateVerifyMerged(pks, badMsgs, aggsig));
+
+        vector<G1Element> swappedPks(pks);
+        std::swap(swappedPks[0], swappedPks[11]);
+        REQUIRE(!AugSchemeMPL().AggregateVerifyMerged(swappedPks, msgs, aggsig));
+
+        G2Element partial = AugSchemeMPL().Aggregate(
+            vector<G2Element>(sigs.begin(), sigs.end() - 1));
+        REQUIRE(!AugSchemeMPL().AggregateVerifyMerged(pks, msgs, partial));
+        REQUIRE(!AugSchemeMPL().AggregateVerifyMerged(
+            pks, vector<vector<uint8_t>>(msgs.begin(), msgs.end() - 1), aggsig));
+    }
+
+    SECTION("Pop scheme with shared messages")
+    {
+        vector<G1Element> pks;
+        vector<vector<uint8_t>> msgs;
+        vector<G2Element> sigs;
+        vector<uint8_t> common = {1, 2, 3};
+        for (uint8_t k = 0; k < 6; k++) {
+            PrivateKey sk = PopSchemeMPL().KeyGen(getRandomSeed());
+            vector<uint8_t> msg = (k < 5) ? common : vector<uint8_t>{k};
+            pks.push_back(sk.GetG1Element());
+            msgs.push_back(msg);
+            sigs.push_back(PopSchemeMPL().Sign(sk, msg));
+        }
+        G2Element aggsig = PopSchemeMPL().Aggregate(sigs);
+        REQUIRE(PopSchemeMPL().AggregateVerify(pks, msgs, aggsig));
+        REQUIRE(PopSchemeMPL().AggregateVerifyMerged(pks, msgs, aggsig));
+
+        msgs[5] = common;
+        REQUIRE(!PopSchemeMPL().AggregateVerifyMerged(pks, msgs, aggsig));
+    }
+
+    SECTION("Basic scheme and edge cases")
+    {
+        PrivateKey sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+        vector<uint8_t> msg1 = {1}, msg2 = {2};
+        G2Element aggsig = BasicSchemeMPL().Aggregate(
+            {BasicSchemeMPL().Sign(sk, msg1), BasicSchemeMPL().Sign(sk, msg2)});
+        vector<G1Element> pks = {sk.GetG1Element(), sk.GetG1Element()};
+        REQUIRE(BasicSchemeMPL().AggregateVerifyMerged(
+            pks, vector<vector<uint8_t>>{msg1, msg2}, aggsig));
+        REQUIRE(!BasicSchemeMPL().AggregateVerifyMerged(
+            pks, vector<vector<uint8_t>>{msg1, msg1}, aggsig));
+
+        REQUIRE(BasicSchemeMPL().AggregateVerifyMerged(
+            {}, vector<vector<uint8_t>>{}, G2Element()));
+        REQUIRE(!BasicSchemeMPL().AggregateVerifyMerged(
+            {G1Element()}, vector<vector<uint8_t>>{msg1}, G2Element()));
+        REQUIRE(!BasicSchemeMPL().AggregateVerify(
+            {G1Element()}, vector<vector<uint8_t>>{msg1}, G2Element()));
+    }
+}
+
+TEST_CASE("Same key batch verification")
+{
+    SECTION("All valid and one invalid signature")
+    {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        G1Element pk = sk.GetG1Element();
+        vector<vector<uint8_t>> msgs;
+        vector<G2Element> augSigs, basicSigs, popSigs;
+        for (uint8_t i = 0; i < 10; i++) {
+            msgs.push_back({i, 7, 7});
+            augSigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()));
+            basicSigs.push_back(BasicSchemeMPL().Sign(sk, msgs.back()));
+            popSigs.push_back(PopSchemeMPL().Sign(sk, msgs.back()));
+        }
+
+        const vector<bool> allValid(msgs.size(), true);
+        REQUIRE(AugSchemeMPL().VerifyManySameKey(pk, msgs, augSigs) == allValid);
+        REQUIRE(
+            BasicSchemeMPL().VerifyManySameKey(pk, msgs, basicSigs) == allValid);
+        REQUIRE(PopSchemeMPL().VerifyManySameKey(pk, msgs, popSigs) == allValid);
+        REQUIRE(
+            BasicSchemeMPL().VerifyManySameKey(pk, msgs, augSigs) ==
+            vector<bool>(msgs.size(), false));
+
+        vector<G2Element> badSigs(augSigs);
+        std::swap(badSigs[3], badSigs[4]);
+        badSigs[7] = G2Element();
+        vector<bool> expected(allValid);
+        expected[3] = expected[4] = expected[7] = false;
+        REQUIRE(AugSchemeMPL().VerifyManySameKey(pk, msgs, badSigs) == expected);
+
+        PrivateKey other = AugSchemeMPL().KeyGen(getRandomSeed());
+        REQUIRE(
+            AugSchemeMPL().VerifyManySameKey(
+                other.GetG1Element(), msgs, augSigs) ==
+            vector<bool>(msgs.size(), false));
+    }
+
+    SECTION("Edge cases")
+    {
+        PrivateKey sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+        vector<uint8_t> msg = {1, 2, 3};
+        G2Element sig = BasicSchemeMPL().Sign(sk, msg);
+        REQUIRE(
+            BasicSchemeMPL().VerifyManySameKey(
+                sk.GetG1Element(), vector<vector<uint8_t>>{msg}, {sig}) ==
+            vector<bool>{true});
+        REQUIRE(BasicSchemeMPL()
+                    .VerifyManySameKey(
+                        sk.GetG1Element(), vector<vector<uint8_t>>{}, {})
+                    .empty());
+        REQUIRE(
+            BasicSchemeMPL().VerifyManySameKey(
+                G1Element(), vector<vector<uint8_t>>{msg, msg}, {sig, sig}) ==
+            vector<bool>{false, false});
+        REQUIRE_THROWS(BasicSchemeMPL().VerifyManySameKey(
+            sk.GetG1Element(), vector<vector<uint8_t>>{msg}, {sig, sig}));
+    }
+}
+
+TEST_CASE("Batch verification of aggregate signatures")
+{
+    SECTION("Independent aggregates")
+    {
+        vector<vector<G1Element>> pks(4);
+        vector<vector<vector<uint8_t>>> msgs(4);
+        vector<G2Element> augAggs, basicAggs;
+        for (uint8_t j = 0; j < 4; j++) {
+            vector<G2Element> augSigs, basicSigs;
+            for (uint8_t i = 0; i <= j; i++) {
+                PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+                pks[j].push_back(sk.GetG1Element());
+                msgs[j].push_back({j, i, 9});
+                augSigs.push_back(AugSchemeMPL().Sign(sk, msgs[j].back()));
+                basicSigs.push_back(BasicSchemeMPL().Sign(sk, msgs[j].back()));
+            }
+            augAggs.push_back(AugSchemeMPL().Aggregate(augSigs));
+            basicAggs.push_back(BasicSchemeMPL().Aggregate(basicSigs));
+        }
+
+        REQUIRE(AugSchemeMPL().AggregateVerifyBatch(pks, msgs, augAggs));
+        REQUIRE(BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, basicAggs));
+        REQUIRE(!BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, augAggs));
+
+        // Each aggregate is checked on its own, not just their sum
+        vector<G2Element> badAggs(augAggs);
+        badAggs[1] += augAggs[3];
+        badAggs[2] += augAggs[3].Negate();
+        REQUIRE(!AugSchemeMPL().AggregateVerifyBatch(pks, msgs, badAggs));
+        badAggs = augAggs;
+        std::swap(badAggs[0], badAggs[1]);
+        REQUIRE(!AugSchemeMPL().AggregateVerifyBatch(pks, msgs, badAggs));
+
+        vector<vector<vector<uint8_t>>> badMsgs(msgs);
+        badMsgs[3][1] = {0, 0, 0};
+        REQUIRE(!AugSchemeMPL().AggregateVerifyBatch(pks, badMsgs, augAggs));
+    }
+
+    SECTION("Edge cases")
+    {
+        PrivateKey sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+        vector<uint8_t> msg = {1, 2, 3};
+        G2Element sig = BasicSchemeMPL().Sign(sk, msg);
+        vector<vector<G1Element>> pks = {{sk.GetG1Element()}, {}};
+        vector<vector<vector<uint8_t>>> msgs = {{msg}, {}};
+
+        REQUIRE(BasicSchemeMPL().AggregateVerifyBatch(
+            pks, msgs, {sig, G2Element()}));
+        REQUIRE(!BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, {sig, sig}));
+        REQUIRE(!BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, {sig}));
+        pks = {vector<G1Element>()};
+        msgs = {vector<vector<uint8_t>>()};
+        REQUIRE(BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, {G2Element()}));
+        pks.clear();
+        msgs.clear();
+        REQUIRE(BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, {}));
+
+        // Messages must be distinct within, but not across, aggregates
+        pks = {{sk.GetG1Element()}, {sk.GetG1Element()}};
+        msgs = {{msg}, {msg}};
+        REQUIRE(BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, {sig, sig}));
+        pks = {{sk.GetG1Element(), sk.GetG1Element()}};
+        msgs = {{msg, msg}};
+        REQUIRE(!BasicSchemeMPL().AggregateVerifyBatch(pks, msgs, {sig + sig}));
+    }
+
+    SECTION("Failure localization")
+    {
+        vector<vector<G1Element>> pks(11);
+        vector<vector<vector<uint8_t>>> msgs(11);
+        vector<G2Element> aggs;
+        for (uint8_t j = 0; j < 11; j++) {
+            vector<G2Element> sigs;
+            for (uint8_t i = 0; i < 2; i++) {
+                PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+                pks[j].push_back(sk.GetG1Element());
+                msgs[j].push_back({j, i, 5});
+                sigs.push_back(AugSchemeMPL().Sign(sk, msgs[j].back()));
+            }
+            aggs.push_back(AugSchemeMPL().Aggregate(sigs));
+        }
+        REQUIRE(AugSchemeMPL().AggregateVerifyBatchEach(pks, msgs, aggs) ==
+                vector<bool>(11, true));
+
+        // Bad sets that cancel in the sum are still told apart
+        vector<G2Element> badAggs(aggs);
+        badAggs[2] += aggs[0];
+        badAggs[7] += aggs[0].Negate();
+        badAggs[10] = G2Element();
+        vector<bool> expected(11, true);
+        expected[2] = expected[7] = expected[10] = false;
+        REQUIRE(
+            AugSchemeMPL().AggregateVerifyBatchEach(pks, msgs, badAggs) ==
+            expected);
+
+        // Sets rejected without pairings, and per set distinctness
+        pks[4].push_back(G1Element());
+        msgs[4].push_back({4, 2, 5});
+        msgs[5].pop_back();
+        const vector<bool> results =
+            BasicSchemeMPL().AggregateVerifyBatchEach(pks, msgs, aggs);
+        REQUIRE(results.size() == 11);
+        for (size_t j = 0; j < 11; j++) {
+            REQUIRE(!results[j]);
+        }
+        REQUIRE_THROWS(
+            AugSchemeMPL().AggregateVerifyBatchEach(pks, msgs, {aggs[0]}));
+        expected = vector<bool>(11, true);
+        expected[4] = expected[5] = false;
+        REQUIRE(
+            AugSchemeMPL().AggregateVerifyBatchEach(pks, msgs, aggs) ==
+            expected);
+        pks.clear();
+        msgs.clear();
+        REQUIRE(AugSchemeMPL().AggregateVerifyBatchEach(pks, msgs, {}).empty());
+    }
+}
+
+TEST_CASE("CPU feature dispatch")
+{
+    const int supported = BLS::GetCpuFeatures();
+    const int enabled = BLS::GetEnabledCpuFeatures();
+    REQUIRE((enabled & ~supported) == 0);
+    REQUIRE(!BLS::GetBackendName().empty());
+
+    vector<uint8_t> seed = getRandomSeed();
+    vector<uint8_t> msg = {1, 2, 3, 4};
+    PrivateKey sk = AugSchemeMPL().KeyGen(seed);
+    G2Element sig = AugSchemeMPL().Sign(sk, msg);
+    vector<uint8_t> hash(32);
+    Util::Hash256(hash.data(), msg.data(), msg.size());
+
+    vector<vector<uint8_t>> pkBytes;
+    for (int i = 0; i < 9; i++) {
+        pkBytes.push_back(AugSchemeMPL()
+                              .KeyGen(getRandomSeed())
+                              .GetG1Element()
+                              .Serialize());
+    }
+    const vector<Bytes> pkViews(pkBytes.begin(), pkBytes.end());
+    const vector<G1Element> pks = G1Element::FromBytesBatch(pkViews);
+
+    // Every code path must produce the same results
+    const int all = BLS::CPU_ADX | BLS::CPU_SHA | BLS::CPU_AVX512IFMA;
+    for (int features = 0; features <= all; features++) {
+        if ((features & ~supported) != 0) {
+            REQUIRE_THROWS(BLS::SetEnabledCpuFeatures(features));
+            continue;
+        }
+        BLS::SetEnabledCpuFeatures(features);
+        REQUIRE(BLS::GetEnabledCpuFeatures() == features);
+        REQUIRE(AugSchemeMPL().KeyGen(seed) == sk);
+        REQUIRE(AugSchemeMPL().Sign(sk, msg) == sig);
+        REQUIRE(AugSchemeMPL().Verify(sk.GetG1Element(), msg, sig));
+        vector<uint8_t> hash2(32);
+        Util::Hash256(hash2.data(), msg.data(), msg.size());
+        REQUIRE(hash2 == hash);
+        REQUIRE(G1Element::FromBytesBatch(pkViews) == pks);
+    }
+
+    BLS::SetEnabledCpuFeatures(enabled);
+    REQUIRE(BLS::GetEnabledCpuFeatures() == enabled);
+}
+
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__BLST_NO_ASM__)
+extern "C" int __blst_platform_cap;
+#endif
+
+// Run by the test below, in a process started with BLS_CPU_FEATURES set
+TEST_CASE("CPU features from the environment", "[.cpu-env]")
+{
+    const char* spec = std::getenv("BLS_CPU_FEATURES");
+    REQUIRE(spec != nullptr);
+    int expected = 0;
+    if (std::string(spec).find("adx") != std::string::npos) {
+        expected |= BLS::CPU_ADX;
+    }
+    if (std::string(spec).find("sha") != std::string::npos) {
+        expected |= BLS::CPU_SHA;
+    }
+    if (std::string(spec).find("ifma") != std::string::npos) {
+        expected |= BLS::CPU_AVX512IFMA;
+    }
+    expected &= BLS::GetCpuFeatures();
+
+    // The first use applies the override, whenever blst detected the CPU
+    PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+    vector<uint8_t> msg = {1, 2, 3};
+    REQUIRE(AugSchemeMPL().Verify(
+        sk.GetG1Element(), msg, AugSchemeMPL().Sign(sk, msg)));
+#if (defined(__x86_64__) || defined(_M_X64)) && !defined(__BLST_NO_ASM__)
+    const int blstFeatures = BLS::CPU_ADX | BLS::CPU_SHA;
+    REQUIRE((__blst_platform_cap & blstFeatures) == (expected & blstFeatures));
+#endif
+    REQUIRE(BLS::GetEnabledCpuFeatures() == expected);
+}
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+TEST_CASE("CPU feature environment override")
+{
+    REQUIRE(testBinary != nullptr);
+    for (const char* spec : {"none", "adx", "sha", "adx,sha", "ifma"}) {
+        const std::string command = std::string("BLS_CPU_FEATURES=") + spec +
+                                    " '" + testBinary +
+                                    "' '[cpu-env]' > /dev/null";
+        REQUIRE(std::system(command.c_str()) == 0);
+    }
+}
+#endif
+
+TEST_CASE("Allocation free aggregate verification")
+{
+    vector<vector<uint8_t>> pkBytes, msgBytes;
+    vector<G2Element> basicSigs, popSigs, augSigs;
+    for (uint8_t i = 0; i < 8; i++) {
+        PrivateKey sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+        pkBytes.push_back(sk.GetG1Element().Serialize());
+        msgBytes.push_back({i, 1, 2, 3});
+        basicSigs.push_back(BasicSchemeMPL().Sign(sk, msgBytes.back()));
+        popSigs.push_back(PopSchemeMPL().Sign(sk, msgBytes.back()));
+        augSigs.push_back(AugSchemeMPL().Sign(sk, msgBytes.back()));
+    }
+    const vector<Bytes> pks(pkBytes.begin(), pkBytes.end());
+    const vector<Bytes> msgs(msgBytes.begin(), msgBytes.end());
+    const vector<uint8_t> basicSigBytes =
+        BasicSchemeMPL().Aggregate(basicSigs).Serialize();
+    const vector<uint8_t> popSigBytes =
+        PopSchemeMPL().Aggregate(popSigs).Serialize();
+    const vector<uint8_t> augSigBytes =
+        AugSchemeMPL().Aggregate(augSigs).Serialize();
+    const Bytes basicSig(basicSigBytes), popSig(popSigBytes);
+    const Bytes augSig(augSigBytes);
+
+    // The first calls fill the per thread pairing pool and scratch buffers
+    REQUIRE(BasicSchemeMPL().AggregateVerify(pks, msgs, basicSig));
+    REQUIRE(PopSchemeMPL().AggregateVerify(pks, msgs, popSig));
+    REQUIRE(AugSchemeMPL().AggregateVerify(pks, msgs, augSig));
+
+    const size_t nBefore = nAllocations;
+    const bool fBasic = BasicSchemeMPL().AggregateVerify(pks, msgs, basicSig);
+    const bool fPop = PopSchemeMPL().AggregateVerify(pks, msgs, popSig);
+    const bool fAug = AugSchemeMPL().AggregateVerify(pks, msgs, augSig);
+    const bool fAugAsBasic =
+        AugSchemeMPL().AggregateVerify(pks, msgs, basicSig);
+    const bool fWrongScheme =
+        BasicSchemeMPL().AggregateVerify(pks, msgs, popSig);
+    const size_t nAfter = nAllocations;
+
+    REQUIRE(fBasic);
+    REQUIRE(fPop);
+    REQUIRE(fAug);
+    REQUIRE(!fAugAsBasic);
+    REQUIRE(!fWrongScheme);
+    REQUIRE(nAfter == nBefore);
+
+    vector<vector<uint8_t>> dupMsgBytes(msgBytes);
+    dupMsgBytes[5] = dupMsgBytes[2];
+    const vector<Bytes> dupMsgs(dupMsgBytes.begin(), dupMsgBytes.end());
+    REQUIRE(!BasicSchemeMPL().AggregateVerify(pks, dupMsgs, basicSig));
+}
+
+TEST_CASE("Batched hash to G2")
+{
+    const uint8_t* dst = (const uint8_t*)BasicSchemeMPL::CIPHERSUITE_ID.c_str();
+    const int dst_len = BasicSchemeMPL::CIPHERSUITE_ID.length();
+    vector<vector<uint8_t>> msgs;
+    for (uint8_t i = 0; i < 50; i++) {
+        msgs.push_back(vector<uint8_t>(i, i));
+    }
+
+    const vector<G2Element> parallel =
+        G2Element::FromMessages(msgs, dst, dst_len);
+    const vector<G2Element> serial =
+        G2Element::FromMessages(msgs, dst, dst_len, false);
+    REQUIRE(parallel.size() == msgs.size());
+    for (size_t i = 0; i < msgs.size(); i++) {
+        const G2Element expected =
+            G2Element::FromMessage(msgs[i], dst, dst_len);
+        REQUIRE(parallel[i] == expected);
+        REQUIRE(serial[i] == expected);
+        REQUIRE(parallel[i].Serialize() == expected.Serialize());
+        REQUIRE(parallel[i].IsValid());
+    }
+    REQUIRE(G2Element::FromMessages(vector<Bytes>(), dst, dst_len).empty());
+
+    // Signing over the hashed point agrees with Sign
+    PrivateKey sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+    REQUIRE(sk * parallel[7] == BasicSchemeMPL().Sign(sk, msgs[7]));
+}
+
+TEST_CASE("Batch deserialization and validation")
+{
+    vector<vector<uint8_t>> g1Bytes, g2Bytes;
+    vector<G1Element> g1s;
+    vector<G2Element> g2s;
+    for (int i = 0; i < 50; i++) {
+        PrivateKey sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+        g1s.push_back(sk.GetG1Element());
+        g2s.push_back(sk.GetG2Element());
+        g1Bytes.push_back(g1s.back().Serialize());
+        g2Bytes.push_back(g2s.back().Serialize());
+    }
+    g1Bytes.push_back(G1Element().Serialize());
+    g1s.push_back(G1Element());
+
+    // The parallel path must agree with the serial one
+    for (bool fParallel : {false, true}) {
+        REQUIRE(
+            G1Element::FromBytesBatch(
+                {g1Bytes.begin(), g1Bytes.end()}, fParallel) == g1s);
+        REQUIRE(
+            G2Element::FromBytesBatch(
+                {g2Bytes.begin(), g2Bytes.end()}, fParallel) == g2s);
+        REQUIRE(G1Element::AllValid(g1s, fParallel));
+        REQUIRE(G2Element::AllValid(g2s, fParallel));
+        REQUIRE(G1Element::FromBytesBatch({}, fParallel).empty());
+        REQUIRE(G1Element::AllValid({}, fParallel));
+    }
+
+    // A point on the curve but outside the subgroup
+    const vector<uint8_t> badPoint = Util::HexToBytes(
+        "8d5d0fb73b9c92df4eab4216e48c3e358578b4cc30f82c268bd6fef3bd34b55862"
+        "8daf1afef798d4c3b0fcd8b28c8973");
+    vector<G1Element> badG1s(g1s);
+    badG1s[37] = G1Element::FromBytesUnchecked(Bytes(badPoint));
+    vector<vector<uint8_t>> badG1Bytes(g1Bytes);
+    badG1Bytes[37] = badPoint;
+    badG1Bytes[42] = vector<uint8_t>(G1Element::SIZE - 1, 0);
+    for (bool fParallel : {false, true}) {
+        REQUIRE(!G1Element::AllValid(badG1s, fParallel));
+        // The error of the lowest failing index is reported
+        string error;
+        try {
+            G1Element::FromBytesBatch(
+                {badG1Bytes.begin(), badG1Bytes.end()}, fParallel);
+        } catch (const std::invalid_argument& e) {
+            error = e.what();
+        }
+        REQUIRE(error == "G1 element is invalid");
+    }
+}
+
+// The message of FromBytes' exception, or "" if it returns elements
+static string FromBytesError(const vector<Bytes>& bytes, bool fBatch)
+{
+    try {
+        if (fBatch) {
+            G1Element::FromBytesBatch(bytes);
+        } else {
+            for (const Bytes& b : bytes) {
+                G1Element::FromBytes(b);
+            }
+        }
+    } catch (const std::invalid_argument& e) {
+        return e.what();
+    }
+    return "";
+}
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+TEST_CASE("Thread pool in a forked child")
+{
+    vector<vector<uint8_t>> g1Bytes;
+    vector<G1Element> g1s;
+    for (int i = 0; i < 16; i++) {
+        g1s.push_back(
+            BasicSchemeMPL().KeyGen(getRandomSeed()).GetG1Element());
+        g1Bytes.push_back(g1s.back().Serialize());
+    }
+    std::atomic<size_t> nDone{0};
+    ThreadPool::Default().ParallelFor(
+        64, [&](size_t, size_t begin, size_t end) { nDone += end - begin; });
+    REQUIRE(nDone == 64);
+
+    const pid_t pid = fork();
+    REQUIRE(pid >= 0);
+    if (pid == 0) {
+        // A hang in the child fails the test instead of stalling it
+        alarm(30);
+        bool fOk = true;
+        try {
+            std::atomic<size_t> nChild{0};
+            ThreadPool::Default().ParallelFor(
+                64, [&](size_t, size_t begin, size_t end) {
+                    nChild += end - begin;
+                });
+            fOk = nChild == 64 &&
+                  G1Element::FromBytesBatch(
+                      {g1Bytes.begin(), g1Bytes.end()}, true) == g1s;
+        } catch (...) {
+            fOk = false;
+        }
+        _exit(fOk ? 0 : 1);
+    }
+    int status = 0;
+    REQUIRE(waitpid(pid, &status, 0) == pid);
+    REQUIRE(WIFEXITED(status));
+    REQUIRE(WEXITSTATUS(status) == 0);
+}
+#endif
+
+TEST_CASE("Field backends")
+{
+    // Random field elements, about half of them squares, and edge cases
+    vector<vector<uint8_t>> encoded = {
+        vector<uint8_t>(48, 0), vector<uint8_t>(48, 0)};
+    encoded[1][47] = 1;
+    for (int i = 0; i < 64; i++) {
+        vector<uint8_t> seed = getRandomSeed();
+        vector<uint8_t> bytes(seed.begin(), seed.end());
+        bytes.insert(bytes.end(), seed.begin(), seed.begin() + 16);
+        bytes[0] &= 0x0f;
+        encoded.push_back(bytes);
+    }
+    const size_t n = encoded.size();
+    vector<blst_fp> values(n);
+    for (size_t i = 0; i < n; i++) {
+        blst_fp_from_bendian(&values[i], encoded[i].data());
+    }
+    auto equal = [](const blst_fp& a, const blst_fp& b) {
+        uint8_t x[48], y[48];
+        blst_bendian_from_fp(x, &a);
+        blst_bendian_from_fp(y, &b);
+        return memcmp(x, y, sizeof(x)) == 0;
+    };
+
+    REQUIRE(FpHasBackend(FP_BLST));
+    const FpBackend automatic = FpDefaultBackend();
+    REQUIRE(automatic != FP_AUTO);
+    REQUIRE(FpHasBackend(automatic));
+    REQUIRE(FpHasBackend(FP_IFMA) ==
+            ((BLS::GetCpuFeatures() & BLS::CPU_AVX512IFMA) != 0));
+    for (FpBackend backend : {FP_BLST, FP_IFMA}) {
+        if (!FpHasBackend(backend)) {
+            REQUIRE_THROWS(FpSetDefaultBackend(backend));
+            REQUIRE_THROWS(G1Element::FromBytesBatch({}, false, backend));
+            REQUIRE_THROWS(G2Element::FromBytesBatch({}, false, backend));
+            REQUIRE_THROWS(G1Element::AllValid({}, false, backend));
+            REQUIRE_THROWS(G2Element::AllValid({}, false, backend));
+            continue;
+        }
+
+        // Cross checked against blst's scalar field code. n is not a
+        // multiple of eight, so FP_IFMA also runs with unused lanes.
+        for (size_t i = 0; i < n; i++) {
+            blst_fp product, expected;
+            FpMul(product, values[i], values[(i * 7) % n], backend);
+            blst_fp_mul(&expected, &values[i], &values[(i * 7) % n]);
+            REQUIRE(equal(product, expected));
+        }
+        vector<blst_fp> roots(n);
+        std::unique_ptr<bool[]> fRoots(new bool[n]);
+        FpSqrtBatch(roots.data(), fRoots.get(), values.data(), n, backend);
+        size_t nRoots = 0;
+        for (size_t i = 0; i < n; i++) {
+            blst_fp expected, square;
+            REQUIRE(fRoots[i] == blst_fp_sqrt(&expected, &values[i]));
+            if (fRoots[i]) {
+                blst_fp_sqr(&square, &roots[i]);
+                REQUIRE(equal(square, values[i]));
+                nRoots++;
+            }
+        }
+        REQUIRE(nRoots > 2);
+        REQUIRE(nRoots < n);
+        vector<blst_fp> inPlace = values;
+        FpSqrtBatch(inPlace.data(), fRoots.get(), inPlace.data(), n, backend);
+        for (size_t i = 0; i < n; i++) {
+            REQUIRE((!fRoots[i] || equal(inPlace[i], roots[i])));
+        }
+
+        // Batch G1 decompression on the backend matches FromBytes
+        FpSetDefaultBackend(backend);
+        REQUIRE(FpDefaultBackend() == backend);
+        vector<vector<uint8_t>> points;
+        for (int i = 0; i < 16; i++) {
+            points.push_back(PrivateKey::FromByteVector(getRandomSeed(), true)
+                                 .GetG1Element()
+                                 .Serialize());
+            // The other root, for the negated point
+            points.push_back(points.back());
+            points.back()[0] ^= 0x20;
+        }
+        points.push_back(G1Element().Serialize());
+        const vector<Bytes> views(points.begin(), points.end());
+        for (bool fParallel : {false, true}) {
+            vector<G1Element> batch =
+                G1Element::FromBytesBatch(views, fParallel);
+            REQUIRE(batch.size() == views.size());
+            for (size_t i = 0; i < views.size(); i++) {
+                REQUIRE(batch[i] == G1Element::FromBytes(views[i]));
+            }
+            REQUIRE(G1Element::AllValid(batch, fParallel, backend));
+        }
+
+        // Or passed to the call, whatever the default
+        FpSetDefaultBackend(FP_BLST);
+        vector<G1Element> batch =
+            G1Element::FromBytesBatch(views, true, backend);
+        for (size_t i = 0; i < views.size(); i++) {
+            REQUIRE(batch[i] == G1Element::FromBytes(views[i]));
+        }
+        FpSetDefaultBackend(backend);
+        for (size_t i = 2; i < n; i++) {
+            // Arbitrary x coordinates: off the curve, or not in G1
+            vector<uint8_t> bytes = encoded[i];
+            bytes[0] |= 0x80 | (i & 1 ? 0x20 : 0);
+            const vector<Bytes> single = {Bytes(bytes)};
+            REQUIRE(
+                FromBytesError(single, true) == FromBytesError(single, false));
+            REQUIRE(!FromBytesError(single, true).empty());
+        }
+        vector<Bytes> bad;
+        for (size_t i = 0; i < views.size(); i++) {
+            bad.push_back(i == 5 ? Bytes(encoded[3]) : views[i]);
+        }
+        REQUIRE(FromBytesError(bad, true) == FromBytesError(bad, false));
+    }
+    FpSetDefaultBackend(FP_AUTO);
+    REQUIRE(FpDefaultBackend() == automatic);
+}
+
+TEST_CASE("Batch files")
+{
+    const string path =
+        "bls-test-batch-" + Util::HexStr(getRandomSeed().data(), 8);
+
+    vector<vector<uint8_t>> pks, msgs, sigs;
+    BatchFileWriter writer;
+    for (uint8_t i = 0; i < 20; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        msgs.push_back(vector<uint8_t>(i % 7, i));
+        pks.push_back(sk.GetG1Element().Serialize());
+        sigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()).Serialize());
+        writer.Add(pks.back(), msgs.back(), sigs.back());
+    }
+    REQUIRE(writer.Size() == 20);
+    REQUIRE_THROWS(writer.Add(msgs[3], msgs[3], sigs[3]));
+    writer.Write(path);
+
+    {
+        BatchFileReader reader(path);
+        REQUIRE(reader.Size() == 20);
+        REQUIRE(reader.PubKeySize() == G1Element::SIZE);
+        for (size_t i = 0; i < reader.Size(); i++) {
+            REQUIRE(vector<uint8_t>(
+                        reader.Message(i).begin(), reader.Message(i).end()) ==
+                    msgs[i]);
+            REQUIRE(AugSchemeMPL().Verify(
+                reader.PubKey(i), reader.Message(i), reader.Signature(i)));
+        }
+        REQUIRE_THROWS(reader.PubKey(20));
+
+        // The views feed the Bytes overloads directly
+        const vector<Bytes> sigViews = reader.Signatures();
+        vector<G2Element> sigElements = G2Element::FromBytesBatch(sigViews);
+        const vector<uint8_t> aggSig =
+            AugSchemeMPL().Aggregate(sigElements).Serialize();
+        REQUIRE(AugSchemeMPL().AggregateVerify(
+            reader.PubKeys(), reader.Messages(), Bytes(aggSig)));
+    }
+
+    // Truncated or foreign files are rejected on open
+    vector<uint8_t> contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(
+            std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>());
+    }
+    for (size_t len : {size_t(0), size_t(63), contents.size() - 1}) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write((const char*)contents.data(), len);
+        REQUIRE_THROWS(BatchFileReader(path).Size());
+    }
+    contents[0] ^= 1;
+    std::ofstream(path, std::ios::binary | std::ios::trunc)
+        .write((const char*)contents.data(), contents.size());
+    REQUIRE_THROWS(BatchFileReader(path).Size());
+
+    BatchFileWriter().Write(path);
+    REQUIRE(BatchFileReader(path).Size() == 0);
+    std::remove(path.c_str());
+    REQUIRE_THROWS(BatchFileReader(path).Size());
+}
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+TEST_CASE("Verification daemon")
+{
+    const string path =
+        "/tmp/bls-test-" + Util::HexStr(getRandomSeed().data(), 6) + ".sock";
+    VerifyServer server(path, std::chrono::microseconds(20000), 64);
+    std::thread runner([&server] { server.Run(); });
+
+    vector<vector<uint8_t>> pks, msgs, sigs;
+    for (uint8_t i = 0; i < 16; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        pks.push_back(sk.GetG1Element().Serialize());
+        msgs.push_back({i, 1, 2});
+        sigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()).Serialize());
+    }
+    // A bad signature and one that is not a point
+    sigs[3] = sigs[4];
+    sigs[9][5] ^= 1;
+
+    // Pipelined requests share batches, and a failed batch is localized
+    VerifyClient client(path);
+    const vector<bool> results = client.VerifyMany(
+        VERIFY_AUG,
+        vector<Bytes>(pks.begin(), pks.end()),
+        vector<Bytes>(msgs.begin(), msgs.end()),
+        vector<Bytes>(sigs.begin(), sigs.end()));
+    for (size_t i = 0; i < results.size(); i++) {
+        REQUIRE(results[i] == (i != 3 && i != 9));
+    }
+    REQUIRE(server.Batches() < 16);
+    REQUIRE(server.FailedBatches() >= 1);
+
+    // Concurrent clients, and schemes don't mix
+    vector<uint8_t> fOk(4, 0);
+    vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            VerifyClient own(path);
+            const size_t i = t + 4;
+            fOk[t] = own.Verify(VERIFY_AUG, pks[i], msgs[i], sigs[i]) &&
+                     !own.Verify(VERIFY_BASIC, pks[i], msgs[i], sigs[i]);
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(fOk == vector<uint8_t>(4, 1));
+    REQUIRE_THROWS(client.Verify(VERIFY_AUG, msgs[0], msgs[0], sigs[0]));
+    REQUIRE(server.Requests() == 24);
+
+    // More pipelined requests than a connection may have in flight
+    const size_t nMany = VerifyServer::MAX_PENDING + 16;
+    vector<Bytes> manyPks, manyMsgs, manySigs;
+    for (size_t i = 0; i < nMany; i++) {
+        manyPks.push_back(Bytes(pks[i % 16]));
+        manyMsgs.push_back(Bytes(msgs[i % 16]));
+        manySigs.push_back(Bytes(sigs[i % 16]));
+    }
+    const vector<bool> many =
+        client.VerifyMany(VERIFY_AUG, manyPks, manyMsgs, manySigs);
+    REQUIRE(many.size() == nMany);
+    for (size_t i = 0; i < nMany; i++) {
+        REQUIRE(many[i] == (i % 16 != 3 && i % 16 != 9));
+    }
+
+    server.Stop();
+    runner.join();
+
+    // Files other than sockets are left alone
+    std::ofstream(path) << "not a socket";
+    REQUIRE_THROWS(VerifyServer(path, std::chrono::microseconds(2000)));
+    REQUIRE(std::ifstream(path).good());
+    std::remove(path.c_str());
+}
+#endif
+
+TEST_CASE("Verification scheduler")
+{
+    vector<vector<uint8_t>> pks, msgs, sigs;
+    for (uint8_t i = 0; i < 8; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        pks.push_back(sk.GetG1Element().Serialize());
+        msgs.push_back({i, 4});
+        sigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()).Serialize());
+    }
+
+    SECTION("Encoding pre-checks")
+    {
+        REQUIRE(G1Element::HasValidEncoding(pks[0]));
+        REQUIRE(G2Element::HasValidEncoding(sigs[0]));
+        REQUIRE(G1Element::HasValidEncoding(G1Element().Serialize()));
+        REQUIRE(G2Element::HasValidEncoding(G2Element().Serialize()));
+        REQUIRE(!G1Element::HasValidEncoding(sigs[0]));
+        vector<uint8_t> bad(pks[0]);
+        bad[0] &= 0x7f;  // uncompressed
+        REQUIRE(!G1Element::HasValidEncoding(bad));
+        bad = vector<uint8_t>(48, 0xff);
+        bad[0] = 0x9f;  // x >= p
+        REQUIRE(!G1Element::HasValidEncoding(bad));
+        bad = G2Element().Serialize();
+        bad[95] = 1;  // non canonical infinity
+        REQUIRE(!G2Element::HasValidEncoding(bad));
+        bad = G1Element().Serialize();
+        bad[0] = 0xc1;  // infinity with bits below the flags
+        REQUIRE(!G1Element::HasValidEncoding(bad));
+        bad = sigs[0];
+        memset(bad.data() + 48, 0xff, 48);  // second coordinate >= p
+        REQUIRE(!G2Element::HasValidEncoding(bad));
+    }
+
+    SECTION("Statuses")
+    {
+        VerifyScheduler scheduler;
+        vector<std::future<VerifyStatus>> results;
+        for (size_t i = 0; i < 8; i++) {
+            results.push_back(scheduler.Submit(
+                i % 2 ? PRIORITY_CONSENSUS : PRIORITY_BEST_EFFORT,
+                VERIFY_AUG,
+                pks[i],
+                msgs[i],
+                i == 3 ? sigs[4] : sigs[i]));
+        }
+        // Malformed, not in the subgroup, expired and the wrong scheme
+        vector<uint8_t> garbage(96, 0x55);
+        results.push_back(scheduler.Submit(
+            PRIORITY_BEST_EFFORT, VERIFY_AUG, pks[0], msgs[0], garbage));
+        vector<uint8_t> notInGroup(sigs[0]);
+        notInGroup[20] ^= 1;
+        results.push_back(scheduler.Submit(
+            PRIORITY_CONSENSUS, VERIFY_AUG, pks[0], msgs[0], notInGroup));
+        results.push_back(scheduler.Submit(
+            PRIORITY_CONSENSUS,
+            VERIFY_AUG,
+            pks[0],
+            msgs[0],
+            sigs[0],
+            VerifyScheduler::Clock::now() - std::chrono::seconds(1)));
+        results.push_back(scheduler.Submit(
+            PRIORITY_CONSENSUS, VERIFY_BASIC, pks[0], msgs[0], sigs[0]));
+
+        const vector<VerifyStatus> expected = {
+            VERIFY_VALID,
+            VERIFY_VALID,
+            VERIFY_VALID,
+            VERIFY_INVALID,
+            VERIFY_VALID,
+            VERIFY_VALID,
+            VERIFY_VALID,
+            VERIFY_VALID,
+            VERIFY_INVALID,
+            VERIFY_INVALID,
+            VERIFY_EXPIRED,
+            VERIFY_INVALID};
+        for (size_t i = 0; i < results.size(); i++) {
+            REQUIRE(results[i].get() == expected[i]);
+        }
+        REQUIRE(scheduler.Verified() == 9);
+        REQUIRE(scheduler.Malformed() == 2);
+        REQUIRE(scheduler.Expired() == 1);
+        REQUIRE(scheduler.Rejected() == 0);
+    }
+
+    SECTION("Bounded lanes")
+    {
+        // No best effort room at all, while consensus work goes through
+        VerifyScheduler scheduler({16, 4}, {0, 4});
+        std::future<VerifyStatus> bestEffort = scheduler.Submit(
+            PRIORITY_BEST_EFFORT, VERIFY_AUG, pks[0], msgs[0], sigs[0]);
+        std::future<VerifyStatus> consensus = scheduler.Submit(
+            PRIORITY_CONSENSUS, VERIFY_AUG, pks[0], msgs[0], sigs[0]);
+        REQUIRE(bestEffort.get() == VERIFY_REJECTED);
+        REQUIRE(consensus.get() == VERIFY_VALID);
+        REQUIRE(scheduler.Rejected() == 1);
+
+        // Queued requests are verified on Stop, later ones rejected
+        std::future<VerifyStatus> queued = scheduler.Submit(
+            PRIORITY_CONSENSUS, VERIFY_AUG, pks[1], msgs[1], sigs[1]);
+        scheduler.Stop();
+        REQUIRE(queued.get() == VERIFY_VALID);
+        std::future<VerifyStatus> late = scheduler.Submit(
+            PRIORITY_CONSENSUS, VERIFY_AUG, pks[2], msgs[2], sigs[2]);
+        REQUIRE(late.get() == VERIFY_REJECTED);
+        REQUIRE_THROWS(VerifyScheduler({16, 0}, {16, 4}).Verified());
+    }
+}
+
+TEST_CASE("Partial verification")
+{
+    vector<G1Element> pks;
+    vector<vector<uint8_t>> msgs;
+    vector<G2Element> sigs;
+    for (uint8_t i = 0; i < 12; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        pks.push_back(sk.GetG1Element());
+        msgs.push_back({i, 7, 7});
+        sigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()));
+    }
+    const G2Element aggSig = AugSchemeMPL().Aggregate(sigs);
+
+    // Workers compute slices and ship them serialized to the coordinator
+    vector<vector<uint8_t>> shipped(3);
+    vector<std::thread> workers;
+    for (size_t w = 0; w < 3; w++) {
+        workers.emplace_back([&, w] {
+            const vector<G1Element> slicePks(
+                pks.begin() + 4 * w, pks.begin() + 4 * (w + 1));
+            const vector<vector<uint8_t>> sliceMsgs(
+                msgs.begin() + 4 * w, msgs.begin() + 4 * (w + 1));
+            shipped[w] = AugSchemeMPL()
+                             .AggregateVerifyPartial(slicePks, sliceMsgs)
+                             .Serialize();
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    PartialVerification total(AugSchemeMPL::CIPHERSUITE_ID);
+    for (const vector<uint8_t>& bytes : shipped) {
+        total.Merge(PartialVerification::FromBytes(Bytes(bytes)));
+    }
+    REQUIRE(total.NumPairs() == 12);
+    REQUIRE(total.FinalVerify(aggSig));
+    REQUIRE(!total.FinalVerify(sigs[0]));
+    REQUIRE(!total.FinalVerify());
+
+    // Signatures can travel with the slices instead
+    PartialVerification withSigs = AugSchemeMPL().AggregateVerifyPartial(
+        vector<G1Element>(pks.begin(), pks.begin() + 6),
+        vector<vector<uint8_t>>(msgs.begin(), msgs.begin() + 6));
+    PartialVerification rest = AugSchemeMPL().AggregateVerifyPartial(
+        vector<G1Element>(pks.begin() + 6, pks.end()),
+        vector<vector<uint8_t>>(msgs.begin() + 6, msgs.end()));
+    withSigs.AddSignature(AugSchemeMPL().Aggregate(
+        vector<G2Element>(sigs.begin(), sigs.begin() + 6)));
+    rest.AddSignature(AugSchemeMPL().Aggregate(
+        vector<G2Element>(sigs.begin() + 6, sigs.end())));
+    withSigs.Merge(PartialVerification::FromBytes(Bytes(rest.Serialize())));
+    REQUIRE(withSigs.FinalVerify());
+
+    // Pairs that cancel out need no signature, and the infinity share
+    // has no Miller loop of its own
+    const vector<G1Element> cancelling = {pks[0], pks[0].Negate()};
+    const vector<vector<uint8_t>> same = {msgs[0], msgs[0]};
+    PartialVerification cancelled =
+        PopSchemeMPL().AggregateVerifyPartial(cancelling, same);
+    REQUIRE(cancelled.FinalVerify());
+    REQUIRE(cancelled.FinalVerify(G2Element()));
+    REQUIRE(!cancelled.FinalVerify(sigs[0]));
+
+    // Empty partials behave like AggregateVerify with no pairs
+    REQUIRE(PartialVerification(AugSchemeMPL::CIPHERSUITE_ID).FinalVerify());
+    REQUIRE(!PartialVerification(AugSchemeMPL::CIPHERSUITE_ID)
+                 .FinalVerify(sigs[0]));
+
+    // Ciphersuites don't mix, and broken encodings are rejected
+    PartialVerification basic(BasicSchemeMPL::CIPHERSUITE_ID);
+    REQUIRE_THROWS(total.Merge(basic));
+    vector<uint8_t> bytes = total.Serialize();
+    REQUIRE_THROWS(PartialVerification::FromBytes(
+        Bytes(bytes.data(), bytes.size() - 1)));
+    bytes[0] ^= 0xff;
+    REQUIRE_THROWS(PartialVerification::FromBytes(Bytes(bytes)));
+    REQUIRE_THROWS(BasicSchemeMPL().AggregateVerifyPartial(
+        {pks[0], pks[1]}, vector<vector<uint8_t>>{msgs[0], msgs[0]}));
+    REQUIRE_THROWS(AugSchemeMPL().AggregateVerifyPartial(
+        {pks[0], pks[1]}, vector<vector<uint8_t>>{msgs[0]}));
+
+    // Basic scheme messages must also be distinct across slices
+    PartialVerification first = BasicSchemeMPL().AggregateVerifyPartial(
+        {pks[0], pks[1]}, vector<vector<uint8_t>>{msgs[0], msgs[1]});
+    const PartialVerification second =
+        PartialVerification::FromBytes(Bytes(
+            BasicSchemeMPL()
+                .AggregateVerifyPartial(
+                    {pks[2], pks[3]},
+                    vector<vector<uint8_t>>{msgs[2], msgs[3]})
+                .Serialize()));
+    const PartialVerification repeat = BasicSchemeMPL().AggregateVerifyPartial(
+        {pks[4]}, vector<vector<uint8_t>>{msgs[1]});
+    REQUIRE_THROWS(first.Merge(repeat));
+    REQUIRE(first.NumPairs() == 2);
+    first.Merge(second);
+    REQUIRE(first.NumPairs() == 4);
+    const G2Element hash = G2Element::FromMessage(
+        msgs[3],
+        (const uint8_t*)BasicSchemeMPL::CIPHERSUITE_ID.c_str(),
+        BasicSchemeMPL::CIPHERSUITE_ID.length());
+    REQUIRE_THROWS(first.AddPair(pks[5], hash));
+
+    // Aug partials may repeat messages
+    PartialVerification augFirst = AugSchemeMPL().AggregateVerifyPartial(
+        {pks[0]}, vector<vector<uint8_t>>{msgs[0]});
+    augFirst.Merge(AugSchemeMPL().AggregateVerifyPartial(
+        {pks[1]}, vector<vector<uint8_t>>{msgs[0]}));
+    REQUIRE(augFirst.NumPairs() == 2);
+}
+
+#if defined(BLS_COROUTINES) && BLS_COROUTINES
+// Starts eagerly and runs to completion, for driving awaitables in tests
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static DetachedTask VerifyAsync(
+    const vector<G1Element>& pks,
+    const vector<vector<uint8_t>>& msgs,
+    const G2Element& aggSig,
+    const PrivateKey& sk,
+    Executor executor,
+    std::promise<vector<uint8_t>>& done)
+{
+    AugSchemeMPL aug;
+    vector<uint8_t> results;
+    results.push_back(
+        co_await AsyncAggregateVerify(aug, pks, msgs, aggSig, executor));
+    const vector<vector<G1Element>> batchPks = {pks, pks};
+    const vector<vector<vector<uint8_t>>> batchMsgs = {msgs, msgs};
+    const vector<G2Element> batchSigs = {aggSig, aggSig + aggSig};
+    results.push_back(co_await AsyncAggregateVerifyBatch(
+        aug, batchPks, batchMsgs, batchSigs, executor));
+    const vector<bool> each = co_await AsyncAggregateVerifyBatchEach(
+        aug, batchPks, batchMsgs, batchSigs, executor);
+    results.insert(results.end(), each.begin(), each.end());
+
+    const vector<uint8_t> pkBytes = pks[0].Serialize();
+    const vector<Bytes> pkViews = {Bytes(pkBytes), Bytes(pkBytes)};
+    const vector<G1Element> decoded =
+        co_await AsyncFromBytesBatch<G1Element>(pkViews, executor);
+    results.push_back(decoded[1] == pks[0]);
+    const G2Element sig = co_await AsyncSign(aug, sk, msgs[0], executor);
+    results.push_back(aug.Verify(pks[0], msgs[0], sig));
+
+    // Exceptions reach the coroutine
+    vector<uint8_t> bad(pkBytes);
+    bad[0] ^= 0x40;
+    const vector<Bytes> badViews = {Bytes(bad)};
+    try {
+        co_await AsyncFromBytesBatch<G1Element>(badViews, executor);
+        results.push_back(0);
+    } catch (const std::exception&) {
+        results.push_back(1);
+    }
+    done.set_value(results);
+}
+
+TEST_CASE("Coroutine API")
+{
+    vector<G1Element> pks;
+    vector<vector<uint8_t>> msgs;
+    vector<G2Element> sigs;
+    PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+    for (uint8_t i = 0; i < 3; i++) {
+        PrivateKey other = AugSchemeMPL().KeyGen(getRandomSeed());
+        pks.push_back(i == 0 ? sk.GetG1Element() : other.GetG1Element());
+        msgs.push_back({i, 3});
+        sigs.push_back(AugSchemeMPL().Sign(i == 0 ? sk : other, msgs.back()));
+    }
+    const G2Element aggSig = AugSchemeMPL().Aggregate(sigs);
+    const vector<uint8_t> expected = {1, 0, 1, 0, 1, 1, 1};
+
+    SECTION("Default pool")
+    {
+        std::promise<vector<uint8_t>> done;
+        VerifyAsync(pks, msgs, aggSig, sk, DefaultExecutor(), done);
+        REQUIRE(done.get_future().get() == expected);
+    }
+
+    SECTION("User executors")
+    {
+        // One that runs tasks inline, so nothing suspends
+        std::promise<vector<uint8_t>> inlineDone;
+        VerifyAsync(
+            pks,
+            msgs,
+            aggSig,
+            sk,
+            [](std::function<void()> task) { task(); },
+            inlineDone);
+        REQUIRE(inlineDone.get_future().get() == expected);
+
+        ThreadPool pool(2);
+        std::atomic<int> nPosted{0};
+        std::promise<vector<uint8_t>> poolDone;
+        VerifyAsync(
+            pks,
+            msgs,
+            aggSig,
+            sk,
+            [&](std::function<void()> task) {
+                nPosted++;
+                pool.Submit(std::move(task));
+            },
+            poolDone);
+        REQUIRE(poolDone.get_future().get() == expected);
+        REQUIRE(nPosted == 6);
+    }
+}
+#endif
+
+TEST_CASE("Signature cache")
+{
+    SECTION("Bounded and keyed by the whole tuple")
+    {
+        SignatureCache cache(2);
+        const string suite = AugSchemeMPL::CIPHERSUITE_ID;
+        const vector<uint8_t> pk(48, 1), msg = {1, 2, 3}, sig(96, 2);
+        const vector<uint8_t> otherMsg = {1, 2, 4}, thirdMsg = {9};
+
+        REQUIRE(!cache.Contains(suite, pk, msg, sig));
+        cache.Insert(suite, pk, msg, sig);
+        cache.Insert(suite, pk, msg, sig);
+        REQUIRE(cache.Size() == 1);
+        REQUIRE(cache.Contains(suite, pk, msg, sig));
+        REQUIRE(!cache.Contains(suite, pk, otherMsg, sig));
+        REQUIRE(!cache.Contains(BasicSchemeMPL::CIPHERSUITE_ID, pk, msg, sig));
+        REQUIRE(cache.Hits() == 1);
+        REQUIRE(cache.Misses() == 3);
+
+        // The oldest entry is evicted first
+        cache.Insert(suite, pk, otherMsg, sig);
+        cache.Insert(suite, pk, thirdMsg, sig);
+        REQUIRE(cache.Size() == 2);
+        REQUIRE(!cache.Contains(suite, pk, msg, sig));
+        REQUIRE(cache.Contains(suite, pk, otherMsg, sig));
+
+        cache.Clear();
+        REQUIRE(cache.Size() == 0);
+        REQUIRE(!cache.Contains(suite, pk, otherMsg, sig));
+    }
+
+    SECTION("Consulted by Verify")
+    {
+        auto cache = std::make_shared<SignatureCache>(100);
+        SignatureCache::SetGlobal(cache);
+
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        G1Element pk = sk.GetG1Element();
+        vector<uint8_t> msg = {7, 8, 9};
+        G2Element sig = AugSchemeMPL().Sign(sk, msg);
+
+        REQUIRE(AugSchemeMPL().Verify(pk, msg, sig));
+        REQUIRE(cache->Misses() == 1);
+        REQUIRE(cache->Size() == 1);
+        REQUIRE(AugSchemeMPL().Verify(pk, msg, sig));
+        REQUIRE(
+            AugSchemeMPL().Verify(pk.Serialize(), msg, sig.Serialize()));
+        REQUIRE(cache->Hits() == 2);
+
+        // Failures are not recorded, nor do other schemes hit
+        REQUIRE(!AugSchemeMPL().Verify(pk, vector<uint8_t>{7, 8}, sig));
+        REQUIRE(!BasicSchemeMPL().Verify(pk, msg, sig));
+        REQUIRE(cache->Size() == 1);
+
+        G2Element basicSig = BasicSchemeMPL().Sign(sk, msg);
+        REQUIRE(BasicSchemeMPL().Verify(pk, msg, basicSig));
+        REQUIRE(cache->Size() == 2);
+
+        SignatureCache::SetGlobal(nullptr);
+        REQUIRE(AugSchemeMPL().Verify(pk, msg, sig));
+        REQUIRE(cache->Hits() == 2);
+    }
+}
+
+TEST_CASE("Pairing cache")
+{
+    PairingCache cache(100);
+    vector<G1Element> pks;
+    vector<vector<uint8_t>> msgs;
+    vector<G2Element> augSigs, basicSigs;
+    for (uint8_t i = 0; i < 10; i++) {
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        pks.push_back(sk.GetG1Element());
+        msgs.push_back({i, 4, 2});
+        augSigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()));
+        basicSigs.push_back(BasicSchemeMPL().Sign(sk, msgs.back()));
+    }
+
+    // A "mempool" sees the first 6 pairs, the "block" then has all 10
+    vector<G1Element> poolPks(pks.begin(), pks.begin() + 6);
+    vector<vector<uint8_t>> poolMsgs(msgs.begin(), msgs.begin() + 6);
+    G2Element poolSig = AugSchemeMPL().Aggregate(
+        vector<G2Element>(augSigs.begin(), augSigs.begin() + 6));
+    REQUIRE(AugSchemeMPL().AggregateVerifyCached(
+        poolPks, poolMsgs, poolSig, cache));
+    REQUIRE(cache.Misses() == 6);
+    REQUIRE(cache.Size() == 6);
+
+    G2Element blockSig = AugSchemeMPL().Aggregate(augSigs);
+    REQUIRE(AugSchemeMPL().AggregateVerifyCached(pks, msgs, blockSig, cache));
+    REQUIRE(cache.Hits() == 6);
+    REQUIRE(cache.Misses() == 10);
+    REQUIRE(cache.Size() == 10);
+    REQUIRE(AugSchemeMPL().AggregateVerify(pks, msgs, blockSig));
+
+    // Cached pairs don't make wrong signatures or messages pass
+    REQUIRE(!AugSchemeMPL().AggregateVerifyCached(pks, msgs, poolSig, cache));
+    vector<vector<uint8_t>> badMsgs(msgs);
+    badMsgs[3] = {0};
+    REQUIRE(
+        !AugSchemeMPL().AggregateVerifyCached(pks, badMsgs, blockSig, cache));
+
+    // Entries are per ciphersuite
+    G2Element basicSig = BasicSchemeMPL().Aggregate(basicSigs);
+    REQUIRE(
+        BasicSchemeMPL().AggregateVerifyCached(pks, msgs, basicSig, cache));
+    REQUIRE(
+        !BasicSchemeMPL().AggregateVerifyCached(pks, msgs, blockSig, cache));
+    REQUIRE(cache.Size() == 21);
+
+    vector<vector<uint8_t>> dupMsgs(msgs);
+    dupMsgs[1] = dupMsgs[0];
+    REQUIRE(
+        !BasicSchemeMPL().AggregateVerifyCached(pks, dupMsgs, basicSig, cache));
+    REQUIRE(BasicSchemeMPL().AggregateVerifyCached(
+        vector<G1Element>(), vector<Bytes>(), G2Element(), cache));
+
+    PairingCache small(4);
+    REQUIRE(AugSchemeMPL().AggregateVerifyCached(pks, msgs, blockSig, small));
+    REQUIRE(small.Size() == 4);
+
+    // Keys that cancel out verify under the infinity signature, which has
+    // no Miller loop of its own
+    const vector<G1Element> cancelling = {pks[0], pks[0].Negate()};
+    const vector<vector<uint8_t>> same = {msgs[0], msgs[0]};
+    REQUIRE(PopSchemeMPL().AggregateVerifyCached(
+        cancelling, same, G2Element(), cache));
+    REQUIRE(!PopSchemeMPL().AggregateVerifyCached(
+        cancelling, same, augSigs[0], cache));
+}
+
+TEST_CASE("Cache snapshots")
+{
+    const string path =
+        "bls-test-snapshot-" + Util::HexStr(getRandomSeed().data(), 8);
+    const vector<uint8_t> authKey(32, 0x5a), otherKey(32, 0xa5);
+    const string suite = AugSchemeMPL::CIPHERSUITE_ID;
+    const vector<uint8_t> pk(48, 1), sig(96, 2);
+
+    SECTION("Signature cache round trip")
+    {
+        SignatureCache cache(10);
+        for (uint8_t i = 0; i < 5; i++) {
+            cache.Insert(suite, pk, vector<uint8_t>{i}, sig);
+        }
+        cache.Save(path, authKey);
+
+        SignatureCache restored(3);
+        REQUIRE(restored.Load(path, authKey));
+        REQUIRE(restored.Size() == 3);
+        REQUIRE(restored.Contains(suite, pk, vector<uint8_t>{4}, sig));
+        REQUIRE(restored.Contains(suite, pk, vector<uint8_t>{2}, sig));
+        REQUIRE(!restored.Contains(suite, pk, vector<uint8_t>{1}, sig));
+
+        // Wrong keys, kinds and corrupt files are rejected untouched
+        SignatureCache other(10);
+        other.Insert(suite, pk, vector<uint8_t>{9}, sig);
+        REQUIRE(!other.Load(path, otherKey));
+        REQUIRE(!PairingCache(10).Load(path, authKey));
+        {
+            std::fstream file(path, std::ios::in | std::ios::out |
+                                        std::ios::binary);
+            file.seekp(70);
+            file.put(0x42);
+        }
+        REQUIRE(!other.Load(path, authKey));
+        REQUIRE(other.Contains(suite, pk, vector<uint8_t>{9}, sig));
+        REQUIRE(!other.Load(path + ".missing", authKey));
+        REQUIRE_THROWS(cache.Save(path, vector<uint8_t>(8, 1)));
+    }
+
+    SECTION("Pairing cache round trip")
+    {
+        PairingCache cache(20);
+        vector<G1Element> pks;
+        vector<vector<uint8_t>> msgs;
+        vector<G2Element> sigs;
+        for (uint8_t i = 0; i < 5; i++) {
+            PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+            pks.push_back(sk.GetG1Element());
+            msgs.push_back({i, 7});
+            sigs.push_back(AugSchemeMPL().Sign(sk, msgs.back()));
+        }
+        G2Element aggSig = AugSchemeMPL().Aggregate(sigs);
+        REQUIRE(
+            AugSchemeMPL().AggregateVerifyCached(pks, msgs, aggSig, cache));
+        cache.Save(path, authKey);
+
+        PairingCache restored(20);
+        REQUIRE(restored.Load(path, authKey));
+        REQUIRE(restored.Size() == 5);
+        REQUIRE(AugSchemeMPL().AggregateVerifyCached(
+            pks, msgs, aggSig, restored));
+        REQUIRE(restored.Hits() == 5);
+        REQUIRE(restored.Misses() == 0);
+        REQUIRE(!AugSchemeMPL().AggregateVerifyCached(
+            pks, msgs, sigs[0], restored));
+    }
+
+    std::remove(path.c_str());
+}
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+TEST_CASE("Shared memory signature cache")
+{
+    vector<uint8_t> seed = getRandomSeed();
+    const string name = "/bls-test-" + Util::HexStr(seed.data(), 8);
+    const string suite = AugSchemeMPL::CIPHERSUITE_ID;
+    const vector<uint8_t> pk(48, 1), msg = {1, 2, 3}, sig(96, 2);
+
+    SECTION("Mappings of one name share entries")
+    {
+        SharedSignatureCache first(name, 100);
+        SharedSignatureCache second(name, 5);
+        REQUIRE(first.Capacity() == 128);
+        REQUIRE(second.Capacity() == 128);
+
+        REQUIRE(!second.Contains(suite, pk, msg, sig));
+        first.Insert(suite, pk, msg, sig);
+        first.Insert(suite, pk, msg, sig);
+        REQUIRE(second.Size() == 1);
+        REQUIRE(second.Contains(suite, pk, msg, sig));
+        REQUIRE(!second.Contains(suite, pk, vector<uint8_t>{1, 2}, sig));
+        REQUIRE(second.Hits() == 1);
+        REQUIRE(second.Misses() == 2);
+        REQUIRE(first.Hits() == 0);
+
+        // The table is fixed size and overwrites when full
+        for (uint8_t i = 0; i < 255; i++) {
+            first.Insert(suite, pk, vector<uint8_t>{i}, sig);
+        }
+        REQUIRE(first.Size() <= first.Capacity());
+    }
+
+    SECTION("Consulted by Verify from other threads")
+    {
+        auto cache = std::make_shared<SharedSignatureCache>(name, 64);
+        SignatureCache::SetGlobal(cache);
+
+        PrivateKey sk = AugSchemeMPL().KeyGen(getRandomSeed());
+        G1Element pk1 = sk.GetG1Element();
+        G2Element sig1 = AugSchemeMPL().Sign(sk, msg);
+        bool fValid = false;
+        std::thread([&] {
+            fValid = AugSchemeMPL().Verify(pk1, msg, sig1);
+        }).join();
+        REQUIRE(fValid);
+        REQUIRE(cache->Size() == 1);
+        REQUIRE(AugSchemeMPL().Verify(pk1, msg, sig1));
+        REQUIRE(cache->Hits() == 1);
+        SignatureCache::SetGlobal(nullptr);
+    }
+
+    SECTION("Invalid arguments")
+    {
+        REQUIRE_THROWS(SharedSignatureCache(name, 0));
+        REQUIRE_THROWS(SharedSignatureCache("/a/b", 8));
+    }
+
+    SharedSignatureCache::Unlink(name);
+    REQUIRE(!SharedSignatureCache::Unlink(name));
+}
+#endif
+
+TEST_CASE("Min signature size schemes")
+{
+    SECTION("Basic Scheme")
+    {
+        vector<uint8_t> seed1(32, 0x04);
+        vector<uint8_t> seed2(32, 0x05);
+        vector<uint8_t> msg1 = {7, 8, 9};
+        vector<uint8_t> msg2 = {10, 11, 12};
+        vector<vector<uint8_t>> msgs = {msg1, msg2};
+
+        PrivateKey sk1 = BasicSchemeMSL().KeyGen(seed1);
+        G2Element pk1 = BasicSchemeMSL().SkToG2(sk1);
+        vector<uint8_t> pk1v = BasicSchemeMSL().SkToPk(sk1);
+        G1Element sig1 = BasicSchemeMSL().Sign(sk1, msg1);
+        vector<uint8_t> sig1v = BasicSchemeMSL().Sign(sk1, msg1).Serialize();
+
+        REQUIRE(pk1v.size() == G2Element::SIZE);
+        REQUIRE(sig1v.size() == G1Element::SIZE);
+        REQUIRE(BasicSchemeMSL().Verify(pk1, msg1, sig1));
+        REQUIRE(BasicSchemeMSL().Verify(pk1v, msg1, sig1v));
+
+        // e(sig, g2) == e(H(m), pk)
+        G1Element hash1 = G1Element::FromMessage(
+            msg1,
+            (const uint8_t*)BasicSchemeMSL::CIPHERSUITE_ID.c_str(),
+            BasicSchemeMSL::CIPHERSUITE_ID.length());
+        REQUIRE(sig1.Pair(G2Element::Generator()) == hash1.Pair(pk1));
+
+        PrivateKey sk2 = BasicSchemeMSL().KeyGen(seed2);
+        G2Element pk2 = BasicSchemeMSL().SkToG2(sk2);
+        vector<uint8_t> pk2v = BasicSchemeMSL().SkToPk(sk2);
+        G1Element sig2 = BasicSchemeMSL().Sign(sk2, msg2);
+        vector<uint8_t> sig2v = BasicSchemeMSL().Sign(sk2, msg2).Serialize();
+
+        // Wrong G1Element
+        REQUIRE(BasicSchemeMSL().Verify(pk1, msg1, sig2) == false);
+        REQUIRE(BasicSchemeMSL().Verify(pk1v, msg1, sig2v) == false);
+        // Wrong msg
+        REQUIRE(BasicSchemeMSL().Verify(pk1, msg2, sig1) == false);
+        REQUIRE(BasicSchemeMSL().Verify(pk1v, msg2, sig1v) == false);
+        // Wrong pk
+        REQUIRE(BasicSchemeMSL().Verify(pk2, msg1, sig1) == false);
+        REQUIRE(BasicSchemeMSL().Verify(pk2v, msg1, sig1v) == false);
+
+        G1Element aggsig = BasicSchemeMSL().Aggregate({sig1, sig2});
+        vector<uint8_t> aggsigv =
+            BasicSchemeMSL().Aggregate(vector<vector<uint8_t>>{sig1v, sig2v});
+        REQUIRE(BasicSchemeMSL().AggregateVerify({pk1, pk2}, msgs, aggsig));
+        REQUIRE(BasicSchemeMSL().AggregateVerify({pk1v, pk2v}, msgs, aggsigv));
+        REQUIRE(
+            BasicSchemeMSL().AggregateVerify({pk2, pk1}, msgs, aggsig) ==
+            false);
+
+        // Basic scheme requires distinct messages
+        G1Element sig2_same = BasicSchemeMSL().Sign(sk2, msg1);
+        REQUIRE(
+            BasicSchemeMSL().AggregateVerify(
+                {pk1, pk2},
+                vector<vector<uint8_t>>{msg1, msg1},
+                BasicSchemeMSL().Aggregate({sig1, sig2_same})) == false);
+        REQUIRE(BasicSchemeMSL().AggregateVerify(
+            vector<G2Element>{}, vector<vector<uint8_t>>{}, G1Element()));
+    }
+
+    SECTION("Aug Scheme")
+    {
+        vector<uint8_t> seed1(32, 0x04);
+        vector<uint8_t> seed2(32, 0x05);
+        vector<uint8_t> msg1 = {7, 8, 9};
+        vector<uint8_t> msg2 = {10, 11, 12};
+        vector<vector<uint8_t>> msgs = {msg1, msg1};
+
+        PrivateKey sk1 = AugSchemeMSL().KeyGen(seed1);
+        G2Element pk1 = AugSchemeMSL().SkToG2(sk1);
+        vector<uint8_t> pk1v = AugSchemeMSL().SkToPk(sk1);
+        G1Element sig1 = AugSchemeMSL().Sign(sk1, msg1);
+        vector<uint8_t> sig1v = AugSchemeMSL().Sign(sk1, msg1).Serialize();
+
+        REQUIRE(AugSchemeMSL().Verify(pk1, msg1, sig1));
+        REQUIRE(AugSchemeMSL().Verify(pk1v, msg1, sig1v));
+        REQUIRE(BasicSchemeMSL().Verify(pk1, msg1, sig1) == false);
+
+        PrivateKey sk2 = AugSchemeMSL().KeyGen(seed2);
+        G2Element pk2 = AugSchemeMSL().SkToG2(sk2);
+        vector<uint8_t> pk2v = AugSchemeMSL().SkToPk(sk2);
+        G1Element sig2 = AugSchemeMSL().Sign(sk2, msg1);
+        vector<uint8_t> sig2v = AugSchemeMSL().Sign(sk2, msg1).Serialize();
+
+        // Wrong G1Element
+        REQUIRE(AugSchemeMSL().Verify(pk1, msg1, sig2) == false);
+        REQUIRE(AugSchemeMSL().Verify(pk1v, msg1, sig2v) == false);
+        // Wrong msg
+        REQUIRE(AugSchemeMSL().Verify(pk1, msg2, sig1) == false);
+        REQUIRE(AugSchemeMSL().Verify(pk1v, msg2, sig1v) == false);
+        // Wrong pk
+        REQUIRE(AugSchemeMSL().Verify(pk2, msg1, sig1) == false);
+        REQUIRE(AugSchemeMSL().Verify(pk2v, msg1, sig1v) == false);
+
+        // Same message is fine under the augmented scheme
+        G1Element aggsig = AugSchemeMSL().Aggregate({sig1, sig2});
+        vector<uint8_t> aggsigv =
+            AugSchemeMSL().Aggregate(vector<vector<uint8_t>>{sig1v, sig2v});
+        REQUIRE(AugSchemeMSL().AggregateVerify({pk1, pk2}, msgs, aggsig));
+        REQUIRE(AugSchemeMSL().AggregateVerify({pk1v, pk2v}, msgs, aggsigv));
+
+        // Signing with a prepended key
+        G1Element sig3 = AugSchemeMSL().Sign(sk1, msg2, pk2);
+        REQUIRE(AugSchemeMSL().Verify(pk1, msg2, sig3) == false);
+        REQUIRE(CoreMSL(AugSchemeMSL::CIPHERSUITE_ID).Verify(pk1, [&]() {
+            vector<uint8_t> aug = pk2.Serialize();
+            aug.insert(aug.end(), msg2.begin(), msg2.end());
+            return aug;
+        }(), sig3));
+    }
+
+    SECTION("Pop Scheme")
+    {
+        vector<uint8_t> seed1(32, 0x06);
+        vector<uint8_t> seed2(32, 0x07);
+        vector<uint8_t> msg1 = {7, 8, 9};
+        vector<uint8_t> msg2 = {10, 11, 12};
+        vector<vector<uint8_t>> msgs = {msg1, msg2};
+
+        PrivateKey sk1 = PopSchemeMSL().KeyGen(seed1);
+        G2Element pk1 = PopSchemeMSL().SkToG2(sk1);
+        vector<uint8_t> pk1v = PopSchemeMSL().SkToPk(sk1);
+        G1Element sig1 = PopSchemeMSL().Sign(sk1, msg1);
+        vector<uint8_t> sig1v = PopSchemeMSL().Sign(sk1, msg1).Serialize();
+
+        REQUIRE(PopSchemeMSL().Verify(pk1, msg1, sig1));
+        REQUIRE(PopSchemeMSL().Verify(pk1v, msg1, sig1v));
+
+        PrivateKey sk2 = PopSchemeMSL().KeyGen(seed2);
+        G2Element pk2 = PopSchemeMSL().SkToG2(sk2);
+        vector<uint8_t> pk2v = PopSchemeMSL().SkToPk(sk2);
+        G1Element sig2 = PopSchemeMSL().Sign(sk2, msg2);
+        vector<uint8_t> sig2v = PopSchemeMSL().Sign(sk2, msg2).Serialize();
+
+        G1Element aggsig = PopSchemeMSL().Aggregate({sig1, sig2});
+        vector<uint8_t> aggsigv =
+            PopSchemeMSL().Aggregate(vector<vector<uint8_t>>{sig1v, sig2v});
+        REQUIRE(PopSchemeMSL().AggregateVerify({pk1, pk2}, msgs, aggsig));
+        REQUIRE(PopSchemeMSL().AggregateVerify({pk1v, pk2v}, msgs, aggsigv));
+
+        // PopVerify
+        G1Element proof1 = PopSchemeMSL().PopProve(sk1);
+        vector<uint8_t> proof1v = PopSchemeMSL().PopProve(sk1).Serialize();
+        REQUIRE(PopSchemeMSL().PopVerify(pk1, proof1));
+        REQUIRE(PopSchemeMSL().PopVerify(pk1v, proof1v));
+        REQUIRE(PopSchemeMSL().PopVerify(pk2, proof1) == false);
+        REQUIRE(PopSchemeMSL().Verify(pk1, pk1v, proof1) == false);
+
+        // FastAggregateVerify
+        // We want sk2 to sign the same message
+        G1Element sig2_same = PopSchemeMSL().Sign(sk2, msg1);
+        vector<uint8_t> sig2v_same = PopSchemeMSL().Sign(sk2, msg1).Serialize();
+        G1Element aggsig_same = PopSchemeMSL().Aggregate({sig1, sig2_same});
+        vector<uint8_t> aggsigv_same = PopSchemeMSL().Aggregate(
+            vector<vector<uint8_t>>{sig1v, sig2v_same});
+        REQUIRE(
+            PopSchemeMSL().FastAggregateVerify({pk1, pk2}, msg1, aggsig_same));
+        REQUIRE(PopSchemeMSL().FastAggregateVerify(
+            {pk1v, pk2v}, msg1, aggsigv_same));
+        REQUIRE(
+            PopSchemeMSL().FastAggregateVerify({pk1, pk2}, msg2, aggsig_same) ==
+            false);
+        REQUIRE(
+            PopSchemeMSL().FastAggregateVerify(
+                vector<G2Element>{}, msg1, aggsig_same) == false);
+    }
+
+    SECTION("Unhardened HD keys")
+    {
+        vector<uint8_t> seed(32, 0x08);
+        PrivateKey sk = AugSchemeMSL().KeyGen(seed);
+        PrivateKey child = AugSchemeMSL().DeriveChildSkUnhardened(sk, 42);
+        REQUIRE(
+            AugSchemeMSL().DeriveChildPkUnhardened(sk.GetG2Element(), 42) ==
+            child.GetG2Element());
+    }
+}
+
 TEST_CASE("CheckValid")
 {
     SECTION("Valid points should succeed")
@@ -1470,6 +3277,51 @@ TEST_CASE("Element operations")
         REQUIRE(sig1 == G2Element());
         REQUIRE(G2Element::Generator().IsValid());
     }
+    SECTION("Multi scalar multiplication")
+    {
+        auto g1 = G1Element::Generator();
+        auto g2 = G2Element::Generator();
+        auto pk =
+            PrivateKey::FromByteVector(getRandomSeed(), true).GetG1Element();
+        auto sig =
+            PrivateKey::FromByteVector(getRandomSeed(), true).GetG2Element();
+        // little endian 16 bit scalars 3 and 258
+        const uint8_t scalars[] = {3, 0, 2, 1};
+        REQUIRE(
+            G1Element::MultiScalarMul({g1, pk}, scalars, 16) ==
+            G1Element::MultiScalarMul({g1}, scalars, 16) +
+                G1Element::MultiScalarMul({pk}, scalars + 2, 16));
+        REQUIRE(G1Element::MultiScalarMul({g1}, scalars, 16) == g1 + g1 + g1);
+        REQUIRE(G2Element::MultiScalarMul({g2}, scalars, 16) == g2 + g2 + g2);
+        REQUIRE(
+            G2Element::MultiScalarMul({g2, sig}, scalars, 16) ==
+            G2Element::MultiScalarMul({g2}, scalars, 16) +
+                G2Element::MultiScalarMul({sig}, scalars + 2, 16));
+        REQUIRE(G1Element::MultiScalarMul({}, scalars, 16) == G1Element());
+        REQUIRE(G2Element::MultiScalarMul({}, scalars, 16) == G2Element());
+
+        // Infinity anywhere in the input must not change the sum, with
+        // scalar 5 for the infinity point
+        const G1Element inf1;
+        const G2Element inf2;
+        const G1Element g1Sum =
+            G1Element::MultiScalarMul({g1, pk}, scalars, 16);
+        const G2Element g2Sum =
+            G2Element::MultiScalarMul({g2, sig}, scalars, 16);
+        const uint8_t first[] = {5, 0, 3, 0, 2, 1};
+        const uint8_t middle[] = {3, 0, 5, 0, 2, 1};
+        const uint8_t last[] = {3, 0, 2, 1, 5, 0};
+        REQUIRE(G1Element::MultiScalarMul({inf1, g1, pk}, first, 16) == g1Sum);
+        REQUIRE(
+            G1Element::MultiScalarMul({g1, inf1, pk}, middle, 16) == g1Sum);
+        REQUIRE(G1Element::MultiScalarMul({g1, pk, inf1}, last, 16) == g1Sum);
+        REQUIRE(G2Element::MultiScalarMul({inf2, g2, sig}, first, 16) == g2Sum);
+        REQUIRE(
+            G2Element::MultiScalarMul({g2, inf2, sig}, middle, 16) == g2Sum);
+        REQUIRE(G2Element::MultiScalarMul({g2, sig, inf2}, last, 16) == g2Sum);
+        REQUIRE(G1Element::MultiScalarMul({inf1, inf1}, first, 16) == inf1);
+        REQUIRE(G2Element::MultiScalarMul({inf2, inf2}, first, 16) == inf2);
+    }
 }
 
 TEST_CASE("GTElement")
@@ -1526,10 +3378,101 @@ TEST_CASE("GTElement")
 
         REQUIRE(pair == agg_sig_pair);
     }
+
+    SECTION("GTElement arithmetic")
+    {
+        auto sk1 = PrivateKey::FromByteVector(getRandomSeed(), true);
+        auto sk2 = PrivateKey::FromByteVector(getRandomSeed(), true);
+        blst_scalar k1, k2, zero;
+        blst_scalar_from_bendian(&k1, sk1.Serialize().data());
+        blst_scalar_from_bendian(&k2, sk2.Serialize().data());
+        memset(&zero, 0x00, sizeof(blst_scalar));
+
+        auto base = G1Element::Generator().Pair(G2Element::Generator());
+        auto gt1 = sk1.GetG1Element().Pair(G2Element::Generator());
+        auto gt2 = sk2.GetG1Element().Pair(G2Element::Generator());
+
+        REQUIRE(GTElement::Unity().IsUnity());
+        REQUIRE(!base.IsUnity());
+        REQUIRE(base.Pow(k1) == gt1);
+        REQUIRE(base.Pow(k2) == gt2);
+        REQUIRE(base.Pow(zero).IsUnity());
+        REQUIRE(gt1.Pow(k2) == gt2.Pow(k1));
+
+        REQUIRE((gt1 * gt1.Inverse()).IsUnity());
+        REQUIRE((gt1 / gt2) * gt2 == gt1);
+
+        // Only elements of GT deserialize with checks
+        REQUIRE(GTElement::FromBytes(gt1.Serialize()) == gt1);
+        REQUIRE(GTElement::FromBytes(gt1.Pow(k2).Serialize()) == gt1.Pow(k2));
+        blst_p1_affine pk1Affine;
+        sk1.GetG1Element().ToAffine(&pk1Affine);
+        const vector<uint8_t> loop =
+            GTElement::FromAffine(pk1Affine).Serialize();
+        REQUIRE_THROWS_AS(GTElement::FromBytes(loop), std::invalid_argument);
+        REQUIRE_NOTHROW(GTElement::FromBytesUnchecked(loop));
+        REQUIRE(base.Inverse() == G1Element::Generator().Negate().Pair(
+                                      G2Element::Generator()));
+
+        auto acc = gt1;
+        acc *= gt2;
+        REQUIRE(acc == gt1 * gt2);
+        REQUIRE(GTElement::Product({gt1, gt2, base}) == gt1 * gt2 * base);
+        REQUIRE(GTElement::Product({}).IsUnity());
+
+        REQUIRE(
+            GTElement::MultiPow({gt1, gt2}, {k2, k1}) ==
+            gt1.Pow(k2) * gt2.Pow(k1));
+        REQUIRE(GTElement::MultiPow({base}, {k1}) == gt1);
+        REQUIRE(GTElement::MultiPow({}, {}).IsUnity());
+        REQUIRE_THROWS(GTElement::MultiPow({gt1, gt2}, {k1}));
+    }
+
+    SECTION("Multi-pairing")
+    {
+        const uint8_t* dst =
+            (const uint8_t*)BasicSchemeMPL::CIPHERSUITE_ID.c_str();
+        const int dst_len = BasicSchemeMPL::CIPHERSUITE_ID.length();
+        vector<G1Element> pks;
+        vector<G2Element> hashes;
+        vector<G2Element> sigs;
+        GTElement expected = GTElement::Unity();
+        for (uint8_t i = 0; i < 20; i++) {
+            auto sk = BasicSchemeMPL().KeyGen(getRandomSeed());
+            vector<uint8_t> msg = {i, 1, 2};
+            pks.push_back(sk.GetG1Element());
+            hashes.push_back(G2Element::FromMessage(msg, dst, dst_len));
+            sigs.push_back(BasicSchemeMPL().Sign(sk, msg));
+            expected *= pks.back().Pair(hashes.back());
+        }
+
+        REQUIRE(GTElement::MultiPair(pks, hashes) == expected);
+        REQUIRE(GTElement::MultiPair(pks, hashes, true) == expected);
+        REQUIRE(GTElement::MultiPair({}, {}).IsUnity());
+        REQUIRE(GTElement::MultiPair({G1Element()}, {hashes[0]}).IsUnity());
+        REQUIRE_THROWS(GTElement::MultiPair(pks, {}));
+
+        // e(pk, H(m)) * e(-g1, sig) == 1 for a valid signature
+        auto negGen = G1Element::Generator().Negate();
+        REQUIRE(GTElement::PairingProductIsOne(
+            {pks[0], negGen}, {hashes[0], sigs[0]}));
+        REQUIRE(!GTElement::PairingProductIsOne(
+            {pks[0], negGen}, {hashes[0], sigs[1]}));
+
+        vector<G1Element> g1s(pks);
+        vector<G2Element> g2s(hashes);
+        g1s.push_back(negGen);
+        g2s.push_back(BasicSchemeMPL().Aggregate(sigs));
+        REQUIRE(GTElement::PairingProductIsOne(g1s, g2s, true));
+        g2s.back() = BasicSchemeMPL().Aggregate(
+            vector<G2Element>(sigs.begin() + 1, sigs.end()));
+        REQUIRE(!GTElement::PairingProductIsOne(g1s, g2s, true));
+    }
 }
 
 int main(int argc, char* argv[])
 {
+    testBinary = argv[0];
     int result = Catch::Session().run(argc, argv);
     return result;
 }
@@ -0,0 +1,182 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#include <pthread.h>
+#define BLS_HAVE_FORK 1
+#endif
+
+namespace bls {
+
+// Set on pool workers so nested ParallelFor calls don't wait on themselves
+static thread_local bool fIsPoolWorker = false;
+
+ThreadPool::ThreadPool(size_t nThreads)
+{
+    workers.reserve(nThreads);
+    for (size_t i = 0; i < nThreads; i++) {
+        workers.emplace_back([this]() { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fStopping = true;
+    }
+    cv.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// The default pool is created on first use, and again in a forked child,
+// which inherits the pool but none of its workers
+static std::atomic<ThreadPool*> defaultPool{nullptr};
+static std::mutex defaultPoolMutex;
+
+static size_t DefaultPoolSize()
+{
+#ifdef __EMSCRIPTEN__
+    // No pthreads in the javascript build
+    return 0;
+#else
+    // The calling thread takes part in ParallelFor, so leave it a core
+    return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+#endif
+}
+
+// Joins the workers of the pool this process created at exit
+static struct DefaultPoolOwner {
+    ~DefaultPoolOwner() { delete defaultPool.exchange(nullptr); }
+} defaultPoolOwner;
+
+#if BLS_HAVE_FORK
+static void LockDefaultPool() { defaultPoolMutex.lock(); }
+
+static void UnlockDefaultPool() { defaultPoolMutex.unlock(); }
+
+static void ResetDefaultPoolInChild()
+{
+    // The workers didn't survive the fork and one of them may have held the
+    // pool's lock, so abandon the pool rather than touch or destroy it. The
+    // next Default() call starts a fresh one.
+    defaultPool.store(nullptr);
+    defaultPoolMutex.unlock();
+}
+#endif
+
+ThreadPool& ThreadPool::Default()
+{
+    ThreadPool* pool = defaultPool.load(std::memory_order_acquire);
+    if (pool != nullptr) {
+        return *pool;
+    }
+    std::lock_guard<std::mutex> lock(defaultPoolMutex);
+    pool = defaultPool.load(std::memory_order_relaxed);
+    if (pool == nullptr) {
+#if BLS_HAVE_FORK
+        static bool fAtFork = false;
+        if (!fAtFork) {
+            pthread_atfork(
+                LockDefaultPool, UnlockDefaultPool, ResetDefaultPoolInChild);
+            fAtFork = true;
+        }
+#endif
+        pool = new ThreadPool(DefaultPoolSize());
+        defaultPool.store(pool, std::memory_order_release);
+    }
+    return *pool;
+}
+
+size_t ThreadPool::NumChunks(size_t n) const
+{
+    if (fIsPoolWorker) {
+        return std::min<size_t>(n, 1);
+    }
+    return std::min(n, workers.size() + 1);
+}
+
+void ThreadPool::ParallelFor(
+    size_t n,
+    const std::function<void(size_t, size_t, size_t)>& fn)
+{
+    const size_t nChunks = NumChunks(n);
+    if (nChunks == 0) {
+        return;
+    }
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(nChunks - 1);
+    for (size_t chunk = 1; chunk < nChunks; chunk++) {
+        const size_t begin = n * chunk / nChunks;
+        const size_t end = n * (chunk + 1) / nChunks;
+        futures.emplace_back(
+            Submit([&fn, chunk, begin, end]() { fn(chunk, begin, end); }));
+    }
+
+    std::exception_ptr error;
+    try {
+        fn(0, 0, n / nChunks);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (std::future<void>& future : futures) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void ThreadPool::WorkerLoop()
+{
+    fIsPoolWorker = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [this]() { return fStopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+}  // end namespace bls
@@ -0,0 +1,89 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSTHREADPOOL_HPP_
+#define SRC_BLSTHREADPOOL_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bls {
+
+/*
+ * Fixed size pool of worker threads used by the parallel batch APIs.
+ * A pool without workers runs everything on the calling thread.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t nThreads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // Process wide pool sized to the hardware concurrency. A child forked
+    // from a process that used it gets a new pool on its first call, as the
+    // workers don't survive the fork. Pools made with the constructor have
+    // no such handling and must not be used across a fork.
+    static ThreadPool &Default();
+
+    size_t Size() const { return workers.size(); }
+
+    // Queues f on a worker, the future carries its result or exception
+    template <class F>
+    auto Submit(F &&f) -> std::future<decltype(f())>
+    {
+        using R = decltype(f());
+        auto task =
+            std::make_shared<std::packaged_task<R()>>(std::forward<F>(f));
+        std::future<R> ret = task->get_future();
+        if (workers.empty()) {
+            (*task)();
+        } else {
+            Enqueue([task]() { (*task)(); });
+        }
+        return ret;
+    }
+
+    // Number of chunks ParallelFor splits n items into
+    size_t NumChunks(size_t n) const;
+
+    // Splits [0, n) into NumChunks(n) contiguous ranges and runs
+    // fn(chunk, begin, end) for each of them, using the calling thread for
+    // one of the chunks. Blocks until all chunks are done and rethrows the
+    // first exception. Nested calls from a worker run inline.
+    void ParallelFor(
+        size_t n,
+        const std::function<void(size_t, size_t, size_t)> &fn);
+
+private:
+    void Enqueue(std::function<void()> task);
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool fStopping{false};
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSTHREADPOOL_HPP_
@@ -0,0 +1,518 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "verifyd.hpp"
+
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+#include "threadpool.hpp"
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define BLS_HAVE_UNIX_SOCKETS 1
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace bls {
+
+// scheme, pubkey and signature precede the message
+static const size_t REQUEST_HEADER_SIZE =
+    1 + G1Element::SIZE + G2Element::SIZE;
+
+const size_t VerifyServer::MAX_MESSAGE_SIZE;
+const size_t VerifyServer::MAX_PENDING;
+
+struct VerifyServer::Request {
+    VerifyScheme scheme;
+    std::vector<uint8_t> pubkey;
+    std::vector<uint8_t> signature;
+    std::vector<uint8_t> message;
+    std::chrono::steady_clock::time_point arrival;
+    std::promise<bool> result;
+};
+
+// Requests of a connection wait in pending until answered, in order. cv
+// wakes the writer for new requests and the reader when one is answered.
+struct VerifyServer::Connection {
+    int fd;
+    std::thread thread;
+    std::atomic<bool> fDone{false};
+
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::future<bool>> pending;
+    bool fClosed = false;
+};
+
+#if BLS_HAVE_UNIX_SOCKETS
+
+#ifdef MSG_NOSIGNAL
+static const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+static const int SEND_FLAGS = 0;
+#endif
+
+static bool ReadFull(int fd, uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = read(fd, buf, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool WriteFull(int fd, const uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        const ssize_t n = send(fd, buf, len, SEND_FLAGS);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+static void NoSigPipe(int fd)
+{
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+static sockaddr_un SocketAddress(const std::string &path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        throw std::invalid_argument("Invalid socket path " + path);
+    }
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    return addr;
+}
+
+#endif
+
+VerifyServer::VerifyServer(
+    const std::string &socketPath,
+    std::chrono::microseconds window,
+    size_t nMaxBatch)
+    : socketPath(socketPath),
+      window(window),
+      nMaxBatch(nMaxBatch > 0 ? nMaxBatch : 1),
+      listenFd(-1)
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    const sockaddr_un addr = SocketAddress(socketPath);
+    listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error("Can't create socket");
+    }
+    // Only replace a socket, never a file that happens to be at the path
+    struct stat st;
+    if (lstat(socketPath.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            close(listenFd);
+            throw std::runtime_error(
+                "Can't listen on " + socketPath + ": not a socket");
+        }
+        unlink(socketPath.c_str());
+    }
+    if (bind(listenFd, (const sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listenFd, SOMAXCONN) != 0) {
+        const int err = errno;
+        close(listenFd);
+        throw std::runtime_error(
+            "Can't listen on " + socketPath + ": " + strerror(err));
+    }
+#else
+    throw std::runtime_error(
+        "Unix domain sockets are not supported on this platform");
+#endif
+}
+
+VerifyServer::~VerifyServer()
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+#endif
+}
+
+CoreMPL &VerifyServer::Scheme(VerifyScheme scheme)
+{
+    if (scheme == VERIFY_BASIC) {
+        return basic;
+    } else if (scheme == VERIFY_POP) {
+        return pop;
+    }
+    return aug;
+}
+
+void VerifyServer::Stop()
+{
+    fStopping = true;
+}
+
+void VerifyServer::Run()
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    std::thread batcher([this] { BatchLoop(); });
+
+    while (!fStopping) {
+        pollfd pfd = {listenFd, POLLIN, 0};
+        if (poll(&pfd, 1, 100) <= 0) {
+            continue;
+        }
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        NoSigPipe(fd);
+
+        auto connection = std::make_shared<Connection>();
+        connection->fd = fd;
+        connection->thread = std::thread([this, connection] {
+            Serve(connection);
+            connection->fDone = true;
+        });
+
+        // Forget connections that have closed
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto it = connections.begin(); it != connections.end();) {
+            if ((*it)->fDone) {
+                (*it)->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        connections.push_back(connection);
+    }
+
+    // Readers stop at once; their pending requests are still answered
+    std::vector<std::shared_ptr<Connection>> open;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        open.swap(connections);
+    }
+    for (auto &connection : open) {
+        shutdown(connection->fd, SHUT_RD);
+    }
+    for (auto &connection : open) {
+        connection->thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        queue.push_back(nullptr);  // tells BatchLoop to finish
+    }
+    cv.notify_all();
+    batcher.join();
+#endif
+}
+
+void VerifyServer::Serve(std::shared_ptr<Connection> connection)
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    const int fd = connection->fd;
+    std::thread writer([connection] {
+        while (true) {
+            std::future<bool> result;
+            {
+                std::unique_lock<std::mutex> lock(connection->mtx);
+                connection->cv.wait(lock, [&] {
+                    return connection->fClosed || !connection->pending.empty();
+                });
+                if (connection->pending.empty()) {
+                    return;
+                }
+                result = std::move(connection->pending.front());
+                connection->pending.pop_front();
+            }
+            connection->cv.notify_all();
+            const uint8_t answer = result.get() ? 1 : 0;
+            WriteFull(connection->fd, &answer, 1);
+        }
+    });
+
+    uint8_t prefix[4];
+    while (true) {
+        {
+            // Stop reading at MAX_PENDING unanswered requests, so that a
+            // client which pipelines can't queue unbounded work
+            std::unique_lock<std::mutex> lock(connection->mtx);
+            connection->cv.wait(lock, [&] {
+                return connection->pending.size() < MAX_PENDING;
+            });
+        }
+        if (!ReadFull(fd, prefix, sizeof(prefix))) {
+            break;
+        }
+        const size_t len = (size_t)prefix[0] | (size_t)prefix[1] << 8 |
+                           (size_t)prefix[2] << 16 | (size_t)prefix[3] << 24;
+        if (len < REQUEST_HEADER_SIZE ||
+            len > REQUEST_HEADER_SIZE + MAX_MESSAGE_SIZE) {
+            break;
+        }
+        std::vector<uint8_t> body(len);
+        if (!ReadFull(fd, body.data(), len) || body[0] > VERIFY_POP) {
+            break;
+        }
+
+        auto request = std::make_shared<Request>();
+        request->scheme = (VerifyScheme)body[0];
+        const uint8_t *p = body.data() + 1;
+        request->pubkey.assign(p, p + G1Element::SIZE);
+        p += G1Element::SIZE;
+        request->signature.assign(p, p + G2Element::SIZE);
+        p += G2Element::SIZE;
+        request->message.assign(p, (const uint8_t *)body.data() + len);
+        request->arrival = std::chrono::steady_clock::now();
+        nRequests++;
+        {
+            std::lock_guard<std::mutex> lock(connection->mtx);
+            connection->pending.push_back(request->result.get_future());
+        }
+        connection->cv.notify_all();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            queue.push_back(std::move(request));
+        }
+        cv.notify_all();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(connection->mtx);
+        connection->fClosed = true;
+    }
+    connection->cv.notify_all();
+    writer.join();
+    close(fd);
+#else
+    (void)connection;
+#endif
+}
+
+void VerifyServer::BatchLoop()
+{
+    while (true) {
+        std::vector<std::shared_ptr<Request>> batch;
+        bool fFinish = false;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&] { return !queue.empty(); });
+            if (queue.front()) {
+                // Wait for the batch to fill, at most the window
+                const auto deadline = queue.front()->arrival + window;
+                cv.wait_until(lock, deadline, [&] {
+                    return queue.size() >= nMaxBatch || !queue.back();
+                });
+            }
+            // Run queues the null marker after its last request
+            while (!queue.empty() && batch.size() < nMaxBatch) {
+                if (!queue.front()) {
+                    fFinish = true;
+                    break;
+                }
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        if (!batch.empty()) {
+            VerifyBatch(batch);
+        }
+        if (fFinish) {
+            return;
+        }
+    }
+}
+
+void VerifyServer::VerifyBatch(std::vector<std::shared_ptr<Request>> &batch)
+{
+    nBatches++;
+    for (uint8_t s = VERIFY_BASIC; s <= VERIFY_POP; s++) {
+        CoreMPL &scheme = Scheme((VerifyScheme)s);
+        std::vector<Request *> items;
+        std::vector<std::vector<G1Element>> pubkeys;
+        std::vector<std::vector<Bytes>> messages;
+        std::vector<G2Element> signatures;
+        for (auto &request : batch) {
+            if (request->scheme != s) {
+                continue;
+            }
+            try {
+                G1Element pubkey = G1Element::FromBytes(request->pubkey);
+                G2Element signature = G2Element::FromBytes(request->signature);
+                pubkeys.push_back({pubkey});
+                messages.push_back({Bytes(request->message)});
+                signatures.push_back(signature);
+                items.push_back(request.get());
+            } catch (const std::exception &) {
+                request->result.set_value(false);
+            }
+        }
+        if (items.empty()) {
+            continue;
+        }
+
+        // The bad requests of a failed batch are found by bisecting it
+        const std::vector<bool> ok =
+            scheme.AggregateVerifyBatchEach(pubkeys, messages, signatures);
+        bool fFailed = false;
+        for (size_t i = 0; i < items.size(); i++) {
+            items[i]->result.set_value(ok[i]);
+            fFailed |= !ok[i];
+        }
+        if (fFailed && items.size() > 1) {
+            nFailedBatches++;
+        }
+    }
+}
+
+VerifyClient::VerifyClient(const std::string &socketPath) : fd(-1)
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    const sockaddr_un addr = SocketAddress(socketPath);
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Can't create socket");
+    }
+    if (connect(fd, (const sockaddr *)&addr, sizeof(addr)) != 0) {
+        const int err = errno;
+        close(fd);
+        throw std::runtime_error(
+            "Can't connect to " + socketPath + ": " + strerror(err));
+    }
+    NoSigPipe(fd);
+#else
+    (void)socketPath;
+    throw std::runtime_error(
+        "Unix domain sockets are not supported on this platform");
+#endif
+}
+
+VerifyClient::~VerifyClient()
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    close(fd);
+#endif
+}
+
+void VerifyClient::Send(
+    VerifyScheme scheme,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    if (pubkey.size() != G1Element::SIZE ||
+        signature.size() != G2Element::SIZE) {
+        throw std::invalid_argument("VerifyClient: Invalid size");
+    }
+    if (message.size() > VerifyServer::MAX_MESSAGE_SIZE) {
+        throw std::invalid_argument("VerifyClient: Message too large");
+    }
+    const size_t len = REQUEST_HEADER_SIZE + message.size();
+    std::vector<uint8_t> frame(4 + len);
+    for (size_t i = 0; i < 4; i++) {
+        frame[i] = (uint8_t)(len >> (8 * i));
+    }
+    frame[4] = scheme;
+    uint8_t *p = frame.data() + 5;
+    memcpy(p, pubkey.begin(), G1Element::SIZE);
+    p += G1Element::SIZE;
+    memcpy(p, signature.begin(), G2Element::SIZE);
+    p += G2Element::SIZE;
+    memcpy(p, message.begin(), message.size());
+    if (!WriteFull(fd, frame.data(), frame.size())) {
+        throw std::runtime_error("VerifyClient: Connection lost");
+    }
+#else
+    (void)scheme;
+    (void)pubkey;
+    (void)message;
+    (void)signature;
+#endif
+}
+
+bool VerifyClient::Receive()
+{
+#if BLS_HAVE_UNIX_SOCKETS
+    uint8_t answer;
+    if (!ReadFull(fd, &answer, 1)) {
+        throw std::runtime_error("VerifyClient: Connection lost");
+    }
+    return answer == 1;
+#else
+    return false;
+#endif
+}
+
+bool VerifyClient::Verify(
+    VerifyScheme scheme,
+    const Bytes &pubkey,
+    const Bytes &message,
+    const Bytes &signature)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    Send(scheme, pubkey, message, signature);
+    return Receive();
+}
+
+std::vector<bool> VerifyClient::VerifyMany(
+    VerifyScheme scheme,
+    const std::vector<Bytes> &pubkeys,
+    const std::vector<Bytes> &messages,
+    const std::vector<Bytes> &signatures)
+{
+    const size_t n = pubkeys.size();
+    if (messages.size() != n || signatures.size() != n) {
+        throw std::length_error("VerifyMany: sizes differ");
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    for (size_t i = 0; i < n; i++) {
+        Send(scheme, pubkeys[i], messages[i], signatures[i]);
+    }
+    std::vector<bool> results(n);
+    for (size_t i = 0; i < n; i++) {
+        results[i] = Receive();
+    }
+    return results;
+}
+
+}  // end namespace bls
@@ -0,0 +1,150 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SRC_BLSVERIFYD_HPP_
+#define SRC_BLSVERIFYD_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "schemes.hpp"
+
+namespace bls {
+
+// Scheme of a request to a VerifyServer
+enum VerifyScheme : uint8_t {
+    VERIFY_BASIC = 0,
+    VERIFY_AUG = 1,
+    VERIFY_POP = 2,
+};
+
+/*
+ * Verifies requests from local processes over a Unix domain socket. The
+ * requests of all connections are collected for up to a latency window,
+ * or until a batch is full, and each batch is checked with a single
+ * randomized batch verification per scheme. If a batch fails, the bad
+ * requests are found by bisecting it (see AggregateVerifyBatchEach).
+ *
+ * Each request is a 4 byte little endian length followed by the scheme,
+ * the pubkey, the signature and the message; the answer is one byte, 1 if
+ * it verified. Answers come back in request order, so clients may
+ * pipeline; a connection with MAX_PENDING unanswered requests isn't read
+ * until some are answered. Not available on Windows or Emscripten, where
+ * the constructor throws.
+ */
+class VerifyServer {
+public:
+    static const size_t MAX_MESSAGE_SIZE = 1 << 20;
+    static const size_t MAX_PENDING = 256;
+
+    // Listens on socketPath, replacing any socket left there. Throws
+    // std::runtime_error if something other than a socket is there.
+    VerifyServer(
+        const std::string &socketPath,
+        std::chrono::microseconds window = std::chrono::microseconds(2000),
+        size_t nMaxBatch = 1024);
+    ~VerifyServer();
+
+    VerifyServer(const VerifyServer &) = delete;
+    VerifyServer &operator=(const VerifyServer &) = delete;
+
+    // Serves connections until Stop is called
+    void Run();
+    // Thread safe; pending requests are still answered
+    void Stop();
+
+    uint64_t Requests() const { return nRequests; }
+    uint64_t Batches() const { return nBatches; }
+    uint64_t FailedBatches() const { return nFailedBatches; }
+
+private:
+    struct Request;
+    struct Connection;
+
+    void Serve(std::shared_ptr<Connection> connection);
+    void BatchLoop();
+    void VerifyBatch(std::vector<std::shared_ptr<Request>> &batch);
+    CoreMPL &Scheme(VerifyScheme scheme);
+
+    const std::string socketPath;
+    const std::chrono::microseconds window;
+    const size_t nMaxBatch;
+    int listenFd;
+
+    std::atomic<bool> fStopping{false};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<Request>> queue;
+    std::vector<std::shared_ptr<Connection>> connections;
+    std::vector<std::thread> threads;
+
+    BasicSchemeMPL basic;
+    AugSchemeMPL aug;
+    PopSchemeMPL pop;
+
+    std::atomic<uint64_t> nRequests{0};
+    std::atomic<uint64_t> nBatches{0};
+    std::atomic<uint64_t> nFailedBatches{0};
+};
+
+/*
+ * Connection to a VerifyServer. Calls are serialized, so share one client
+ * per thread or pipeline with VerifyMany. Throws std::runtime_error if the
+ * connection fails and std::invalid_argument for wrongly sized keys or
+ * signatures.
+ */
+class VerifyClient {
+public:
+    explicit VerifyClient(const std::string &socketPath);
+    ~VerifyClient();
+
+    VerifyClient(const VerifyClient &) = delete;
+    VerifyClient &operator=(const VerifyClient &) = delete;
+
+    bool Verify(
+        VerifyScheme scheme,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature);
+
+    // Sends every request before reading the answers
+    std::vector<bool> VerifyMany(
+        VerifyScheme scheme,
+        const std::vector<Bytes> &pubkeys,
+        const std::vector<Bytes> &messages,
+        const std::vector<Bytes> &signatures);
+
+private:
+    void Send(
+        VerifyScheme scheme,
+        const Bytes &pubkey,
+        const Bytes &message,
+        const Bytes &signature);
+    bool Receive();
+
+    int fd;
+    std::mutex mtx;
+};
+
+}  // end namespace bls
+
+#endif  // SRC_BLSVERIFYD_HPP_
@@ -0,0 +1,109 @@
+// Copyright 2020 Chia Network Inc
+
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+
+//    http://www.apache.org/licenses/LICENSE-2.0
+
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SRC_BLSVIEWS_HPP_
+#define SRC_BLSVIEWS_HPP_
+
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "elements.hpp"
+
+namespace bls {
+
+/*
+ * Random access view of a sequence owned by the caller: a vector, an
+ * array, a std::span, an IteratorRange, or anything else with std::size
+ * and random access std::begin. Element i is converted to T when read,
+ * through a function pointer, so out of line code reads the caller's
+ * containers without copying them into vectors.
+ *
+ * The view points to the sequence, which must outlive it. Elements are
+ * read in place, so the sequence must hold them rather than compute them,
+ * unless it yields T by value.
+ */
+template <class T>
+class IndexedView {
+public:
+    // Only sequences whose elements convert to T, so that a view of the
+    // wrong elements never compiles
+    template <
+        class Range,
+        typename = std::enable_if_t<
+            !std::is_same<std::decay_t<Range>, IndexedView>::value &&
+            std::is_convertible<
+                decltype(*std::begin(std::declval<const Range &>())),
+                T>::value>>
+    IndexedView(const Range &range)
+        : range(&range), n(std::size(range)), at(&At<Range>)
+    {
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    T operator[](size_t i) const { return at(range, i); }
+
+private:
+    template <class Range>
+    static T At(const void *range, size_t i)
+    {
+        const Range &r = *static_cast<const Range *>(range);
+        static_assert(
+            std::is_base_of<
+                std::random_access_iterator_tag,
+                typename std::iterator_traits<decltype(
+                    std::begin(r))>::iterator_category>::value,
+            "IndexedView needs random access");
+        using Element = decltype(std::begin(r)[i]);
+        static_assert(
+            std::is_lvalue_reference<Element>::value ||
+                (!std::is_reference<T>::value &&
+                 std::is_same<std::decay_t<Element>, T>::value),
+            "IndexedView can't refer into computed elements");
+        static_assert(
+            std::is_convertible<Element, T>::value,
+            "IndexedView elements must convert to its element type");
+        return static_cast<T>(std::begin(r)[i]);
+    }
+
+    const void *range;
+    size_t n;
+    T (*at)(const void *, size_t);
+};
+
+// A pair of random access iterators as a sequence, for IndexedView
+template <class It>
+class IteratorRange {
+public:
+    IteratorRange(It first, It last) : first(first), last(last) {}
+
+    It begin() const { return first; }
+    It end() const { return last; }
+    size_t size() const { return std::distance(first, last); }
+
+private:
+    It first, last;
+};
+
+using PubKeysView = IndexedView<const G1Element &>;
+using SignaturesView = IndexedView<const G2Element &>;
+using MessagesView = IndexedView<Bytes>;
+// Batches: one sequence of pubkeys or messages per aggregate
+using PubKeySetsView = IndexedView<PubKeysView>;
+using MessageSetsView = IndexedView<MessagesView>;
+
+}  // end namespace bls
+
+#endif  // SRC_BLSVIEWS_HPP_